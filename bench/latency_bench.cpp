@@ -0,0 +1,130 @@
+// Per step latency of fmi2DoStep + fmi2GetReal over all outputs, worst case and tail percentiles.
+// Every 100th step jumps far ahead, as after a long communication step.
+//
+// Usage: latency_bench [series] [points per series] [steps]
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Boolean options of scenario_state.hpp
+    constexpr fmi2ValueReference vrCompressSeries = 0x40000000;
+    constexpr fmi2ValueReference vrLazyParse = 0x40000003;
+    constexpr fmi2ValueReference vrRealtime = 0x4000000E;
+
+    struct Config
+    {
+        const char *name;
+        bool compress;
+        bool lazy;
+        bool realtime;
+    };
+
+    // Points with jittered spacing around 10 ms
+    std::string make_scenario(size_t series, size_t points)
+    {
+        uint64_t state = 12345;
+        std::string scenario;
+        for (size_t s = 0; s < series; ++s)
+        {
+            scenario += (s ? "\nvar" : "var") + std::to_string(s) + "; L";
+            double t = 0.0;
+            for (size_t i = 0; i < points; ++i)
+            {
+                state = state * 6364136223846793005ull + 1442695040888963407ull;
+                t += 0.005 + 0.01 * static_cast<double>(state >> 11) / 9007199254740992.0;
+                scenario += "; " + std::to_string(t) + "," + std::to_string(static_cast<double>(i % 100));
+            }
+        }
+        return scenario;
+    }
+
+    double percentile(const std::vector<double> &sorted, double p)
+    {
+        const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    // Nanoseconds of every step
+    std::vector<double> run(const Config &config, const std::string &scenario, size_t series, size_t steps, double &checksum)
+    {
+        fmi2CallbackFunctions cbs{};
+        auto comp = fmi2Instantiate("bench", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+        const fmi2ValueReference vr_in[1] = {0};
+        const fmi2String values[1] = {scenario.c_str()};
+        fmi2SetString(comp, vr_in, 1, values);
+        const fmi2ValueReference vr_options[3] = {vrCompressSeries, vrLazyParse, vrRealtime};
+        const fmi2Boolean options[3] = {config.compress, config.lazy, config.realtime};
+        fmi2SetBoolean(comp, vr_options, 3, options);
+        fmi2SetupExperiment(comp, fmiFalse, 0.0, 0.0, fmiFalse, 0.0);
+        fmi2EnterInitializationMode(comp);
+        fmi2ExitInitializationMode(comp);
+
+        std::vector<fmi2ValueReference> vr_out(series);
+        for (size_t s = 0; s < series; ++s)
+        {
+            vr_out[s] = static_cast<fmi2ValueReference>(s + 1);
+        }
+        std::vector<fmi2Real> out(series);
+        std::vector<double> durations;
+        durations.reserve(steps);
+
+        double time = 0.0;
+        for (size_t step = 0; step < steps; ++step)
+        {
+            const double h = step % 100 == 99 ? 10.0 : 0.001;
+            const auto begin = std::chrono::steady_clock::now();
+            fmi2DoStep(comp, time, h, fmiTrue);
+            fmi2GetReal(comp, vr_out.data(), series, out.data());
+            durations.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count());
+            time += h;
+            checksum += out[0];
+        }
+        fmi2FreeInstance(comp);
+        return durations;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const size_t series = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16;
+    const size_t points = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+    const size_t steps = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 100000;
+
+    const std::string scenario = make_scenario(series, points);
+    const Config configs[] = {
+        {"default", false, false, false},
+        {"lazy + compressed", true, true, false},
+        {"realtime", true, true, true}, // overrides lazy_parse and compress_series
+    };
+
+    std::printf("series: %zu, points: %zu, steps: %zu\n", series, points, steps);
+    std::printf("%-20s %10s %10s %10s %10s %10s\n", "ns per step", "mean", "p50", "p99", "p99.99", "worst");
+    double checksum = 0.0;
+    for (const auto &config : configs)
+    {
+        auto durations = run(config, scenario, series, steps, checksum);
+        double total = 0.0;
+        for (const double d : durations)
+        {
+            total += d;
+        }
+        std::sort(durations.begin(), durations.end());
+        std::printf("%-20s %10.0f %10.0f %10.0f %10.0f %10.0f\n", config.name, total / static_cast<double>(durations.size()),
+                    percentile(durations, 0.5), percentile(durations, 0.99), percentile(durations, 0.9999), durations.back());
+    }
+    std::printf("(checksum %g)\n", checksum);
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Scenario parsing time for an increasing number of threads
+//
+// Usage: parse_bench [series] [points per series]
+
+#include "parser.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+int main(int argc, char **argv)
+{
+    const size_t series = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    const size_t points = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+
+    std::string input;
+    for (size_t s = 0; s < series; ++s)
+    {
+        input += "var" + std::to_string(s) + "; L";
+        for (size_t i = 0; i < points; ++i)
+        {
+            input += "; " + std::to_string(0.01 * static_cast<double>(i)) + "," + std::to_string(static_cast<double>(s + i) * 0.5);
+        }
+        input += "\n";
+    }
+
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("series: %zu, points: %zu, input: %.1f MB, hardware threads: %u\n",
+                series, points, static_cast<double>(input.size()) / 1e6, hardware);
+    std::printf("%-8s %12s %10s\n", "threads", "ms", "speedup");
+
+    double single = 0.0;
+    for (unsigned threads = 1; threads <= 2 * hardware; threads *= 2)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+        const auto parsed = parse_scenario(input, threads);
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        if (threads == 1)
+        {
+            single = elapsed;
+        }
+        std::printf("%-8u %12.1f %9.2fx%s\n", threads, elapsed, single / elapsed, parsed.size() == series ? "" : " (mismatch)");
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Cost of a new run: full instantiate/parse cycle versus fmi2Reset with an unchanged scenario
+//
+// Usage: reset_bench [series] [points per series] [runs]
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+    void initialize(fmi2Component comp, const std::string &scenario)
+    {
+        const fmi2ValueReference vr_in[1] = {0};
+        const fmi2String values[1] = {scenario.c_str()};
+        fmi2SetString(comp, vr_in, 1, values);
+        fmi2SetupExperiment(comp, fmiFalse, 0.0, 0.0, fmiFalse, 0.0);
+        fmi2EnterInitializationMode(comp);
+        fmi2ExitInitializationMode(comp);
+    }
+
+    fmi2Real run(fmi2Component comp, size_t series)
+    {
+        const fmi2ValueReference vr_out[1] = {static_cast<fmi2ValueReference>(series)};
+        fmi2Real value[1] = {0.0};
+        for (int step = 0; step < 100; ++step)
+        {
+            fmi2DoStep(comp, 0.01 * step, 0.01, fmiTrue);
+            fmi2GetReal(comp, vr_out, 1, value);
+        }
+        return value[0];
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const size_t series = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 32;
+    const size_t points = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000;
+    const size_t runs = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 20;
+
+    std::string scenario;
+    for (size_t s = 0; s < series; ++s)
+    {
+        scenario += (s ? "\nvar" : "var") + std::to_string(s) + "; L";
+        for (size_t i = 0; i < points; ++i)
+        {
+            scenario += "; " + std::to_string(0.01 * static_cast<double>(i)) + "," + std::to_string(static_cast<double>(i % 100));
+        }
+    }
+
+    fmi2CallbackFunctions cbs{};
+    double checksum = 0.0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < runs; ++r)
+    {
+        auto comp = fmi2Instantiate("bench", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+        initialize(comp, scenario);
+        checksum += run(comp, series);
+        fmi2FreeInstance(comp);
+    }
+    const double instantiate_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / runs;
+
+    auto comp = fmi2Instantiate("bench", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+    initialize(comp, scenario);
+    checksum += run(comp, series);
+    begin = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < runs; ++r)
+    {
+        fmi2Reset(comp);
+        initialize(comp, scenario);
+        checksum += run(comp, series);
+    }
+    const double reset_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / runs;
+    fmi2FreeInstance(comp);
+
+    std::printf("series: %zu, points: %zu, input: %.1f MB, runs: %zu\n", series, points, static_cast<double>(scenario.size()) / 1e6, runs);
+    std::printf("%-24s %12s\n", "per run", "ms");
+    std::printf("%-24s %12.3f\n", "instantiate + parse", instantiate_ms);
+    std::printf("%-24s %12.3f\n", "reset, unchanged input", reset_ms);
+    std::printf("(checksum %g)\n", checksum);
+    return 0;
+}
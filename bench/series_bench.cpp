@@ -0,0 +1,100 @@
+// Memory and per step cost of the series storage variants
+//
+// Usage: series_bench [points] [steps]
+
+#include "series.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    // Slowly varying sensor like signal on a regular grid
+    SeriesData make_series(size_t points)
+    {
+        SeriesData sd;
+        sd.name = "bench";
+        sd.interpolation = Interpolation::Linear;
+        sd.times.reserve(points);
+        sd.values.reserve(points);
+        for (size_t i = 0; i < points; ++i)
+        {
+            const double t = 0.01 * static_cast<double>(i);
+            sd.times.push_back(t);
+            sd.values.push_back(std::round((20.0 + 5.0 * std::sin(0.001 * t)) * 100.0) / 100.0);
+        }
+        sd.size = points;
+        return sd;
+    }
+
+    // Average nanoseconds per evaluation when stepping through the whole series
+    double time_steps(SeriesData &sd, size_t steps, double &checksum)
+    {
+        const double end = sd.times.empty() ? 0.01 * static_cast<double>(sd.size) : sd.times.back();
+        const double dt = end / static_cast<double>(steps);
+        sd.access_index = 0;
+
+        const auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < steps; ++i)
+        {
+            checksum += eval_value_at(sd, dt * static_cast<double>(i));
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - begin;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(steps);
+    }
+
+    // Average nanoseconds per point when evaluating the same steps in one eval_batch call
+    double time_batch(SeriesData &sd, size_t steps, double &checksum)
+    {
+        const double end = sd.times.empty() ? 0.01 * static_cast<double>(sd.size) : sd.times.back();
+        const double dt = end / static_cast<double>(steps);
+        std::vector<double> times(steps);
+        std::vector<double> out(steps);
+        for (size_t i = 0; i < steps; ++i)
+        {
+            times[i] = dt * static_cast<double>(i);
+        }
+        sd.access_index = 0;
+
+        const auto begin = std::chrono::steady_clock::now();
+        eval_batch(sd, times.data(), steps, out.data());
+        const auto elapsed = std::chrono::steady_clock::now() - begin;
+        for (const double v : out)
+        {
+            checksum += v;
+        }
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(steps);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const size_t points = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const size_t steps = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+
+    double checksum = 0.0;
+
+    auto plain = make_series(points);
+    const size_t plain_bytes = plain.footprint();
+    const double plain_ns = time_steps(plain, steps, checksum);
+    const double plain_batch_ns = time_batch(plain, steps, checksum);
+
+    auto compressed = make_series(points);
+    compress_series(compressed);
+    const size_t compressed_bytes = compressed.footprint();
+    const double compressed_ns = time_steps(compressed, steps, checksum);
+    const double compressed_batch_ns = time_batch(compressed, steps, checksum);
+
+    std::printf("points: %zu, steps: %zu\n", points, steps);
+    std::printf("%-12s %14s %12s %12s\n", "storage", "bytes", "ns/step", "ns/batched");
+    std::printf("%-12s %14zu %12.2f %12.2f\n", "plain", plain_bytes, plain_ns, plain_batch_ns);
+    std::printf("%-12s %14zu %12.2f %12.2f\n", "compressed", compressed_bytes, compressed_ns, compressed_batch_ns);
+    std::printf("memory reduction: %.2fx, step cost: %.2fx\n",
+                static_cast<double>(plain_bytes) / static_cast<double>(compressed_bytes),
+                compressed_ns / plain_ns);
+    std::printf("(checksum %g)\n", checksum);
+    return 0;
+}
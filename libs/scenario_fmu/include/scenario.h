@@ -0,0 +1,24 @@
+
+#pragma once
+
+#include "fmi2.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /* Scenario specific API, exported next to the FMI functions */
+
+    /* Evaluate the output `vr` at the `n` times in `times`, writing the values to `out`.
+       Integer and Boolean outputs are written as reals. Ascending times are evaluated in a single
+       pass over the points of the series, unsorted times are supported but slower.
+       Call after fmi2ExitInitializationMode, the instance time is not changed. */
+    fmi2Status scenario_eval_batch(fmi2Component comp,
+                                   fmi2ValueReference vr,
+                                   const fmi2Real times[], size_t n,
+                                   fmi2Real out[]);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,329 @@
+#pragma once
+
+#include "series.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Binary form of a parsed scenario. All offsets are relative to the start of the buffer and
+    // every array is 8 byte aligned, so the buffer can be used from any address.
+    //
+    // Header
+    // SeriesRecord[series_count]
+    // names, point arrays
+    inline constexpr char binary_magic[8] = {'S', 'C', 'E', 'N', 'A', 'R', 'I', 'O'};
+    inline constexpr uint32_t binary_version = 7;
+
+    struct BinaryHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t series_count;
+        uint64_t total_size;
+    };
+
+    struct SeriesRecord
+    {
+        uint64_t name_offset;
+        uint64_t times_offset;
+        uint64_t values_offset; // doubles for Real, int32 for Integer, bit packed uint64 for Boolean
+        uint64_t size;
+        uint64_t shapes_offset; // SegmentShape[shape_count]
+        uint64_t shape_count;
+        uint32_t name_length;
+        uint8_t interpolation;
+        uint8_t type;
+        uint8_t extrapolation;
+        uint8_t flags;
+        double window; // length of the Window modifier, 0 for none
+        double noise_sigma;
+        double noise_step;
+        uint64_t noise_seed;
+        uint64_t input_offset; // name of the Input modifier
+        uint64_t input_length; // 0 for series indexed by time
+        uint64_t input2_offset; // second input of the Map modifier
+        uint64_t input2_length; // 0 for series that are not maps
+        uint64_t map_offset;    // doubles of the first axis, the second axis, then the rows of the map
+        uint64_t map_x_size;
+        uint64_t map_y_size;
+    };
+
+    // SeriesRecord::flags
+    inline constexpr uint8_t series_flag_integral = 1;
+    inline constexpr uint8_t series_flag_band_noise = 2;
+
+    static size_t align8(size_t n)
+    {
+        return (n + 7) & ~size_t(7);
+    }
+
+    static size_t values_bytes(ValueType type, size_t size)
+    {
+        switch (type)
+        {
+        case ValueType::Integer:
+            return size * sizeof(int32_t);
+        case ValueType::Boolean:
+            return ((size + 63) / 64) * sizeof(uint64_t);
+        case ValueType::Real:
+        default:
+            return size * sizeof(double);
+        }
+    }
+
+    // Serialize parsed series, lazily indexed series must be loaded and none may be compressed.
+    // float32 values are stored widened to double.
+    static std::vector<char> serialize_scenario(const std::vector<SeriesData> &series)
+    {
+        size_t total = sizeof(BinaryHeader) + series.size() * sizeof(SeriesRecord);
+        std::vector<SeriesRecord> records(series.size());
+        for (size_t i = 0; i < series.size(); ++i)
+        {
+            const auto &s = series[i];
+            if (!s.loaded || s.compressed)
+            {
+                throw std::runtime_error("Series " + s.name + " has no plain points to serialize");
+            }
+            auto &r = records[i];
+            r = SeriesRecord{};
+            r.interpolation = static_cast<uint8_t>(s.interpolation);
+            r.type = static_cast<uint8_t>(s.type);
+            r.extrapolation = static_cast<uint8_t>(s.extrapolation);
+            r.flags = (s.integral ? series_flag_integral : 0) | (s.noise.band_limited ? series_flag_band_noise : 0);
+            r.window = s.window;
+            r.noise_sigma = s.noise.sigma;
+            r.noise_step = s.noise.step;
+            r.noise_seed = s.noise.seed;
+            r.size = s.size;
+            r.name_length = static_cast<uint32_t>(s.name.size());
+
+            total = align8(total);
+            r.name_offset = total;
+            total += s.name.size();
+
+            r.input_offset = total;
+            r.input_length = s.input.size();
+            total += s.input.size();
+
+            r.input2_offset = total;
+            r.input2_length = s.input2.size();
+            total += s.input2.size();
+
+            total = align8(total);
+            r.map_offset = total;
+            if (s.map)
+            {
+                r.map_x_size = s.map->x.size();
+                r.map_y_size = s.map->y.size();
+                total += (s.map->x.size() + s.map->y.size() + s.map->z.size()) * sizeof(double);
+            }
+
+            total = align8(total);
+            r.times_offset = total;
+            total += s.size * sizeof(double);
+
+            total = align8(total);
+            r.values_offset = total;
+            total += values_bytes(s.type, s.size);
+
+            total = align8(total);
+            r.shapes_offset = total;
+            r.shape_count = s.shapes.size();
+            total += s.shapes.size() * sizeof(SegmentShape);
+        }
+        total = align8(total);
+
+        std::vector<char> out(total, 0);
+        BinaryHeader header{};
+        std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+        header.version = binary_version;
+        header.series_count = static_cast<uint32_t>(series.size());
+        header.total_size = total;
+        std::memcpy(out.data(), &header, sizeof(header));
+        std::memcpy(out.data() + sizeof(header), records.data(), records.size() * sizeof(SeriesRecord));
+
+        for (size_t i = 0; i < series.size(); ++i)
+        {
+            const auto &s = series[i];
+            const auto &r = records[i];
+            std::memcpy(out.data() + r.name_offset, s.name.data(), s.name.size());
+            std::memcpy(out.data() + r.input_offset, s.input.data(), s.input.size());
+            std::memcpy(out.data() + r.input2_offset, s.input2.data(), s.input2.size());
+            if (s.map)
+            {
+                char *map = out.data() + r.map_offset;
+                for (const auto *part : {&s.map->x, &s.map->y, &s.map->z})
+                {
+                    std::memcpy(map, part->data(), part->size() * sizeof(double));
+                    map += part->size() * sizeof(double);
+                }
+            }
+            std::memcpy(out.data() + r.times_offset, s.times_data(), s.size * sizeof(double));
+            const std::vector<double> widened(s.values32.begin(), s.values32.end());
+            const void *values = !widened.empty()               ? static_cast<const void *>(widened.data())
+                                 : s.mapping                    ? s.mapped_values
+                                 : s.type == ValueType::Integer ? static_cast<const void *>(s.integers.data())
+                                 : s.type == ValueType::Boolean ? static_cast<const void *>(s.booleans.data())
+                                                                : static_cast<const void *>(s.values.data());
+            std::memcpy(out.data() + r.values_offset, values, values_bytes(s.type, s.size));
+            std::memcpy(out.data() + r.shapes_offset, s.shapes.data(), s.shapes.size() * sizeof(SegmentShape));
+        }
+        return out;
+    }
+
+    static SeriesRecord read_record(const char *data, size_t index)
+    {
+        SeriesRecord r;
+        std::memcpy(&r, data + sizeof(BinaryHeader) + index * sizeof(SeriesRecord), sizeof(r));
+        return r;
+    }
+
+    // Check the header and the bounds of every record
+    static BinaryHeader validate_binary(const char *data, size_t size)
+    {
+        BinaryHeader header;
+        if (size < sizeof(header))
+        {
+            throw std::runtime_error("Binary scenario too small");
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, binary_magic, sizeof(binary_magic)) != 0 || header.version != binary_version)
+        {
+            throw std::runtime_error("Not a binary scenario of version " + std::to_string(binary_version));
+        }
+        if (header.total_size > size || sizeof(header) + header.series_count * sizeof(SeriesRecord) > header.total_size)
+        {
+            throw std::runtime_error("Binary scenario truncated");
+        }
+
+        for (size_t i = 0; i < header.series_count; ++i)
+        {
+            const auto r = read_record(data, i);
+            if (r.type > static_cast<uint8_t>(ValueType::Boolean) || r.interpolation > static_cast<uint8_t>(Interpolation::Cubic) ||
+                r.extrapolation > static_cast<uint8_t>(Extrapolation::Repeat))
+            {
+                throw std::runtime_error("Binary scenario record " + std::to_string(i) + " has an unknown type");
+            }
+            const auto type = static_cast<ValueType>(r.type);
+            if (r.size > header.total_size || r.name_offset > header.total_size ||
+                r.times_offset > header.total_size || r.values_offset > header.total_size ||
+                r.shapes_offset > header.total_size || r.shape_count > header.total_size ||
+                r.shapes_offset + r.shape_count * sizeof(SegmentShape) > header.total_size ||
+                r.name_offset + r.name_length > header.total_size ||
+                r.input_offset > header.total_size || r.input_length > header.total_size - r.input_offset ||
+                r.input2_offset > header.total_size || r.input2_length > header.total_size - r.input2_offset ||
+                r.map_offset > header.total_size || r.map_x_size > header.total_size || r.map_y_size > header.total_size ||
+                (r.map_y_size > 0 && r.map_x_size > header.total_size / sizeof(double) / r.map_y_size) ||
+                (r.map_x_size + r.map_y_size + r.map_x_size * r.map_y_size) * sizeof(double) > header.total_size - r.map_offset ||
+                r.times_offset % 8 != 0 || r.values_offset % 8 != 0 ||
+                r.times_offset + r.size * sizeof(double) > header.total_size ||
+                r.values_offset + values_bytes(type, r.size) > header.total_size)
+            {
+                throw std::runtime_error("Binary scenario record " + std::to_string(i) + " out of bounds");
+            }
+        }
+        return header;
+    }
+
+    // Series of a validated buffer. The points are copied, or referenced in place when `mapping`
+    // is given, which must then keep the buffer alive and 8 byte aligned.
+    static std::vector<SeriesData> read_scenario(const char *data, size_t size, const std::shared_ptr<const void> &mapping)
+    {
+        const auto header = validate_binary(data, size);
+        if (mapping && reinterpret_cast<uintptr_t>(data) % 8 != 0)
+        {
+            throw std::runtime_error("Mapped binary scenario must be 8 byte aligned");
+        }
+
+        std::vector<SeriesData> out(header.series_count);
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            const auto r = read_record(data, i);
+            auto &s = out[i];
+            s.name.assign(data + r.name_offset, r.name_length);
+            s.input.assign(data + r.input_offset, r.input_length);
+            s.input2.assign(data + r.input2_offset, r.input2_length);
+            s.interpolation = static_cast<Interpolation>(r.interpolation);
+            s.type = static_cast<ValueType>(r.type);
+            s.extrapolation = static_cast<Extrapolation>(r.extrapolation);
+            s.integral = (r.flags & series_flag_integral) != 0;
+            s.window = r.window > 0.0 && std::isfinite(r.window) ? r.window : 0.0;
+            if (std::isfinite(r.noise_sigma) && r.noise_step > 0.0 && std::isfinite(r.noise_step))
+            {
+                s.noise = {r.noise_sigma, r.noise_step, r.noise_seed, (r.flags & series_flag_band_noise) != 0};
+            }
+            s.size = r.size;
+
+            const char *values = data + r.values_offset;
+            if (mapping)
+            {
+                s.mapping = mapping;
+                s.mapped_times = reinterpret_cast<const double *>(data + r.times_offset);
+                s.mapped_values = values;
+            }
+            else
+            {
+                s.times.resize(r.size);
+                std::memcpy(s.times.data(), data + r.times_offset, r.size * sizeof(double));
+                switch (s.type)
+                {
+                case ValueType::Integer:
+                    s.integers.resize(r.size);
+                    std::memcpy(s.integers.data(), values, values_bytes(s.type, r.size));
+                    break;
+                case ValueType::Boolean:
+                    s.booleans.resize((r.size + 63) / 64);
+                    std::memcpy(s.booleans.data(), values, values_bytes(s.type, r.size));
+                    break;
+                case ValueType::Real:
+                default:
+                    s.values.resize(r.size);
+                    std::memcpy(s.values.data(), values, values_bytes(s.type, r.size));
+                    break;
+                }
+            }
+
+            if (!s.input2.empty())
+            {
+                // The coefficients are rebuilt, the map is always a copy
+                std::vector<double> x(r.map_x_size), y(r.map_y_size), z(r.map_x_size * r.map_y_size);
+                const char *map = data + r.map_offset;
+                for (auto *part : {&x, &y, &z})
+                {
+                    std::memcpy(part->data(), map, part->size() * sizeof(double));
+                    map += part->size() * sizeof(double);
+                }
+                s.map = std::make_shared<const LookupMap>(std::move(x), std::move(y), std::move(z), map_method(s.interpolation));
+            }
+
+            s.shapes.resize(r.shape_count);
+            std::memcpy(s.shapes.data(), data + r.shapes_offset, r.shape_count * sizeof(SegmentShape));
+            for (size_t k = 0; k < s.shapes.size(); ++k)
+            {
+                const auto &shape = s.shapes[k];
+                if (shape.kind > ShapeKind::Hermite || shape.segment + 1 >= s.size || (k > 0 && s.shapes[k - 1].segment >= shape.segment))
+                {
+                    throw std::runtime_error("Binary scenario series " + s.name + " has an invalid segment shape");
+                }
+            }
+        }
+        return out;
+    }
+
+    static std::vector<SeriesData> deserialize_scenario(const char *data, size_t size)
+    {
+        return read_scenario(data, size, nullptr);
+    }
+
+    // Series evaluating the points in place, without copying them. `mapping` keeps `data` alive.
+    static std::vector<SeriesData> map_scenario(const char *data, size_t size, std::shared_ptr<const void> mapping)
+    {
+        return read_scenario(data, size, mapping);
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "series.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    // Breakpoints of all series merged into one ascending calendar. Moving forward walks a single
+    // cursor and only touches the series whose segment changes, instead of every series searching
+    // its own times on every step.
+    //
+    // Passing the point `k` of a series moves it into segment `k`, see find_segment, so an entry
+    // only names the series and the segment index is counted per series.
+    class EventCalendar
+    {
+    public:
+        // Series with points in memory and more than one segment for which `include(index)` holds,
+        // compressed and not yet loaded series keep searching on their own
+        template <class Include>
+        void build(const std::vector<SeriesData> &series, Include &&include)
+        {
+            struct Entry
+            {
+                double time;
+                uint32_t series;
+            };
+            std::vector<Entry> entries;
+            for (uint32_t s = 0; s < series.size(); ++s)
+            {
+                const auto &sd = series[s];
+                if (!sd.loaded || sd.compressed || sd.size < 3 || !include(s))
+                {
+                    continue;
+                }
+                const double *points = sd.times_data();
+                for (size_t k = 1; k + 1 < sd.size; ++k)
+                {
+                    entries.push_back({points[k], s});
+                }
+            }
+            // Stable, the points of one series stay in order when they share a time
+            std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+                             { return a.time < b.time; });
+
+            times.resize(entries.size());
+            owners.resize(entries.size());
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                times[i] = entries[i].time;
+                owners[i] = entries[i].series;
+            }
+            segments.assign(series.size(), 0);
+            rewind();
+        }
+
+        void clear()
+        {
+            std::vector<double>().swap(times);
+            std::vector<uint32_t>().swap(owners);
+            std::vector<size_t>().swap(segments);
+            rewind();
+        }
+
+        bool empty() const { return times.empty(); }
+
+        // Back to the start, as SeriesData::rewind
+        void rewind()
+        {
+            cursor = 0;
+            position = -std::numeric_limits<double>::infinity();
+            std::fill(segments.begin(), segments.end(), 0);
+        }
+
+        // Move the segment of every series changing up to `time`. Going backwards starts over.
+        void advance(std::vector<SeriesData> &series, double time)
+        {
+            if (times.empty())
+            {
+                return;
+            }
+            if (time < position)
+            {
+                for (size_t i = 0; i < cursor; ++i)
+                {
+                    series[owners[i]].access_index = 0;
+                }
+                rewind();
+            }
+            position = time;
+
+            // Points strictly before `time`, a series sitting on a point stays in the segment ending there
+            for (; cursor < times.size() && times[cursor] < time; ++cursor)
+            {
+                const uint32_t s = owners[cursor];
+                series[s].access_index = ++segments[s];
+            }
+        }
+
+        // Memory held by the calendar
+        size_t footprint() const
+        {
+            return times.capacity() * sizeof(double) + owners.capacity() * sizeof(uint32_t) + segments.capacity() * sizeof(size_t);
+        }
+
+    private:
+        std::vector<double> times;
+        std::vector<uint32_t> owners;  // series passing its point at times[i]
+        std::vector<size_t> segments;  // current segment per series
+        size_t cursor = 0;             // first entry not passed yet
+        double position = -std::numeric_limits<double>::infinity();
+    };
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "binary.hpp"
+#include "shared_store.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#ifdef SCENARIO_COMPILED
+// Defined by the source scenario-fmu-package --compiled-source writes, built in with
+// -DSCENARIO_COMPILED_SOURCE=<file>: the binary scenario of the packaged scenario_input as
+// constant words, placed in the read only data of the library
+extern "C"
+{
+    extern const uint64_t compiled_scenario_words[];
+    extern const uint64_t compiled_scenario_size;
+    extern const uint64_t compiled_scenario_key[2];
+}
+#endif
+
+namespace
+{
+    // Scenario compiled into the library. An input equal to the text it was compiled from
+    // evaluates the points in place, without parsing or copying them. Parse options do not apply.
+    struct CompiledScenario
+    {
+        const uint64_t *words;
+        uint64_t size;   // bytes of the binary scenario
+        uint64_t key[2]; // shared_key of the scenario text
+    };
+
+    // Scenario compiled into this library, nullptr without one
+    static const CompiledScenario *linked_scenario()
+    {
+#ifdef SCENARIO_COMPILED
+        static const CompiledScenario compiled{compiled_scenario_words, compiled_scenario_size, {compiled_scenario_key[0], compiled_scenario_key[1]}};
+        return &compiled;
+#else
+        return nullptr;
+#endif
+    }
+
+    static bool compiled_from(const CompiledScenario &compiled, std::string_view input)
+    {
+        const auto key = shared_key(input, "");
+        return key.name_hash == compiled.key[0] && key.check == compiled.key[1];
+    }
+
+    // The words are static, the mapping keeps nothing alive
+    static std::vector<SeriesData> compiled_series(const CompiledScenario &compiled)
+    {
+        const std::shared_ptr<const void> mapping(compiled.words, [](const void *) {});
+        return map_scenario(reinterpret_cast<const char *>(compiled.words), compiled.size, mapping);
+    }
+}
@@ -0,0 +1,351 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+namespace
+{
+    // Append-only stream of bits, most significant bit first
+    class BitWriter
+    {
+    public:
+        // Write the lowest `count` bits of `bits`, count in [1, 64]
+        void write(uint64_t bits, unsigned count)
+        {
+            if (count < 64)
+            {
+                bits &= (uint64_t(1) << count) - 1;
+            }
+            const unsigned used = bit_count & 63;
+            if (used == 0)
+            {
+                words.push_back(0);
+            }
+            const unsigned free_bits = 64 - used;
+            if (count <= free_bits)
+            {
+                words.back() |= bits << (free_bits - count);
+            }
+            else
+            {
+                const unsigned rest = count - free_bits;
+                words.back() |= bits >> rest;
+                words.push_back(bits << (64 - rest));
+            }
+            bit_count += count;
+        }
+
+        size_t size() const { return bit_count; }
+
+        std::vector<uint64_t> words;
+
+    private:
+        size_t bit_count = 0;
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint64_t *words, size_t position)
+            : words(words), position(position) {}
+
+        // Read `count` bits, count in [1, 64]
+        uint64_t read(unsigned count)
+        {
+            const size_t word = position >> 6;
+            const unsigned used = position & 63;
+            const unsigned available = 64 - used;
+
+            uint64_t result = (words[word] << used) >> (64 - count);
+            if (count > available)
+            {
+                const unsigned rest = count - available;
+                result |= words[word + 1] >> (64 - rest);
+            }
+            position += count;
+            return result;
+        }
+
+        bool read_bit() { return read(1) != 0; }
+
+    private:
+        const uint64_t *words;
+        size_t position;
+    };
+
+    // Order preserving mapping of a double onto an unsigned integer, so sorted times
+    // have non negative deltas and regular grids give (almost) constant deltas
+    static uint64_t time_to_key(double t)
+    {
+        const auto bits = std::bit_cast<uint64_t>(t);
+        return (bits >> 63) ? ~bits : (bits | 0x8000000000000000ull);
+    }
+
+    static double key_to_time(uint64_t key)
+    {
+        return std::bit_cast<double>((key >> 63) ? (key & 0x7FFFFFFFFFFFFFFFull) : ~key);
+    }
+
+    static uint64_t zigzag(int64_t v)
+    {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    static int64_t unzigzag(uint64_t v)
+    {
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+
+    // Points of one block decoded back into plain arrays
+    struct DecodedBlock
+    {
+        size_t block = SIZE_MAX;
+        size_t first_index = 0; // index of times[0] within the full series
+        uint64_t last_use = 0;
+        std::vector<double> times;
+        std::vector<double> values;
+    };
+
+    // Series stored in fixed size blocks, Gorilla style:
+    // - times as delta-of-delta of their order preserving integer keys
+    // - values as XOR against the previous value, storing only the meaningful bits
+    // Neighbouring blocks share their boundary point so every segment is contained in a single
+    // block and the evaluator never needs more than one decoded block at a time.
+    class CompressedSeries
+    {
+    public:
+        // Segments per block, a block holds block_stride + 1 points
+        static constexpr size_t block_stride = 255;
+
+        CompressedSeries(const std::vector<double> &times, const std::vector<double> &values)
+            : point_count(times.size()), end_time(times.empty() ? 0.0 : times.back())
+        {
+            const size_t n = point_count;
+            BitWriter writer;
+            for (size_t first = 0; first == 0 || first + 1 < n; first += block_stride)
+            {
+                const size_t last = std::min(first + block_stride, n == 0 ? 0 : n - 1);
+                block_start.push_back(n ? times[first] : 0.0);
+                block_offset.push_back(writer.size());
+                if (n)
+                {
+                    encode_block(writer, times, values, first, last);
+                }
+            }
+            words = std::move(writer.words);
+            words.shrink_to_fit();
+        }
+
+        size_t size() const { return point_count; }
+        size_t block_count() const { return block_start.size(); }
+        double first_time() const { return block_start.front(); }
+        double last_time() const { return end_time; }
+
+        size_t first_index(size_t block) const { return block * block_stride; }
+
+        size_t points_in(size_t block) const
+        {
+            return std::min(first_index(block) + block_stride, point_count - 1) - first_index(block) + 1;
+        }
+
+        // Block holding the segment evaluated at `time`, `hint` is tried first
+        size_t find_block(double time, size_t hint) const
+        {
+            const size_t n = block_count();
+            if (hint < n && (hint == 0 || block_start[hint] < time) && (hint + 1 == n || time <= block_start[hint + 1]))
+            {
+                return hint;
+            }
+            const size_t upper = std::lower_bound(block_start.begin(), block_start.end(), time) - block_start.begin();
+            return std::min(std::max<size_t>(upper, 1) - 1, n - 1);
+        }
+
+        void decode(size_t block, DecodedBlock &out) const
+        {
+            const size_t count = points_in(block);
+            out.block = block;
+            out.first_index = first_index(block);
+            out.times.resize(count);
+            out.values.resize(count);
+
+            BitReader reader(words.data(), block_offset[block]);
+
+            uint64_t key = time_to_key(block_start[block]);
+            uint64_t delta = 0;
+            uint64_t value_bits = reader.read(64);
+            unsigned leading = 64;
+            unsigned trailing = 0;
+
+            out.times[0] = block_start[block];
+            out.values[0] = std::bit_cast<double>(value_bits);
+
+            for (size_t i = 1; i < count; ++i)
+            {
+                delta += static_cast<uint64_t>(read_delta_of_delta(reader));
+                key += delta;
+                out.times[i] = key_to_time(key);
+
+                if (reader.read_bit())
+                {
+                    if (reader.read_bit())
+                    {
+                        leading = static_cast<unsigned>(reader.read(6));
+                        const unsigned length = static_cast<unsigned>(reader.read(6)) + 1;
+                        trailing = 64 - leading - length;
+                    }
+                    const unsigned length = 64 - leading - trailing;
+                    value_bits ^= reader.read(length) << trailing;
+                }
+                out.values[i] = std::bit_cast<double>(value_bits);
+            }
+        }
+
+        size_t footprint() const
+        {
+            return sizeof(*this) + words.capacity() * sizeof(uint64_t) + block_start.capacity() * sizeof(double) + block_offset.capacity() * sizeof(size_t);
+        }
+
+    private:
+        static void encode_block(BitWriter &writer, const std::vector<double> &times, const std::vector<double> &values, size_t first, size_t last)
+        {
+            uint64_t key = time_to_key(times[first]);
+            uint64_t delta = 0;
+            uint64_t value_bits = std::bit_cast<uint64_t>(values[first]);
+            unsigned leading = 64;
+            unsigned trailing = 0;
+
+            writer.write(value_bits, 64);
+
+            for (size_t i = first + 1; i <= last; ++i)
+            {
+                const uint64_t next_key = time_to_key(times[i]);
+                const uint64_t next_delta = next_key - key;
+                write_delta_of_delta(writer, static_cast<int64_t>(next_delta - delta));
+                key = next_key;
+                delta = next_delta;
+
+                const uint64_t next_bits = std::bit_cast<uint64_t>(values[i]);
+                const uint64_t x = next_bits ^ value_bits;
+                value_bits = next_bits;
+                if (x == 0)
+                {
+                    writer.write(0, 1);
+                    continue;
+                }
+
+                const unsigned lead = static_cast<unsigned>(std::countl_zero(x));
+                const unsigned trail = static_cast<unsigned>(std::countr_zero(x));
+                if (leading <= lead && trailing <= trail)
+                {
+                    // Fits in the previous window of meaningful bits
+                    writer.write(0b10, 2);
+                    writer.write(x >> trailing, 64 - leading - trailing);
+                }
+                else
+                {
+                    const unsigned length = 64 - lead - trail;
+                    writer.write(0b11, 2);
+                    writer.write(lead, 6);
+                    writer.write(length - 1, 6);
+                    writer.write(x >> trail, length);
+                    leading = lead;
+                    trailing = trail;
+                }
+            }
+        }
+
+        static void write_delta_of_delta(BitWriter &writer, int64_t dod)
+        {
+            const uint64_t z = zigzag(dod);
+            if (z == 0)
+            {
+                writer.write(0b0, 1);
+            }
+            else if (z < (1u << 7))
+            {
+                writer.write(0b10, 2);
+                writer.write(z, 7);
+            }
+            else if (z < (1u << 9))
+            {
+                writer.write(0b110, 3);
+                writer.write(z, 9);
+            }
+            else if (z < (1u << 12))
+            {
+                writer.write(0b1110, 4);
+                writer.write(z, 12);
+            }
+            else
+            {
+                writer.write(0b1111, 4);
+                writer.write(z, 64);
+            }
+        }
+
+        static int64_t read_delta_of_delta(BitReader &reader)
+        {
+            if (!reader.read_bit())
+                return 0;
+            if (!reader.read_bit())
+                return unzigzag(reader.read(7));
+            if (!reader.read_bit())
+                return unzigzag(reader.read(9));
+            if (!reader.read_bit())
+                return unzigzag(reader.read(12));
+            return unzigzag(reader.read(64));
+        }
+
+        size_t point_count;
+        double end_time;
+        std::vector<uint64_t> words;
+        std::vector<double> block_start;
+        std::vector<size_t> block_offset;
+    };
+
+    // Small least recently used cache of decoded blocks, owned by the evaluating instance
+    class BlockCache
+    {
+    public:
+        static constexpr size_t capacity = 2;
+
+        const DecodedBlock &get(const CompressedSeries &series, size_t block)
+        {
+            ++clock;
+            DecodedBlock *victim = &entries[0];
+            for (auto &entry : entries)
+            {
+                if (entry.block == block)
+                {
+                    entry.last_use = clock;
+                    return entry;
+                }
+                if (entry.last_use < victim->last_use)
+                {
+                    victim = &entry;
+                }
+            }
+            series.decode(block, *victim);
+            victim->last_use = clock;
+            return *victim;
+        }
+
+        size_t footprint() const
+        {
+            size_t bytes = 0;
+            for (const auto &entry : entries)
+            {
+                bytes += (entry.times.capacity() + entry.values.capacity()) * sizeof(double);
+            }
+            return bytes;
+        }
+
+    private:
+        std::array<DecodedBlock, capacity> entries;
+        uint64_t clock = 0;
+    };
+}
@@ -31,9 +31,19 @@ namespace FMI2
     class fmi2Experiment
     {
     public:
-        fmi2Experiment() {}
+        fmi2Experiment() { reset(); }
         ~fmi2Experiment() {}
 
+        void reset()
+        {
+            toleranceDefined = fmiFalse;
+            stopTimeDefined = fmiFalse;
+            tolerance = 0.0;
+            startTime = 0.0;
+            stopTime = 0.0;
+            time = 0.0;
+        }
+
         fmi2Boolean toleranceDefined;
         fmi2Boolean stopTimeDefined;
         fmi2Real tolerance;
@@ -56,6 +66,15 @@ namespace FMI2
             return static_cast<T*>(c);
         }
 
+        // Forward a message to the environment's logger, if logging is on
+        void log(fmi2Status status, fmi2String category, const std::string &message) const
+        {
+            if (loggingOn && callbacks && callbacks->logger)
+            {
+                callbacks->logger(callbacks->componentEnvironment, name.c_str(), status, category, "%s", message.c_str());
+            }
+        }
+
         std::string name;
         fmi2Type type;
         std::string GUID;
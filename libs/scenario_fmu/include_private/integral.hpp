@@ -0,0 +1,119 @@
+#pragma once
+
+#include "series.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Time integral of a Real series from its first point, served as an extra output for series
+    // with the Integral modifier. build_integral sums every segment once, the integral at any time
+    // is then the sum up to the segment holding it plus the part of that one segment. Exact for
+    // every interpolation and shape, only chirp segments are summed numerically into a table of panels
+    // built with the sums, see ChirpIntegral.
+
+    // Integral of the segment [t0, t1] from t0 to `time`, t0 <= time <= t1
+    static double segment_integral(Interpolation interpolation, const SegmentShape *shape, const ChirpIntegral *chirp,
+                                   double t0, double v0, double t1, double v1, double time)
+    {
+        if (shape)
+        {
+            return shape_integral(*shape, t0, v0, t1, v1, time, chirp);
+        }
+        const double tau = time - t0;
+        switch (interpolation)
+        {
+        case Interpolation::Zoh:
+            return v0 * tau;
+        case Interpolation::NearestNeighbor:
+        {
+            // The first value up to the middle, see interpolate
+            const double middle = t0 + 0.5 * (t1 - t0);
+            return time <= middle ? v0 * tau : v0 * (middle - t0) + v1 * (time - middle);
+        }
+        case Interpolation::Linear:
+        case Interpolation::Cubic: // evaluated as linear
+        default:
+            return tau == 0.0 ? 0.0 : 0.5 * tau * (v0 + interpolate(Interpolation::Linear, t0, v0, t1, v1, time));
+        }
+    }
+
+    // Sum the integral up to every point. Runs on the plain points, before the series is compressed.
+    static void build_integral(SeriesData &sd)
+    {
+        // The Window modifier takes its mean from the integral
+        if ((!sd.integral && !(sd.window > 0.0)) || !sd.loaded || sd.compressed || sd.type != ValueType::Real || sd.cumulative.size() == sd.size)
+        {
+            return;
+        }
+        const auto view = sd.view_at(0.0);
+        sd.cumulative.resize(sd.size);
+        sd.chirp_integrals.clear();
+        for (const auto &shape : sd.shapes)
+        {
+            if (shape.kind == ShapeKind::Chirp && shape.segment + 1 < sd.size)
+            {
+                sd.chirp_integrals.push_back(chirp_integral(shape, shape.segment, view.times[shape.segment + 1] - view.times[shape.segment]));
+            }
+        }
+        double sum = 0.0;
+        for (size_t i = 0; i < sd.size; ++i)
+        {
+            if (i > 0)
+            {
+                sum += segment_integral(sd.interpolation, sd.shape_at(i - 1), sd.chirp_integral_at(i - 1), view.times[i - 1],
+                                        view.value(i - 1), view.times[i], view.value(i), view.times[i]);
+            }
+            sd.cumulative[i] = sum;
+        }
+    }
+
+    // Integral from the first point up to `time` within the points, first <= time <= last
+    static double integral_within(SeriesData &sd, double time)
+    {
+        const auto view = sd.view_at(time);
+        if (view.size == 1)
+        {
+            return 0.0;
+        }
+        const size_t index = locate_segment(sd, view, sd.access_index - std::min(sd.access_index, view.first_index), time);
+        sd.access_index = view.first_index + index;
+
+        const size_t segment = view.first_index + index;
+        const double t0 = view.times[index];
+        const double t1 = view.times[index + 1];
+        return sd.cumulative[segment] + segment_integral(sd.interpolation, sd.shape_at(segment), sd.chirp_integral_at(segment), t0,
+                                                         view.value(index), t1, view.value(index + 1), std::clamp(time, t0, t1));
+    }
+
+    // Integral of a series from its first point up to `time`, 0 before it.
+    // After the last point it follows the extrapolation, a Repeat series adds its integral once per period.
+    static double eval_integral_at(SeriesData &sd, double time)
+    {
+        if (sd.size == 0 || sd.cumulative.size() != sd.size || time < sd.first_time())
+        {
+            return 0.0;
+        }
+        const double first = sd.first_time();
+        const double last = sd.last_time();
+        const double total = sd.cumulative.back();
+        if (time <= last)
+        {
+            return integral_within(sd, time);
+        }
+
+        const double period = last - first;
+        if (sd.extrapolation == Extrapolation::Zero)
+        {
+            return total;
+        }
+        if (sd.extrapolation == Extrapolation::Repeat && period > 0.0)
+        {
+            const double periods = std::floor((time - first) / period);
+            return periods * total + integral_within(sd, std::clamp(time - periods * period, first, last));
+        }
+        const auto view = sd.view_at(last);
+        return total + view.value(view.size - 1) * (time - last);
+    }
+}
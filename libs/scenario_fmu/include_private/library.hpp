@@ -0,0 +1,157 @@
+#pragma once
+
+#include "binary.hpp"
+
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Library of binary scenarios packaged in the resources of the FMU, selected by scenario_index.
+    // Every scenario lists the same series in output order, series a scenario lacks have no points.
+    // The file is read once per process, instances evaluate the points in place.
+    //
+    // LibraryHeader
+    // LibraryEntry[count]
+    // binary scenarios, see binary.hpp, each 8 byte aligned
+    inline constexpr char library_magic[8] = {'S', 'C', 'E', 'N', 'L', 'I', 'B', '1'};
+    inline constexpr const char *library_file = "scenarios.bin";
+
+    struct LibraryHeader
+    {
+        char magic[8];
+        uint32_t count;
+        uint32_t reserved;
+        uint64_t total_size;
+    };
+
+    struct LibraryEntry
+    {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    class ScenarioLibrary
+    {
+    public:
+        // Throws if `words` does not hold a valid library of `size` bytes
+        ScenarioLibrary(std::vector<uint64_t> &&words, size_t size)
+        {
+            auto storage = std::make_shared<const std::vector<uint64_t>>(std::move(words));
+            const char *data = reinterpret_cast<const char *>(storage->data());
+
+            LibraryHeader header;
+            if (size < sizeof(header))
+            {
+                throw std::runtime_error("Scenario library too small");
+            }
+            std::memcpy(&header, data, sizeof(header));
+            if (std::memcmp(header.magic, library_magic, sizeof(library_magic)) != 0)
+            {
+                throw std::runtime_error("Not a scenario library");
+            }
+            if (header.total_size > size || sizeof(header) + header.count * sizeof(LibraryEntry) > header.total_size)
+            {
+                throw std::runtime_error("Scenario library truncated");
+            }
+
+            scenarios.reserve(header.count);
+            for (size_t i = 0; i < header.count; ++i)
+            {
+                LibraryEntry entry;
+                std::memcpy(&entry, data + sizeof(header) + i * sizeof(LibraryEntry), sizeof(entry));
+                if (entry.offset % 8 != 0 || entry.offset > header.total_size || entry.size > header.total_size - entry.offset)
+                {
+                    throw std::runtime_error("Scenario library entry " + std::to_string(i) + " out of bounds");
+                }
+                scenarios.push_back(map_scenario(data + entry.offset, entry.size, storage));
+            }
+        }
+
+        size_t size() const { return scenarios.size(); }
+
+        const std::vector<SeriesData> &scenario(size_t index) const { return scenarios.at(index); }
+
+    private:
+        std::vector<std::vector<SeriesData>> scenarios; // points in the shared file content
+    };
+
+    // Library file of a resources directory, loaded once per process while any instance uses it.
+    // Throws if the file can not be read or is not a valid library.
+    static std::shared_ptr<const ScenarioLibrary> load_library(const std::string &path)
+    {
+        static std::mutex mutex;
+        static std::map<std::string, std::weak_ptr<const ScenarioLibrary>> loaded;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (auto library = loaded[path].lock())
+        {
+            return library;
+        }
+
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            throw std::runtime_error("Can not open scenario library " + path);
+        }
+        const auto size = static_cast<size_t>(file.tellg());
+        std::vector<uint64_t> words((size + 7) / 8);
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char *>(words.data()), static_cast<std::streamsize>(size)))
+        {
+            throw std::runtime_error("Can not read scenario library " + path);
+        }
+
+        auto library = std::make_shared<const ScenarioLibrary>(std::move(words), size);
+        loaded[path] = library;
+        return library;
+    }
+
+    // Directory of a resource location, FMI 2.0 gives a file URI, FMI 3.0 a path
+    static std::string resource_directory(const std::string &location)
+    {
+        std::string path = location;
+        if (path.rfind("file://", 0) == 0)
+        {
+            path.erase(0, 7);
+        }
+        else if (path.rfind("file:", 0) == 0)
+        {
+            path.erase(0, 5);
+        }
+        if (path.size() > 2 && path[0] == '/' && path[2] == ':')
+        {
+            // file:///C:/...
+            path.erase(0, 1);
+        }
+
+        // Percent decoding, spaces and other reserved characters in the path
+        std::string decoded;
+        for (size_t i = 0; i < path.size(); ++i)
+        {
+            if (path[i] == '%' && i + 2 < path.size() && std::isxdigit(static_cast<unsigned char>(path[i + 1])) &&
+                std::isxdigit(static_cast<unsigned char>(path[i + 2])))
+            {
+                decoded += static_cast<char>(std::stoi(path.substr(i + 1, 2), nullptr, 16));
+                i += 2;
+            }
+            else
+            {
+                decoded += path[i];
+            }
+        }
+        while (!decoded.empty() && (decoded.back() == '/' || decoded.back() == '\\'))
+        {
+            decoded.pop_back();
+        }
+        return decoded;
+    }
+}
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // How a map interpolates within a cell
+    enum class MapMethod
+    {
+        Corner,   // value of the lower corner, as zero order hold
+        Nearest,  // value of the nearest corner
+        Bilinear,
+        Bicubic   // C1 patches through the corner values and estimated slopes
+    };
+
+    // Value of a map and its partial derivatives over both inputs
+    struct MapValue
+    {
+        double value = 0.0;
+        double dx = 0.0;
+        double dy = 0.0;
+    };
+
+    // 2-D lookup table over two inputs, z(x, y) on the grid of axes `x` and `y`. Inputs outside
+    // the axes are clamped. The polynomial of every cell is computed once when the map is built
+    // and stored as one tile of coefficients, tiles in row-major cell order: a lookup reads one
+    // contiguous block of 4 (bilinear) or 16 (bicubic) doubles, neighbouring cells of a row are
+    // neighbours in memory.
+    class LookupMap
+    {
+    public:
+        // Throws if the axes are not strictly increasing with at least two points or `z` does not hold
+        // x.size() rows of y.size() values
+        LookupMap(std::vector<double> x_axis, std::vector<double> y_axis, std::vector<double> z_values, MapMethod map_method)
+            : x(std::move(x_axis)), y(std::move(y_axis)), z(std::move(z_values)), method(map_method)
+        {
+            check_axis(x, "first");
+            check_axis(y, "second");
+            if (z.size() != x.size() * y.size())
+            {
+                throw std::runtime_error("Map has " + std::to_string(z.size()) + " values, its axes need " + std::to_string(x.size() * y.size()));
+            }
+            for (const double v : z)
+            {
+                if (!std::isfinite(v))
+                {
+                    throw std::runtime_error("Map values must be finite");
+                }
+            }
+            if (method == MapMethod::Bicubic)
+            {
+                build_bicubic();
+            }
+            else
+            {
+                build_bilinear();
+            }
+        }
+
+        const std::vector<double> x;
+        const std::vector<double> y;
+        const std::vector<double> z; // z[i * y.size() + j] at (x[i], y[j])
+        const MapMethod method;
+
+        // Value at (xv, yv). `cx` and `cy` are the cells of the last lookup, checked with their
+        // neighbours first, as an input mostly moves by little between steps.
+        MapValue eval(double xv, double yv, size_t &cx, size_t &cy) const
+        {
+            // Clamped inputs do not change the value
+            const bool x_inside = xv > x.front() && xv < x.back();
+            const bool y_inside = yv > y.front() && yv < y.back();
+            xv = std::clamp(xv, x.front(), x.back());
+            yv = std::clamp(yv, y.front(), y.back());
+            cx = cell(x, cx, xv);
+            cy = cell(y, cy, yv);
+
+            const double hx = x[cx + 1] - x[cx];
+            const double hy = y[cy + 1] - y[cy];
+            double u = (xv - x[cx]) / hx;
+            double v = (yv - y[cy]) / hy;
+            const double *c = tiles.data() + (cx * (y.size() - 1) + cy) * tile_size();
+
+            MapValue out;
+            switch (method)
+            {
+            case MapMethod::Corner:
+            case MapMethod::Nearest:
+                // Onto a corner of the bilinear tile, the upper one only on the upper bound of the
+                // cell, as a zero order hold series on its next point
+                u = method == MapMethod::Corner ? (u < 1.0 ? 0.0 : 1.0) : (u <= 0.5 ? 0.0 : 1.0);
+                v = method == MapMethod::Corner ? (v < 1.0 ? 0.0 : 1.0) : (v <= 0.5 ? 0.0 : 1.0);
+                out.value = c[0] + c[1] * u + c[2] * v + c[3] * u * v;
+                return out;
+            case MapMethod::Bilinear:
+                out.value = c[0] + c[1] * u + c[2] * v + c[3] * u * v;
+                out.dx = c[1] + c[3] * v;
+                out.dy = c[2] + c[3] * u;
+                break;
+            case MapMethod::Bicubic:
+            default:
+            {
+                // p(u, v) = sum of c[4a + b] u^a v^b, Horner over v per power of u, then over u
+                double p[4];
+                double dp[4];
+                for (size_t a = 0; a < 4; ++a)
+                {
+                    const double *row = c + 4 * a;
+                    p[a] = ((row[3] * v + row[2]) * v + row[1]) * v + row[0];
+                    dp[a] = (3.0 * row[3] * v + 2.0 * row[2]) * v + row[1];
+                }
+                out.value = ((p[3] * u + p[2]) * u + p[1]) * u + p[0];
+                out.dx = (3.0 * p[3] * u + 2.0 * p[2]) * u + p[1];
+                out.dy = ((dp[3] * u + dp[2]) * u + dp[1]) * u + dp[0];
+                break;
+            }
+            }
+            // Per unit cell to per unit of the inputs
+            out.dx = x_inside ? out.dx / hx : 0.0;
+            out.dy = y_inside ? out.dy / hy : 0.0;
+            return out;
+        }
+
+        size_t footprint() const
+        {
+            return (x.capacity() + y.capacity() + z.capacity() + tiles.capacity()) * sizeof(double);
+        }
+
+    private:
+        static void check_axis(const std::vector<double> &axis, const char *which)
+        {
+            if (axis.size() < 2)
+            {
+                throw std::runtime_error(std::string("The ") + which + " axis of a map needs at least two points");
+            }
+            for (size_t i = 0; i < axis.size(); ++i)
+            {
+                if (!std::isfinite(axis[i]) || (i > 0 && !(axis[i] > axis[i - 1])))
+                {
+                    throw std::runtime_error(std::string("The ") + which + " axis of a map must be finite and strictly increasing");
+                }
+            }
+        }
+
+        // Cell i with axis[i] < v <= axis[i + 1], the first cell for v on the first point
+        static size_t cell(const std::vector<double> &axis, size_t hint, double v)
+        {
+            const size_t last = axis.size() - 2;
+            hint = std::min(hint, last);
+            const size_t to = std::min(hint + 1, last);
+            for (size_t i = hint > 0 ? hint - 1 : 0; i <= to; ++i)
+            {
+                if ((i == 0 || axis[i] < v) && (i == last || axis[i + 1] >= v))
+                {
+                    return i;
+                }
+            }
+            const auto upper = std::lower_bound(axis.begin(), axis.end(), v) - axis.begin();
+            return std::min(static_cast<size_t>(std::max<ptrdiff_t>(upper, 1) - 1), last);
+        }
+
+        size_t tile_size() const
+        {
+            return method == MapMethod::Bicubic ? 16 : 4;
+        }
+
+        double at(size_t i, size_t j) const
+        {
+            return z[i * y.size() + j];
+        }
+
+        void build_bilinear()
+        {
+            tiles.reserve((x.size() - 1) * (y.size() - 1) * 4);
+            for (size_t i = 0; i + 1 < x.size(); ++i)
+            {
+                for (size_t j = 0; j + 1 < y.size(); ++j)
+                {
+                    const double z00 = at(i, j), z10 = at(i + 1, j), z01 = at(i, j + 1), z11 = at(i + 1, j + 1);
+                    tiles.insert(tiles.end(), {z00, z10 - z00, z01 - z00, z11 - z10 - z01 + z00});
+                }
+            }
+        }
+
+        // Bicubic Hermite patches: the slopes at the grid points are central differences, one sided
+        // on the edges, and every cell solves A = M F M^T for its corner values F once
+        void build_bicubic()
+        {
+            const size_t nx = x.size();
+            const size_t ny = y.size();
+            std::vector<double> gx(nx * ny), gy(nx * ny), gxy(nx * ny);
+            for (size_t i = 0; i < nx; ++i)
+            {
+                const size_t i0 = i > 0 ? i - 1 : 0, i1 = std::min(i + 1, nx - 1);
+                for (size_t j = 0; j < ny; ++j)
+                {
+                    const size_t j0 = j > 0 ? j - 1 : 0, j1 = std::min(j + 1, ny - 1);
+                    gx[i * ny + j] = (at(i1, j) - at(i0, j)) / (x[i1] - x[i0]);
+                    gy[i * ny + j] = (at(i, j1) - at(i, j0)) / (y[j1] - y[j0]);
+                    gxy[i * ny + j] = (at(i1, j1) - at(i1, j0) - at(i0, j1) + at(i0, j0)) / ((x[i1] - x[i0]) * (y[j1] - y[j0]));
+                }
+            }
+
+            static constexpr double m[4][4] = {{1, 0, 0, 0}, {0, 0, 1, 0}, {-3, 3, -2, -1}, {2, -2, 1, 1}};
+            tiles.reserve((nx - 1) * (ny - 1) * 16);
+            for (size_t i = 0; i + 1 < nx; ++i)
+            {
+                const double hx = x[i + 1] - x[i];
+                for (size_t j = 0; j + 1 < ny; ++j)
+                {
+                    const double hy = y[j + 1] - y[j];
+                    // Rows: value at u = 0, 1, slope over u at u = 0, 1. Columns the same over v.
+                    double f[4][4];
+                    for (size_t a = 0; a < 2; ++a)
+                    {
+                        for (size_t b = 0; b < 2; ++b)
+                        {
+                            const size_t k = (i + a) * ny + j + b;
+                            f[a][b] = z[k];
+                            f[a][b + 2] = gy[k] * hy;
+                            f[a + 2][b] = gx[k] * hx;
+                            f[a + 2][b + 2] = gxy[k] * hx * hy;
+                        }
+                    }
+                    double mf[4][4] = {};
+                    for (size_t r = 0; r < 4; ++r)
+                    {
+                        for (size_t k = 0; k < 4; ++k)
+                        {
+                            for (size_t c = 0; c < 4; ++c)
+                            {
+                                mf[r][c] += m[r][k] * f[k][c];
+                            }
+                        }
+                    }
+                    for (size_t r = 0; r < 4; ++r)
+                    {
+                        for (size_t c = 0; c < 4; ++c)
+                        {
+                            double sum = 0.0;
+                            for (size_t k = 0; k < 4; ++k)
+                            {
+                                sum += mf[r][k] * m[c][k];
+                            }
+                            tiles.push_back(sum);
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<double> tiles;
+    };
+}
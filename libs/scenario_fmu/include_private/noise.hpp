@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+namespace
+{
+    // Philox4x32-10 counter based generator (Salmon et al., "Parallel random numbers: as easy as
+    // 1, 2, 3"). Four random words are a pure function of a counter and a key, there is no state:
+    // sample k of a noise is the same for every instance, after any rollback and in any order.
+    using PhiloxWords = std::array<uint32_t, 4>;
+
+    static PhiloxWords philox4x32(PhiloxWords counter, uint64_t key)
+    {
+        uint32_t k0 = static_cast<uint32_t>(key);
+        uint32_t k1 = static_cast<uint32_t>(key >> 32);
+        for (int round = 0; round < 10; ++round)
+        {
+            const uint64_t p0 = uint64_t(0xD2511F53) * counter[0];
+            const uint64_t p1 = uint64_t(0xCD9E8D57) * counter[2];
+            counter = {static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ k0, static_cast<uint32_t>(p1),
+                       static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ k1, static_cast<uint32_t>(p0)};
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+        }
+        return counter;
+    }
+
+    // Noise added to a Real series, declared by the Noise and BandNoise modifiers. Sample k is a
+    // normal variate with standard deviation `sigma` drawn for the time step [k * step, (k + 1) * step).
+    // White noise holds a sample for its step, band limited noise interpolates linearly between
+    // consecutive samples, which keeps it below about 1 / (2 * step) Hz.
+    struct Noise
+    {
+        double sigma = 0.0;
+        double step = 0.0;
+        uint64_t seed = 0;
+        bool band_limited = false;
+
+        bool enabled() const
+        {
+            return sigma != 0.0 && step > 0.0;
+        }
+    };
+
+    // Standard normal sample `k` of a seed, Box-Muller on two words of one Philox block
+    static double noise_sample(uint64_t seed, int64_t k)
+    {
+        const auto words = philox4x32({static_cast<uint32_t>(k), static_cast<uint32_t>(static_cast<uint64_t>(k) >> 32), 0, 0}, seed);
+        constexpr double scale = 1.0 / 4294967296.0;
+        const double u1 = (words[0] + 0.5) * scale; // (0, 1), the log stays finite
+        const double u2 = (words[1] + 0.5) * scale;
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * std::numbers::pi * u2);
+    }
+
+    static double noise_at(const Noise &noise, double time)
+    {
+        const double position = time / noise.step;
+        const double k = std::floor(position);
+        const double n0 = noise_sample(noise.seed, static_cast<int64_t>(k));
+        if (!noise.band_limited)
+        {
+            return noise.sigma * n0;
+        }
+        const double n1 = noise_sample(noise.seed, static_cast<int64_t>(k) + 1);
+        return noise.sigma * (n0 + (position - k) * (n1 - n0));
+    }
+
+    // Derivative of the noise over time, white noise is constant within its steps
+    static double noise_derivative_at(const Noise &noise, double time)
+    {
+        if (!noise.band_limited)
+        {
+            return 0.0;
+        }
+        const auto k = static_cast<int64_t>(std::floor(time / noise.step));
+        return noise.sigma * (noise_sample(noise.seed, k + 1) - noise_sample(noise.seed, k)) / noise.step;
+    }
+
+    // Add the noise at `n` times to `out`, times before `start` stay without noise
+    static void add_noise(const Noise &noise, double start, const double *times, size_t n, double *out)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] += times[i] < start ? 0.0 : noise_at(noise, times[i]);
+        }
+    }
+}
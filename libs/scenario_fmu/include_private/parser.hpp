@@ -0,0 +1,679 @@
+#pragma once
+
+#include "series.hpp"
+#include "string.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Inputs smaller than this are parsed on the calling thread, starting workers costs more
+    inline constexpr size_t parallel_parse_min_bytes = 1 << 20;
+
+    static double parse_number(std::string_view token, const SeriesData &d)
+    {
+        const auto v = parse_double_opt(trim_view(token));
+        if (!v)
+        {
+            throw std::runtime_error("Invalid number '" + std::string(token) + "' in series " + d.name);
+        }
+        return *v;
+    }
+
+    // Apply a series modifier, a token between the interpolation method and the points
+    static void apply_modifier(SeriesData &d, std::string_view token)
+    {
+        if (token == "Real")
+            d.type = ValueType::Real;
+        else if (token == "Integer")
+            d.type = ValueType::Integer;
+        else if (token == "Boolean")
+            d.type = ValueType::Boolean;
+        else if (token == "Hold")
+            d.extrapolation = Extrapolation::Hold;
+        else if (token == "Zero")
+            d.extrapolation = Extrapolation::Zero;
+        else if (token == "Repeat")
+            d.extrapolation = Extrapolation::Repeat;
+        else if (token == "Float32")
+            d.float32 = true;
+        else if (token.starts_with("Float32(") && token.back() == ')')
+        {
+            // Float32(bound): the largest error rounding a value may cause
+            d.float32 = true;
+            d.float32_bound = parse_number(token.substr(8, token.size() - 9), d);
+        }
+        else if (token.starts_with("Input(") && token.back() == ')')
+        {
+            // Input(name): the points are indexed by the Real input `name` instead of time
+            if (!d.input.empty())
+            {
+                throw std::runtime_error("Series " + d.name + " takes one Input or Map modifier");
+            }
+            d.input = std::string(trim_view(token.substr(6, token.size() - 7)));
+            if (d.input.empty() || d.input.find_first_of(",()") != std::string::npos)
+            {
+                throw std::runtime_error("Invalid input name '" + std::string(token) + "' for series " + d.name);
+            }
+        }
+        else if (token.starts_with("Map(") && token.back() == ')')
+        {
+            // Map(x,y): a table over the Real inputs `x` and `y` instead of points over time
+            const auto names = split(std::string(token.substr(4, token.size() - 5)), ",");
+            if (!d.input.empty())
+            {
+                throw std::runtime_error("Series " + d.name + " takes one Input or Map modifier");
+            }
+            if (names.size() != 2)
+            {
+                throw std::runtime_error("Map of series " + d.name + " takes two input names");
+            }
+            d.input = std::string(trim_view(names[0]));
+            d.input2 = std::string(trim_view(names[1]));
+            if (d.input.empty() || d.input2.empty() || d.input.find_first_of("()") != std::string::npos ||
+                d.input2.find_first_of("()") != std::string::npos)
+            {
+                throw std::runtime_error("Invalid input names '" + std::string(token) + "' for series " + d.name);
+            }
+        }
+        else if (token == "Integral")
+            d.integral = true;
+        else if (token.starts_with("Window(") && token.back() == ')')
+        {
+            // Window(length): moving minimum, maximum and mean over the last `length` seconds
+            d.window = parse_number(token.substr(7, token.size() - 8), d);
+            if (!(d.window > 0.0) || !std::isfinite(d.window))
+            {
+                throw std::runtime_error("Window of series " + d.name + " must be a positive length");
+            }
+        }
+        else if ((token.starts_with("Noise(") || token.starts_with("BandNoise(")) && token.back() == ')')
+        {
+            // Noise(sigma,step[,seed]), BandNoise(sigma,step[,seed])
+            const size_t open = token.find('(');
+            const auto params = split(std::string(token.substr(open + 1, token.size() - open - 2)), ",");
+            if (params.size() < 2 || params.size() > 3)
+            {
+                throw std::runtime_error("Noise of series " + d.name + " takes sigma, step and an optional seed");
+            }
+            d.noise.band_limited = token.starts_with("Band");
+            d.noise.sigma = parse_number(params[0], d);
+            d.noise.step = parse_number(params[1], d);
+            const double seed = params.size() == 3 ? parse_number(params[2], d) : 0.0;
+            if (!std::isfinite(d.noise.sigma) || !(d.noise.step > 0.0) || !std::isfinite(d.noise.step) ||
+                !(seed >= 0.0) || seed != std::floor(seed) || seed > 9007199254740992.0)
+            {
+                throw std::runtime_error("Invalid noise '" + std::string(token) + "' for series " + d.name);
+            }
+            d.noise.seed = static_cast<uint64_t>(seed);
+        }
+        else
+            throw std::runtime_error("Unknown modifier '" + std::string(token) + "' for series " + d.name);
+    }
+
+    // Value of an Integer point in the int32 range, or of a Boolean point: 0, 1, false or true
+    static int32_t parse_discrete(std::string_view token, const SeriesData &d)
+    {
+        token = trim_view(token);
+        if (token == "true")
+            return 1;
+        if (token == "false")
+            return 0;
+        const auto v = parse_integer_opt(token);
+        if (!v)
+        {
+            throw std::runtime_error("Invalid value '" + std::string(token) + "' in series " + d.name);
+        }
+        if (d.type == ValueType::Boolean ? *v != 0 && *v != 1
+                                         : *v < std::numeric_limits<int32_t>::min() || *v > std::numeric_limits<int32_t>::max())
+        {
+            throw std::runtime_error("Value '" + std::string(token) + "' out of range for the " +
+                                     (d.type == ValueType::Boolean ? "Boolean" : "Integer") + " series " + d.name);
+        }
+        return static_cast<int32_t>(*v);
+    }
+
+    // Parse a segment shape: name or name(p0,p1,...), applied to the segment ending at the next point
+    static SegmentShape parse_shape(std::string_view token, const SeriesData &d)
+    {
+        const size_t open = token.find('(');
+        const auto name = trim_view(token.substr(0, open));
+
+        SegmentShape shape;
+        if (name == "ramp")
+            shape.kind = ShapeKind::Ramp;
+        else if (name == "step")
+            shape.kind = ShapeKind::Step;
+        else if (name == "sin")
+            shape.kind = ShapeKind::Sine;
+        else if (name == "chirp")
+            shape.kind = ShapeKind::Chirp;
+        else if (name == "hermite")
+            shape.kind = ShapeKind::Hermite;
+        else
+            throw std::runtime_error("Unknown segment shape '" + std::string(token) + "' in series " + d.name);
+
+        std::vector<std::string> params;
+        if (open != std::string_view::npos)
+        {
+            if (token.back() != ')')
+            {
+                throw std::runtime_error("Missing ')' in segment shape '" + std::string(token) + "' in series " + d.name);
+            }
+            params = split(std::string(token.substr(open + 1, token.size() - open - 2)), ",");
+        }
+
+        const size_t expected = shape_param_count(shape.kind);
+        if (params.size() > expected || params.size() + shape_optional_params(shape.kind) < expected)
+        {
+            throw std::runtime_error("Segment shape '" + std::string(token) + "' in series " + d.name + " takes " + std::to_string(expected) + " parameters");
+        }
+        for (size_t i = 0; i < params.size(); ++i)
+        {
+            shape.params[i] = parse_number(params[i], d);
+        }
+        return shape;
+    }
+
+    // Parse the head of a line: name; interpolation; [modifier; ...]
+    // Returns the remaining part of the line holding the points.
+    static std::string_view parse_header(std::string_view line, SeriesData &d)
+    {
+        size_t pos = 0;
+        auto next_field = [&]() -> std::string_view
+        {
+            const size_t end = std::min(line.find(';', pos), line.size());
+            auto field = line.substr(pos, end - pos);
+            pos = end + 1;
+            return field;
+        };
+
+        d.name = std::string(trim_view(next_field()));
+        if (pos > line.size())
+        {
+            throw std::runtime_error("Missing interpolation method for series " + d.name);
+        }
+        d.interpolation = interpolation_from_string(std::string(trim_view(next_field())));
+
+        // Modifiers start with a letter, points with a number
+        std::string_view points;
+        while (pos <= line.size())
+        {
+            const size_t start = pos;
+            const auto field = trim_view(next_field());
+            if (field.empty() || !std::isalpha(static_cast<unsigned char>(field.front())))
+            {
+                points = line.substr(start);
+                break;
+            }
+            apply_modifier(d, field);
+        }
+
+        if (d.type != ValueType::Real)
+        {
+            // Discrete signals only change at their points
+            d.interpolation = Interpolation::Zoh;
+            if (d.float32)
+            {
+                throw std::runtime_error("Float32 only applies to Real series, not " + d.name);
+            }
+            if (d.integral)
+            {
+                throw std::runtime_error("Integral only applies to Real series, not " + d.name);
+            }
+            if (d.window > 0.0)
+            {
+                throw std::runtime_error("Window only applies to Real series, not " + d.name);
+            }
+            if (d.noise.enabled())
+            {
+                throw std::runtime_error("Noise only applies to Real series, not " + d.name);
+            }
+            if (!d.input.empty())
+            {
+                throw std::runtime_error("Input only applies to Real series, not " + d.name);
+            }
+        }
+        if (!d.input.empty() && (d.integral || d.window > 0.0 || d.noise.enabled()))
+        {
+            throw std::runtime_error("Integral, Window and Noise are over time and do not apply to series " + d.name + " indexed by an input");
+        }
+        if (!d.input2.empty() && d.float32)
+        {
+            throw std::runtime_error("Float32 does not apply to the map " + d.name);
+        }
+        return points;
+    }
+
+    // Parse the table of a map: x0,x1,...; y0,y1,...; then one row z(xi, y0),z(xi, y1),... per xi
+    static void parse_map(std::string_view points, SeriesData &d)
+    {
+        std::vector<std::vector<double>> rows;
+        size_t pos = 0;
+        while (pos < points.size())
+        {
+            const size_t end = std::min(points.find(';', pos), points.size());
+            const auto field = trim_view(points.substr(pos, end - pos));
+            pos = end + 1;
+            if (field.empty())
+            {
+                continue;
+            }
+            auto &row = rows.emplace_back();
+            for (const auto &token : split(std::string(field), ","))
+            {
+                row.push_back(parse_number(token, d));
+            }
+        }
+        if (rows.size() < 2 || rows.size() - 2 != rows[0].size())
+        {
+            throw std::runtime_error("Map " + d.name + " needs both axes and one row per point of the first axis");
+        }
+
+        std::vector<double> z;
+        z.reserve(rows[0].size() * rows[1].size());
+        for (size_t i = 2; i < rows.size(); ++i)
+        {
+            if (rows[i].size() != rows[1].size())
+            {
+                throw std::runtime_error("Row " + std::to_string(i - 2) + " of map " + d.name + " needs one value per point of the second axis");
+            }
+            z.insert(z.end(), rows[i].begin(), rows[i].end());
+        }
+        try
+        {
+            d.map = std::make_shared<const LookupMap>(std::move(rows[0]), std::move(rows[1]), std::move(z), map_method(d.interpolation));
+        }
+        catch (const std::runtime_error &e)
+        {
+            throw std::runtime_error(std::string(e.what()) + " in series " + d.name);
+        }
+    }
+
+    // Hermite shapes are parsed with their slopes and kept as the coefficients of their segment
+    static void prepare_shapes(SeriesData &d)
+    {
+        for (auto &shape : d.shapes)
+        {
+            if (shape.kind == ShapeKind::Hermite)
+            {
+                const size_t i = shape.segment;
+                hermite_coefficients(shape, d.times[i], d.values[i], d.times[i + 1], d.values[i + 1]);
+            }
+        }
+    }
+
+    // Parse the points part of a line: t0,v0; t1,v1; ...
+    static void parse_points(std::string_view points, SeriesData &d)
+    {
+        if (!d.input2.empty())
+        {
+            parse_map(points, d);
+            return;
+        }
+        if (d.type == ValueType::Real)
+        {
+            const size_t expected = std::count(points.begin(), points.end(), ';') + 1;
+            d.times.reserve(expected);
+            d.values.reserve(expected);
+        }
+
+        double last_time = 0.0;
+        int32_t last_value = 0;
+
+        size_t pos = 0;
+        while (pos < points.size())
+        {
+            const size_t end = std::min(points.find(';', pos), points.size());
+            const auto field = trim_view(points.substr(pos, end - pos));
+            pos = end + 1;
+            if (field.empty())
+            {
+                continue;
+            }
+
+            if (std::isalpha(static_cast<unsigned char>(field.front())))
+            {
+                // A shape for the segment starting at the last point
+                auto shape = parse_shape(field, d);
+                if (d.type != ValueType::Real || d.size == 0 || (!d.shapes.empty() && d.shapes.back().segment == d.size - 1))
+                {
+                    throw std::runtime_error("Segment shape '" + std::string(field) + "' in series " + d.name + " must follow a point of a Real series");
+                }
+                shape.segment = d.size - 1;
+                d.shapes.push_back(shape);
+                continue;
+            }
+
+            const size_t comma = field.find(',');
+            if (comma == std::string_view::npos)
+            {
+                throw std::runtime_error("Invalid point '" + std::string(field) + "' in series " + d.name);
+            }
+            const double x = parse_number(field.substr(0, comma), d);
+            if (d.type != ValueType::Real)
+            {
+                last_time = x;
+                last_value = parse_discrete(field.substr(comma + 1), d);
+                d.append_discrete(last_time, last_value);
+            }
+            else
+            {
+                d.times.push_back(x);
+                d.values.push_back(parse_number(field.substr(comma + 1), d));
+                d.size += 1;
+            }
+        }
+
+        if (!d.shapes.empty() && d.shapes.back().segment + 1 >= d.size)
+        {
+            throw std::runtime_error("Segment shape at the end of series " + d.name + " needs a point after it");
+        }
+        prepare_shapes(d);
+        if (d.window > 0.0 && std::any_of(d.shapes.begin(), d.shapes.end(), [](const SegmentShape &shape)
+                                           { return shape.kind == ShapeKind::Chirp; }))
+        {
+            // The extremes of a sweep have no closed form, min and max would miss them
+            throw std::runtime_error("Window does not apply to the chirp segments of series " + d.name);
+        }
+
+        if (d.float32)
+        {
+            const double error = float32_error(d);
+            if (std::isinf(error) || (d.float32_bound > 0.0 && !(error <= d.float32_bound)))
+            {
+                throw std::runtime_error("Series " + d.name + " changes by " + std::to_string(error) + " stored as Float32, more than its bound " + std::to_string(d.float32_bound));
+            }
+            narrow_values(d);
+        }
+
+        // The last point ends the period of a series that does not hold its value, keep it
+        if (d.type != ValueType::Real && d.extrapolation != Extrapolation::Hold && d.size > 0 && last_time > d.times.back())
+        {
+            d.push_discrete(last_time, last_value);
+        }
+    }
+
+    // Parse one line: name; interpolation; [modifier; ...] t0,v0; t1,v1; ...
+    static SeriesData parse_series(std::string_view line)
+    {
+        SeriesData d;
+        parse_points(parse_header(line, d), d);
+        return d;
+    }
+
+    // Parse the points of a series indexed by index_scenario
+    static void load_series(SeriesData &d)
+    {
+        if (d.loaded)
+        {
+            return;
+        }
+        try
+        {
+            parse_points(d.pending, d);
+        }
+        catch (...)
+        {
+            // Drop what was parsed so a retry starts over
+            d.times.clear();
+            d.values.clear();
+            d.values32.clear();
+            d.integers.clear();
+            d.booleans.clear();
+            d.shapes.clear();
+            d.map.reset();
+            d.size = 0;
+            throw;
+        }
+        d.pending = {};
+        d.loaded = true;
+    }
+
+    // Scenario in the record form instead of lines: [[t;v;d;l][t;v;d;l]...][[t;v;d;l]...]...
+    static bool is_record_form(std::string_view input)
+    {
+        const auto text = trim_view(input);
+        return !text.empty() && text.front() == '[';
+    }
+
+    // Parse the record form, one bracketed group of records per series, named var1, var2, ... Record
+    // [t;v;d;l] starts a segment of length l at time t with value v and slope d. The segment is a cubic
+    // Hermite ending in the value and slope of the next record, which holds its value until that record
+    // starts. The last record continues with its slope for its length, then holds.
+    static std::vector<SeriesData> parse_records(std::string_view input)
+    {
+        std::vector<SeriesData> out;
+        size_t pos = 0;
+        auto skip_space = [&]()
+        {
+            while (pos < input.size() && std::isspace(static_cast<unsigned char>(input[pos])))
+            {
+                ++pos;
+            }
+        };
+        auto expect = [&](char c, const std::string &where)
+        {
+            skip_space();
+            if (pos >= input.size() || input[pos] != c)
+            {
+                throw std::runtime_error(std::string("Expected '") + c + "' " + where);
+            }
+            ++pos;
+        };
+
+        for (skip_space(); pos < input.size(); skip_space())
+        {
+            auto &d = out.emplace_back();
+            d.name = "var" + std::to_string(out.size());
+            expect('[', "at the start of series " + d.name);
+
+            std::vector<std::array<double, 4>> records;
+            for (skip_space(); pos < input.size() && input[pos] == '['; skip_space())
+            {
+                const size_t end = input.find(']', pos);
+                if (end == std::string_view::npos)
+                {
+                    throw std::runtime_error("Unterminated record in series " + d.name);
+                }
+                const auto fields = split(std::string(input.substr(pos + 1, end - pos - 1)), ";");
+                if (fields.size() != 4)
+                {
+                    throw std::runtime_error("Record [" + std::string(input.substr(pos + 1, end - pos - 1)) + "] of series " + d.name + " needs time, value, derivative and length");
+                }
+                auto &r = records.emplace_back();
+                for (size_t k = 0; k < 4; ++k)
+                {
+                    r[k] = parse_number(fields[k], d);
+                    if (!std::isfinite(r[k]))
+                    {
+                        throw std::runtime_error("Record values of series " + d.name + " must be finite");
+                    }
+                }
+                if (r[3] < 0.0 || (records.size() > 1 && r[0] < records[records.size() - 2][0]))
+                {
+                    throw std::runtime_error("Records of series " + d.name + " need a length of at least 0 and increasing times");
+                }
+                pos = end + 1;
+            }
+            expect(']', "at the end of series " + d.name);
+
+            auto push_point = [&d](double time, double value)
+            {
+                if (d.size == 0 || d.times.back() != time || d.values.back() != value)
+                {
+                    d.times.push_back(time);
+                    d.values.push_back(value);
+                    d.size += 1;
+                }
+            };
+            for (size_t k = 0; k < records.size(); ++k)
+            {
+                const auto &[t, v, slope, length] = records[k];
+                const bool last = k + 1 == records.size();
+                push_point(t, v);
+                if (last && length == 0.0)
+                {
+                    break;
+                }
+
+                // The next record may start a rounding error before or after the end of this one
+                const double tolerance = 1e-9 * std::max(length, std::abs(t));
+                const double next = last ? t + length : records[k + 1][0];
+                if (next < t + length - tolerance)
+                {
+                    throw std::runtime_error("Record at " + std::to_string(t) + " of series " + d.name + " overlaps the next one");
+                }
+                const double end = last || next > t + length + tolerance ? t + length : next;
+                const double end_value = last ? v + slope * length : records[k + 1][1];
+                if (end > t)
+                {
+                    SegmentShape shape;
+                    shape.kind = ShapeKind::Hermite;
+                    shape.segment = d.size - 1;
+                    shape.params = {slope, last ? slope : records[k + 1][2], 0.0};
+                    d.shapes.push_back(shape);
+                    d.times.push_back(end);
+                    d.values.push_back(end_value);
+                    d.size += 1;
+                }
+                else
+                {
+                    // No length, the value jumps to the next record
+                    push_point(end, end_value);
+                }
+            }
+            prepare_shapes(d);
+        }
+        return out;
+    }
+
+    // Split the input into its non blank lines, one per series
+    static std::vector<std::string_view> split_lines(std::string_view input)
+    {
+        std::vector<std::string_view> lines;
+        size_t pos = 0;
+        while (pos <= input.size())
+        {
+            const size_t end = std::min(input.find('\n', pos), input.size());
+            const auto line = input.substr(pos, end - pos);
+            if (!trim_view(line).empty())
+            {
+                lines.push_back(line);
+            }
+            pos = end + 1;
+        }
+        return lines;
+    }
+
+    // Parse scenario input. Series are parsed concurrently on up to `threads` threads
+    // (0 = one per hardware thread) and stored in input order.
+    static std::vector<SeriesData> parse_scenario(std::string_view input, unsigned threads = 1)
+    {
+        if (trim_view(input).empty())
+        {
+            throw std::runtime_error("No scenario found, make sure to set parameters before ExitInitializationMode");
+        }
+        if (is_record_form(input))
+        {
+            return parse_records(input);
+        }
+
+        const auto lines = split_lines(input);
+        std::vector<SeriesData> out(lines.size());
+
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        if (input.size() < parallel_parse_min_bytes)
+        {
+            threads = 1;
+        }
+        threads = static_cast<unsigned>(std::min<size_t>(threads, lines.size()));
+
+        std::atomic<size_t> next{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        auto work = [&]()
+        {
+            for (size_t i = next++; i < lines.size(); i = next++)
+            {
+                try
+                {
+                    out[i] = parse_series(lines[i]);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < threads; ++i)
+        {
+            try
+            {
+                workers.emplace_back(work);
+            }
+            catch (const std::system_error &)
+            {
+                // Could not start more threads, the ones running take the remaining work
+                break;
+            }
+        }
+        work();
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+        return out;
+    }
+
+    // Index the scenario without parsing any points. Each series keeps a view of its points
+    // in `input`, which must outlive it, and is parsed by load_series on first use.
+    static std::vector<SeriesData> index_scenario(std::string_view input)
+    {
+        if (trim_view(input).empty())
+        {
+            throw std::runtime_error("No scenario found, make sure to set parameters before ExitInitializationMode");
+        }
+        if (is_record_form(input))
+        {
+            // Records are parsed at once, there is no header to index
+            return parse_records(input);
+        }
+
+        const auto lines = split_lines(input);
+        std::vector<SeriesData> out(lines.size());
+        for (size_t i = 0; i < lines.size(); ++i)
+        {
+            out[i].pending = parse_header(lines[i], out[i]);
+            out[i].loaded = false;
+        }
+        return out;
+    }
+}
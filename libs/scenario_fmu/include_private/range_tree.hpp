@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // Minimum and maximum of any range of a fixed array in O(log n), a bottom up segment tree.
+    // Leaves are at [n, 2n), node k covers its children 2k and 2k + 1. Holds 4n doubles, a sparse
+    // table answers in O(1) but needs n log n of them.
+    class RangeTree
+    {
+    public:
+        // Tree over `n` values, `value(i)` gives value i
+        template <class Value>
+        void build(size_t n, Value &&value)
+        {
+            build(n, value, value);
+        }
+
+        // Tree over `n` intervals, `low_of(i)` and `high_of(i)` give the bounds of interval i
+        template <class Low, class High>
+        void build(size_t n, Low &&low_of, High &&high_of)
+        {
+            count = n;
+            low.assign(2 * n, 0.0);
+            high.assign(2 * n, 0.0);
+            for (size_t i = 0; i < n; ++i)
+            {
+                low[n + i] = low_of(i);
+                high[n + i] = high_of(i);
+            }
+            for (size_t k = n; k-- > 1;)
+            {
+                low[k] = std::min(low[2 * k], low[2 * k + 1]);
+                high[k] = std::max(high[2 * k], high[2 * k + 1]);
+            }
+        }
+
+        size_t size() const { return count; }
+
+        // Minimum and maximum of the values [first, last), +inf and -inf for an empty range
+        std::pair<double, double> query(size_t first, size_t last) const
+        {
+            double lo = std::numeric_limits<double>::infinity();
+            double hi = -std::numeric_limits<double>::infinity();
+            for (first += count, last += count; first < last; first /= 2, last /= 2)
+            {
+                if (first & 1)
+                {
+                    lo = std::min(lo, low[first]);
+                    hi = std::max(hi, high[first++]);
+                }
+                if (last & 1)
+                {
+                    lo = std::min(lo, low[--last]);
+                    hi = std::max(hi, high[last]);
+                }
+            }
+            return {lo, hi};
+        }
+
+        size_t footprint() const
+        {
+            return (low.capacity() + high.capacity()) * sizeof(double);
+        }
+
+    private:
+        size_t count = 0;
+        std::vector<double> low;
+        std::vector<double> high;
+    };
+}
@@ -0,0 +1,842 @@
+#pragma once
+
+#include "series.hpp"
+#include "parser.hpp"
+#include "simplify.hpp"
+#include "shared_store.hpp"
+#include "calendar.hpp"
+#include "transform.hpp"
+#include "library.hpp"
+#include "compiled.hpp"
+#include "integral.hpp"
+#include "window.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // Value references for parameters
+    inline constexpr unsigned int vrScenarioInput = 0;
+
+    // - Outputs start at this value reference and continue sequentially.
+    // time is the first ouput
+    inline constexpr unsigned int vrFirstOutput = 1;
+
+    // Configuration parameters use a reserved range far above the outputs
+    inline constexpr unsigned int vrFirstOption = 0x40000000;
+
+    // Boolean options
+    inline constexpr unsigned int vrCompressSeries = vrFirstOption + 0;
+    inline constexpr unsigned int vrSimplifySeries = vrFirstOption + 1;
+    inline constexpr unsigned int vrLazyParse = vrFirstOption + 3;
+    inline constexpr unsigned int vrSharedMemory = vrFirstOption + 4;
+    inline constexpr unsigned int vrFloat32Values = vrFirstOption + 5;
+    inline constexpr unsigned int vrEventCalendar = vrFirstOption + 7;
+    inline constexpr unsigned int vrRealtime = vrFirstOption + 14;
+
+    // Integer options
+    inline constexpr unsigned int vrParseThreads = vrFirstOption + 2;
+    inline constexpr unsigned int vrScenarioIndex = vrFirstOption + 12;
+
+    // Real options
+    inline constexpr unsigned int vrFloat32Bound = vrFirstOption + 6;
+    inline constexpr unsigned int vrTimeResolution = vrFirstOption + 13;
+
+    // Transform of all series: gain, offset, time_shift and time_scale
+    inline constexpr unsigned int vrFirstTransform = vrFirstOption + 8;
+
+    // Transform of one series, four value references per output in output order
+    inline constexpr unsigned int vrFirstSeriesTransform = 0x30000000;
+
+    // Integral of a series with the Integral modifier, one value reference per output in output order
+    inline constexpr unsigned int vrFirstIntegral = 0x10000000;
+
+    // Moving minimum, maximum and mean of a series with the Window modifier, three value references
+    // per output in output order
+    inline constexpr unsigned int vrFirstWindow = 0x11000000;
+
+    // Real inputs series with the Input modifier are indexed by, in order of first use
+    inline constexpr unsigned int vrFirstInput = 0x12000000;
+    inline constexpr unsigned int maxInputs = 0x1000000;
+
+    // Default of the realtime option, set by the real-time build profile
+#ifdef SCENARIO_REALTIME
+    inline constexpr bool realtime_default = true;
+#else
+    inline constexpr bool realtime_default = false;
+#endif
+
+    // Outputs computed from a series besides its value
+    enum class DerivedOutput
+    {
+        Integral,
+        WindowMin,
+        WindowMax,
+        WindowMean
+    };
+
+    // Settings the parsed series depend on, besides the scenario input
+    struct ParseSettings
+    {
+        bool compress = false;
+        bool simplify = false;
+        double tolerance = 0.0;
+        bool lazy = false;
+        bool shared = false;
+        bool float32 = false;
+        double float32_bound = 0.0;
+        int scenario_index = -1;
+        double time_resolution = 0.0;
+        bool realtime = false;
+
+        bool operator==(const ParseSettings &) const = default;
+    };
+
+    // Parameters and parsed series of one instance, independent of the FMI version.
+    // Functions that report progress take a `log(bool error, const std::string &message)` callable.
+    class ScenarioState
+    {
+    public:
+        // Parameters
+        std::shared_ptr<const std::string> scenario_input = std::make_shared<const std::string>(); // raw string, shared with `source`
+        bool compress_series = false;    // store points block compressed
+        bool simplify_series = false;    // drop points within the experiment tolerance
+        unsigned int parse_threads = 0;  // 0: one per hardware thread, 1: single threaded
+        bool lazy_parse = false;         // parse the points of a series on first access
+        bool shared_memory = false;      // share the parsed series with other processes
+        bool float32_values = false;     // store the values of Real series as float32
+        double float32_bound = 0.0;      // largest rounding error float32_values allows, 0 for no bound
+        bool event_calendar = false;     // advance the series from one merged calendar of their points
+        Transform transform;             // applied to every series
+        std::map<unsigned int, Transform> series_transforms; // by output index, applied inside `transform`
+        int scenario_index = -1;         // scenario of the packaged library, -1 for scenario_input
+        double time_resolution = 0.0;    // grid of the integer time base in seconds, 0 for none
+        bool realtime = realtime_default; // bounded lookups and no allocation once initialized
+
+        // Resources directory of the FMU, holding the scenario library if one was packaged
+        std::string resources;
+        std::shared_ptr<const ScenarioLibrary> library;
+
+        // Scenario compiled into the library, used for the input it was compiled from
+        const CompiledScenario *compiled = linked_scenario();
+
+        // Experiment tolerance, 0 when not defined
+        double tolerance = 0.0;
+
+        // Text the lazily parsed series point into, the scenario_input they were indexed from. A new
+        // input replaces scenario_input, this one stays alive until the series are parsed again.
+        std::shared_ptr<const std::string> source;
+
+        // What the current series were parsed with, a reset keeps them while these are unchanged
+        bool input_changed = true;
+        ParseSettings parsed_settings;
+
+        // Parsed
+        std::vector<SeriesData> series;
+        unsigned int outputs_count = 0;
+        EventCalendar calendar;
+
+        // Inputs of the Input modifiers and their values. Values set before the series are parsed wait
+        // in `pending_inputs` by value reference, bind_inputs applies them.
+        std::vector<std::string> input_names;
+        std::vector<double> inputs;
+        std::map<unsigned int, double> pending_inputs;
+
+        // Transform each series is evaluated with
+        std::vector<Transform> transforms;
+
+        // Time state
+        double current_time = 0.0;
+        double time_grid = 0.0; // time_resolution the points were quantized with
+
+        ParseSettings parse_settings() const
+        {
+            const bool simplify = simplify_series && tolerance > 0.0;
+            return {compress_series, simplify, simplify ? tolerance : 0.0, lazy_parse, shared_memory, float32_values, float32_bound, scenario_index, time_resolution, realtime};
+        }
+
+        void set_input(const char *value)
+        {
+            if (*scenario_input != value)
+            {
+                scenario_input = std::make_shared<const std::string>(value);
+                input_changed = true;
+            }
+        }
+
+        // Returns false if `vr` is not a Boolean option
+        bool set_boolean_option(unsigned int vr, bool value)
+        {
+            if (vr == vrCompressSeries)
+                compress_series = value;
+            else if (vr == vrSimplifySeries)
+                simplify_series = value;
+            else if (vr == vrLazyParse)
+                lazy_parse = value;
+            else if (vr == vrSharedMemory)
+                shared_memory = value;
+            else if (vr == vrFloat32Values)
+                float32_values = value;
+            else if (vr == vrEventCalendar)
+                event_calendar = value;
+            else if (vr == vrRealtime)
+                realtime = value;
+            else
+                return false;
+            return true;
+        }
+
+        // Returns false if `vr` is not an Integer option or the value is out of range
+        bool set_integer_option(unsigned int vr, int value)
+        {
+            if (vr == vrParseThreads && value >= 0)
+            {
+                parse_threads = static_cast<unsigned int>(value);
+                return true;
+            }
+            if (vr == vrScenarioIndex && value >= -1)
+            {
+                scenario_index = value;
+                return true;
+            }
+            return false;
+        }
+
+        // Returns false if `vr` is not a Real option or the value is out of range
+        bool set_real_option(unsigned int vr, double value)
+        {
+            if (vr == vrFloat32Bound && value >= 0.0)
+            {
+                float32_bound = value;
+                return true;
+            }
+            if (vr == vrTimeResolution && value >= 0.0 && std::isfinite(value))
+            {
+                time_resolution = value;
+                return true;
+            }
+            if (vr >= vrFirstTransform && vr < vrFirstTransform + 4)
+            {
+                return set_transform(transform, vr - vrFirstTransform, value);
+            }
+            if (vr >= vrFirstSeriesTransform && vr < vrFirstOption)
+            {
+                const unsigned int index = (vr - vrFirstSeriesTransform) / 4;
+                if (!series.empty() && index >= outputs_count)
+                {
+                    return false;
+                }
+                return set_transform(series_transforms[index], (vr - vrFirstSeriesTransform) % 4, value);
+            }
+            return false;
+        }
+
+        bool set_transform(Transform &target, unsigned int field, double value)
+        {
+            if (!std::isfinite(value) || (field == 3 && !(value > 0.0)))
+            {
+                return false;
+            }
+            *transform_field(target, field) = value;
+            update_transforms();
+            return true;
+        }
+
+        // Combine the global and per series transforms for the parsed series
+        void update_transforms()
+        {
+            transforms.assign(series.size(), transform);
+            for (const auto &[index, t] : series_transforms)
+            {
+                if (index < transforms.size())
+                {
+                    transforms[index] = t.within(transform);
+                }
+            }
+        }
+
+        const Transform &transform_of(const SeriesData &s) const
+        {
+            return transforms[&s - series.data()];
+        }
+
+        // Output values at the current time, with the noise and the transform of the series
+        double real_value(SeriesData &s) const
+        {
+            const auto &t = transform_of(s);
+            if (s.map)
+            {
+                return t.value(map_at(s).value);
+            }
+            if (s.input_index >= 0)
+            {
+                // Indexed by the input, the time transform does not apply
+                return t.value(eval_value_at(s, inputs[s.input_index]));
+            }
+            const double local = t.local_time(current_time);
+            const double value = eval_value_at(s, local);
+            return t.value(has_noise(s, local) ? value + noise_at(s.noise, local) : value);
+        }
+
+        // Derivative over time, 0 for series indexed by an input whose derivative is not known
+        double real_derivative(SeriesData &s) const
+        {
+            const auto &t = transform_of(s);
+            if (s.input_index >= 0)
+            {
+                return 0.0;
+            }
+            const double local = t.local_time(current_time);
+            const double derivative = eval_output_derivative_at(s, local);
+            return t.derivative(has_noise(s, local) ? derivative + noise_derivative_at(s.noise, local) : derivative);
+        }
+
+        // Map of `s` at the current values of its inputs
+        MapValue map_at(SeriesData &s) const
+        {
+            return eval_map_at(s, inputs[s.input_index], inputs[s.input2_index]);
+        }
+
+        // Partial derivative of the output of `s` over the input `vr`, 0 for series over time and
+        // inputs the series does not depend on
+        double input_partial(SeriesData &s, unsigned int vr) const
+        {
+            const int input = vr >= vrFirstInput && vr - vrFirstInput < inputs.size() ? static_cast<int>(vr - vrFirstInput) : -1;
+            if (input < 0 || s.type != ValueType::Real)
+            {
+                return 0.0;
+            }
+            const double gain = transform_of(s).gain;
+            if (s.map)
+            {
+                const auto m = map_at(s);
+                // Both axes may be the same input
+                return gain * ((s.input_index == input ? m.dx : 0.0) + (s.input2_index == input ? m.dy : 0.0));
+            }
+            if (s.input_index == input && s.size >= 2)
+            {
+                return gain * eval_output_derivative_at(s, inputs[input]);
+            }
+            return 0.0;
+        }
+
+        // Sum of the partial derivatives of the output of `s` over the inputs `known` times their `seed`
+        double directional_derivative(SeriesData &s, const unsigned int known[], size_t n, const double seed[]) const
+        {
+            double sum = 0.0;
+            for (size_t j = 0; j < n; ++j)
+            {
+                sum += input_partial(s, known[j]) * seed[j];
+            }
+            return sum;
+        }
+
+        // Noise starts at the first point, as the series
+        static bool has_noise(const SeriesData &s, double local)
+        {
+            return s.noise.enabled() && s.size > 0 && local >= s.first_time();
+        }
+
+        int32_t discrete_value(SeriesData &s) const
+        {
+            return eval_discrete_at(s, transform_of(s).local_time(current_time));
+        }
+
+        // Values of a series at `n` simulation times, see eval_batch
+        // For series indexed by an input the times are values of the input, for maps values of the
+        // first input while the second one keeps its current value.
+        void batch_values(SeriesData &s, const double *times, size_t n, double *out) const
+        {
+            const auto &t = transform_of(s);
+            if (s.map)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    out[i] = t.value(eval_map_at(s, times[i], inputs[s.input2_index]).value);
+                }
+                return;
+            }
+            if (s.input_index >= 0)
+            {
+                eval_batch(s, times, n, out);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    out[i] = t.value(out[i]);
+                }
+                return;
+            }
+            const bool noise = s.type == ValueType::Real && s.noise.enabled() && s.size > 0;
+            if (t.identity())
+            {
+                eval_batch(s, times, n, out);
+                if (noise)
+                {
+                    add_noise(s.noise, s.first_time(), times, n, out);
+                }
+                return;
+            }
+            std::vector<double> local(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                local[i] = t.local_time(times[i]);
+            }
+            eval_batch(s, local.data(), n, out);
+            if (noise)
+            {
+                add_noise(s.noise, s.first_time(), local.data(), n, out);
+            }
+            if (s.type == ValueType::Real)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    out[i] = t.value(out[i]);
+                }
+            }
+        }
+
+        // Series not parsed yet from the current input, their inputs are not known
+        bool inputs_pending() const
+        {
+            return series.empty() || input_changed;
+        }
+
+        // Returns false if `vr` is not an input of the parsed series. Before parsing any input value
+        // reference is kept, initialize rejects those the scenario does not declare.
+        bool set_real_input(unsigned int vr, double value)
+        {
+            if (vr < vrFirstInput || vr - vrFirstInput >= maxInputs || !std::isfinite(value))
+            {
+                return false;
+            }
+            if (inputs_pending())
+            {
+                pending_inputs[vr] = value;
+                return true;
+            }
+            if (vr - vrFirstInput >= inputs.size())
+            {
+                return false;
+            }
+            inputs[vr - vrFirstInput] = value;
+            return true;
+        }
+
+        // Value of the input `vr`, false if it is none
+        bool real_input(unsigned int vr, double &value) const
+        {
+            if (inputs_pending())
+            {
+                const auto it = pending_inputs.find(vr);
+                if (it != pending_inputs.end())
+                {
+                    value = it->second;
+                    return true;
+                }
+            }
+            if (vr < vrFirstInput || vr - vrFirstInput >= inputs.size())
+            {
+                return false;
+            }
+            value = inputs[vr - vrFirstInput];
+            return true;
+        }
+
+        // Number the inputs of the series in order of first use and apply the values set before.
+        // Throws for a value set on an input the scenario does not declare.
+        void bind_inputs()
+        {
+            input_names.clear();
+            for (auto &s : series)
+            {
+                s.input_index = bind_input(s.input);
+                s.input2_index = bind_input(s.input2);
+            }
+            inputs.resize(input_names.size(), 0.0);
+
+            std::map<unsigned int, double> pending;
+            pending.swap(pending_inputs);
+            for (const auto &[vr, value] : pending)
+            {
+                if (vr - vrFirstInput >= inputs.size())
+                {
+                    throw std::runtime_error("Input " + std::to_string(vr - vrFirstInput) + " was set, the scenario declares " +
+                                             std::to_string(inputs.size()) + " inputs");
+                }
+                inputs[vr - vrFirstInput] = value;
+            }
+        }
+
+        // Index of the input `name`, added if it is new, -1 for none
+        int bind_input(const std::string &name)
+        {
+            if (name.empty())
+            {
+                return -1;
+            }
+            const auto it = std::find(input_names.begin(), input_names.end(), name);
+            const int index = static_cast<int>(it - input_names.begin());
+            if (it == input_names.end())
+            {
+                input_names.push_back(name);
+            }
+            return index;
+        }
+
+        // Output index and kind of the derived output `vr`, index -1 if it is none
+        std::pair<int, DerivedOutput> derived_output(unsigned int vr) const
+        {
+            if (vr >= vrFirstIntegral && vr - vrFirstIntegral < outputs_count && series[vr - vrFirstIntegral].integral)
+            {
+                return {static_cast<int>(vr - vrFirstIntegral), DerivedOutput::Integral};
+            }
+            if (vr >= vrFirstWindow && (vr - vrFirstWindow) / 3 < outputs_count && series[(vr - vrFirstWindow) / 3].window > 0.0)
+            {
+                const unsigned int stat = (vr - vrFirstWindow) % 3;
+                return {static_cast<int>((vr - vrFirstWindow) / 3), static_cast<DerivedOutput>(static_cast<unsigned int>(DerivedOutput::WindowMin) + stat)};
+            }
+            return {-1, DerivedOutput::Integral};
+        }
+
+        double derived_value(SeriesData &s, DerivedOutput kind) const
+        {
+            switch (kind)
+            {
+            case DerivedOutput::WindowMin:
+                return window_value(s, WindowStat::Min);
+            case DerivedOutput::WindowMax:
+                return window_value(s, WindowStat::Max);
+            case DerivedOutput::WindowMean:
+                return window_value(s, WindowStat::Mean);
+            case DerivedOutput::Integral:
+            default:
+                return integral_value(s);
+            }
+        }
+
+        // Statistic of the transformed output over the window, the window length is in the time of the series
+        double window_value(SeriesData &s, WindowStat stat) const
+        {
+            const auto &t = transform_of(s);
+            if (t.gain < 0.0 && stat != WindowStat::Mean)
+            {
+                // A negative gain turns the minimum into the maximum
+                stat = stat == WindowStat::Min ? WindowStat::Max : WindowStat::Min;
+            }
+            return t.value(eval_window_at(s, stat, t.local_time(current_time)));
+        }
+
+        // Integral of the transformed output from the first point of the series to the current time
+        double integral_value(SeriesData &s) const
+        {
+            const auto &t = transform_of(s);
+            const double local = t.local_time(current_time);
+            if (s.size == 0 || local < s.first_time())
+            {
+                return 0.0;
+            }
+            return t.integral(eval_integral_at(s, local), local - s.first_time());
+        }
+
+        // First point of a series after simulation time `time`, in simulation time
+        double next_point(SeriesData &s, double time) const
+        {
+            const auto &t = transform_of(s);
+            return t.simulation_time(next_point_after(s, t.local_time(time)));
+        }
+
+        // Simplify, narrow to float32 and compress a parsed series as configured,
+        // returns the number of removed points
+        template <class Log>
+        size_t prepare_series(SeriesData &s, Log &&log) const
+        {
+            size_t removed = 0;
+            if (simplify_series && tolerance > 0.0)
+            {
+                removed = ::simplify_series(s, tolerance);
+            }
+            quantize_series(s, time_resolution);
+            if (compress_series && !realtime)
+            {
+                // Blocks hold their own encoding, float32 storage would not make them smaller
+                build_integral(s);
+                build_window(s);
+                ::compress_series(s);
+            }
+            else if (float32_values && s.type == ValueType::Real && s.values32.empty())
+            {
+                const double error = float32_error(s);
+                if (std::isinf(error) || (float32_bound > 0.0 && !(error <= float32_bound)))
+                {
+                    log(false, "Keeping " + s.name + " in double, float32 would change it by " + std::to_string(error));
+                }
+                else
+                {
+                    narrow_values(s);
+                }
+            }
+            return removed;
+        }
+
+        // Parse the scenario input, or keep the series parsed from the same input and settings.
+        // Throws if the input can not be parsed.
+        template <class Log>
+        void initialize(Log &&log)
+        {
+            const auto settings = parse_settings();
+            if (!input_changed && settings == parsed_settings && !series.empty())
+            {
+                log(false, "Scenario unchanged, reusing the parsed series");
+                rewind();
+                build_calendar();
+                return;
+            }
+
+            time_grid = time_resolution;
+            if (scenario_index >= 0)
+            {
+                select_scenario(log);
+                time_grid = 0.0;
+            }
+            else if (compiled && compiled_from(*compiled, *scenario_input))
+            {
+                series = compiled_series(*compiled);
+                time_grid = 0.0;
+                log(false, "Using the scenario compiled into the library");
+            }
+            else if (shared_memory)
+            {
+                share_scenario(settings, log);
+            }
+            else if (lazy_parse && !realtime)
+            {
+                // Points are parsed, simplified and compressed on first access
+                source = scenario_input;
+                series = index_scenario(*source);
+            }
+            else
+            {
+                series = parse_scenario(*scenario_input, parse_threads);
+
+                size_t total = 0;
+                size_t removed = 0;
+                for (auto &s : series)
+                {
+                    total += s.size;
+                    removed += prepare_series(s, log);
+                }
+                if (settings.simplify)
+                {
+                    log(false, "Simplified scenario within tolerance " + std::to_string(tolerance) + ", removed " + std::to_string(removed) + " of " + std::to_string(total) + " points");
+                }
+            }
+            for (auto &s : series)
+            {
+                build_integral(s);
+                build_window(s);
+            }
+            if (realtime)
+            {
+                build_grids(log);
+            }
+            bind_inputs();
+            outputs_count = static_cast<unsigned int>(series.size());
+            input_changed = false;
+            parsed_settings = settings;
+            build_calendar();
+        }
+
+        // Bucket grids of the real-time profile, every lookup then takes a bounded number of steps.
+        // The series are all loaded and plain, nothing is parsed, decoded or allocated while stepping.
+        // Logs the worst case, with the outputs outside the bucket bound: integrals of chirp segments
+        // add one quadrature panel and Window outputs search their range tree.
+        template <class Log>
+        void build_grids(Log &&log)
+        {
+            size_t scan = 0;
+            size_t chirps = 0;
+            size_t window_points = 0;
+            for (auto &s : series)
+            {
+                if (s.loaded && !s.compressed)
+                {
+                    s.grid.build(s.times_data(), s.size);
+                    scan = std::max(scan, s.grid.worst_scan());
+                    if (s.grid.bisected_buckets() > 0)
+                    {
+                        log(false, "Real-time profile, the points of " + s.name + " are too clustered for a uniform grid, " +
+                                       std::to_string(s.grid.bisected_buckets()) + " buckets are searched by bisection");
+                    }
+                }
+                chirps += s.chirp_integrals.size();
+                if (s.window > 0.0)
+                {
+                    window_points = std::max(window_points, s.size);
+                }
+            }
+            std::string worst = "Real-time profile, a lookup compares at most " + std::to_string(scan) + " points";
+            if (chirps > 0)
+            {
+                worst += ", the integral of a chirp segment adds one panel of 5 sine evaluations";
+            }
+            if (window_points > 0)
+            {
+                worst += ", a Window output searches a range tree of up to " + std::to_string(window_points) + " points in O(log n)";
+            }
+            log(false, worst);
+        }
+
+        void build_calendar()
+        {
+            update_transforms();
+            if (event_calendar && !realtime)
+            {
+                // The calendar runs on the time of the global transform
+                calendar.build(series, [this](size_t index)
+                               { return series[index].input.empty() &&
+                                        transforms[index].time_shift == transform.time_shift &&
+                                        transforms[index].time_scale == transform.time_scale; });
+            }
+            else
+            {
+                calendar.clear();
+            }
+        }
+
+        // Move to `time`, the calendar advances the series changing on the way.
+        // With a time resolution the time is quantized once here, as the points were.
+        void set_time(double time)
+        {
+            current_time = quantize_time(time, time_grid);
+            calendar.advance(series, transform.local_time(current_time));
+        }
+
+        // Series of the library scenario at scenario_index, evaluated in place in the library
+        // shared by all instances of the process. Parse options do not apply.
+        template <class Log>
+        void select_scenario(Log &&log)
+        {
+            if (!library)
+            {
+                library = load_library(resources + "/" + library_file);
+                log(false, "Loaded scenario library with " + std::to_string(library->size()) + " scenarios");
+            }
+            if (static_cast<size_t>(scenario_index) >= library->size())
+            {
+                throw std::runtime_error("scenario_index " + std::to_string(scenario_index) + " out of range, the library has " + std::to_string(library->size()) + " scenarios");
+            }
+            series = library->scenario(static_cast<size_t>(scenario_index));
+        }
+
+        // Map the series another instance published for the same input and settings, or parse and
+        // publish them. The shared points are plain doubles and read only, lazy_parse, compress_series
+        // and float32_values do not apply. The points are quantized, but searched as doubles.
+        template <class Log>
+        void share_scenario(const ParseSettings &settings, Log &&log)
+        {
+            const double variant_values[2] = {settings.tolerance, settings.time_resolution};
+            const std::string_view variant(reinterpret_cast<const char *>(variant_values), sizeof(variant_values));
+            const auto key = shared_key(*scenario_input, variant);
+            if (auto segment = attach_shared(key))
+            {
+                series = map_shared_scenario(segment);
+                log(false, "Mapped shared scenario " + segment->name);
+                return;
+            }
+
+            auto parsed = parse_scenario(*scenario_input, parse_threads);
+            for (auto &s : parsed)
+            {
+                if (settings.simplify)
+                {
+                    ::simplify_series(s, tolerance);
+                }
+                quantize_series(s, time_resolution);
+            }
+
+            // Published by this instance, or by another process in the meantime
+            auto segment = publish_shared(key, serialize_scenario(parsed));
+            if (segment || (segment = attach_shared(key)))
+            {
+                series = map_shared_scenario(segment);
+                log(false, (segment->owner ? "Published shared scenario " : "Mapped shared scenario ") + segment->name);
+                return;
+            }
+
+            // Still being written by another process, or no shared memory on this platform
+            log(false, "Shared scenario not available, using a private copy");
+            series = std::move(parsed);
+        }
+
+        // Series of an output, parsing its points first if it was indexed lazily.
+        // Returns nullptr, after logging the error, if the points can not be parsed.
+        template <class Log>
+        SeriesData *loaded_series(unsigned int index, Log &&log)
+        {
+            auto &s = series[index];
+            if (s.loaded)
+            {
+                return &s;
+            }
+
+            try
+            {
+                load_series(s);
+            }
+            catch (const std::exception &e)
+            {
+                log(true, e.what());
+                return nullptr;
+            }
+
+            const size_t total = s.size;
+            const size_t removed = prepare_series(s, log);
+            build_integral(s);
+            build_window(s);
+            if (removed > 0)
+            {
+                log(false, "Simplified " + s.name + ", removed " + std::to_string(removed) + " of " + std::to_string(total) + " points");
+            }
+            return &s;
+        }
+
+        // Options, transforms and input values back to their defaults, as after instantiation.
+        // The scenario input and the series parsed from it are kept, initialize reuses them
+        // when the options are set to the values they were parsed with again.
+        void reset_parameters()
+        {
+            compress_series = false;
+            simplify_series = false;
+            parse_threads = 0;
+            lazy_parse = false;
+            shared_memory = false;
+            float32_values = false;
+            float32_bound = 0.0;
+            event_calendar = false;
+            transform = Transform{};
+            series_transforms.clear();
+            scenario_index = -1;
+            time_resolution = 0.0;
+            realtime = realtime_default;
+            std::fill(inputs.begin(), inputs.end(), 0.0);
+            pending_inputs.clear();
+            update_transforms();
+        }
+
+        // Evaluation cursors back to the start, the parsed series are kept
+        void rewind()
+        {
+            for (auto &s : series)
+            {
+                s.rewind();
+            }
+            calendar.rewind();
+        }
+    };
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    // Uniform grid over the points of a series, for the real-time profile. Bucket b covers
+    // [start + b / scale, start + (b + 1) / scale) and holds the segment its start falls in.
+    // A lookup goes straight to the bucket of the time and scans the points of that bucket from
+    // there, whatever time was looked up before. The buckets are as wide as the shortest segment,
+    // up to `buckets_per_point` buckets per point; points clustered closer than that are searched
+    // by bisection within their bucket, so the cost of a lookup stays logarithmic in the points of
+    // one bucket and is not linear in the number of points of the series.
+    class SegmentGrid
+    {
+    public:
+        // Bounds the memory of the grid to 4 * buckets_per_point bytes per point
+        static constexpr size_t buckets_per_point = 4;
+
+        // Buckets with more points than this are bisected instead of scanned
+        static constexpr size_t max_linear_scan = 16;
+
+        // Empty for series with fewer than three points or without a time span
+        void build(const double *times, size_t size)
+        {
+            first.clear();
+            scan = 0;
+            bisected = 0;
+            if (size < 3 || size > std::numeric_limits<uint32_t>::max() || !(times[size - 1] > times[0]))
+            {
+                return;
+            }
+            const double span = times[size - 1] - times[0];
+            double shortest = span;
+            for (size_t i = 0; i + 1 < size; ++i)
+            {
+                const double length = times[i + 1] - times[i];
+                if (length > 0.0)
+                {
+                    shortest = std::min(shortest, length);
+                }
+            }
+            const double wanted = std::ceil(span / shortest);
+            const size_t buckets = wanted < static_cast<double>(size * buckets_per_point)
+                                       ? std::max(size, static_cast<size_t>(wanted))
+                                       : size * buckets_per_point;
+
+            start = times[0];
+            scale = static_cast<double>(buckets) / span;
+            first.resize(buckets);
+            size_t segment = 0;
+            for (size_t b = 0; b < first.size(); ++b)
+            {
+                segment = advance(times, size, segment, start + static_cast<double>(b) / scale);
+                first[b] = static_cast<uint32_t>(segment);
+            }
+            for (size_t b = 0; b < first.size(); ++b)
+            {
+                const size_t points = last_of(b, size) - first[b] + 1;
+                if (points > max_linear_scan)
+                {
+                    ++bisected;
+                }
+                scan = std::max(scan, steps(points));
+            }
+        }
+
+        bool empty() const { return first.empty(); }
+
+        // Most points a lookup compares, in the worst bucket
+        size_t worst_scan() const { return scan; }
+
+        // Buckets too dense to be scanned, searched by bisection
+        size_t bisected_buckets() const { return bisected; }
+
+        // Same segment as find_segment_in, without a cursor
+        size_t find(const double *times, size_t size, double time) const
+        {
+            const double position = (time - start) * scale;
+            const size_t bucket = position > 0.0 ? std::min(static_cast<size_t>(position), first.size() - 1) : 0;
+            size_t segment = first[bucket];
+            const size_t last = last_of(bucket, size);
+            if (last - segment + 1 > max_linear_scan)
+            {
+                // First point of the bucket at or after `time` ends the segment
+                const double *end = std::lower_bound(times + segment + 1, times + last + 1, time);
+                segment = static_cast<size_t>(end - times) - 1;
+            }
+            return advance(times, size, segment, time);
+        }
+
+        size_t footprint() const
+        {
+            return first.capacity() * sizeof(uint32_t);
+        }
+
+    private:
+        // Segment ending at the first point at or after `time`, moving from `segment`. Rounding of the
+        // bucket bounds can leave the bucket one point ahead, hence the step back.
+        static size_t advance(const double *times, size_t size, size_t segment, double time)
+        {
+            while (segment + 2 < size && times[segment + 1] < time)
+            {
+                ++segment;
+            }
+            while (segment > 0 && times[segment] >= time)
+            {
+                --segment;
+            }
+            return segment;
+        }
+
+        // Last segment a lookup in bucket `b` can end in
+        size_t last_of(size_t b, size_t size) const
+        {
+            return b + 1 < first.size() ? first[b + 1] : size - 2;
+        }
+
+        // Points a lookup over `points` compares, scanned or bisected
+        static size_t steps(size_t points)
+        {
+            if (points <= max_linear_scan)
+            {
+                return points;
+            }
+            size_t depth = 0;
+            while ((size_t{1} << depth) < points)
+            {
+                ++depth;
+            }
+            return depth + 2;
+        }
+
+        std::vector<uint32_t> first;
+        double start = 0.0;
+        double scale = 0.0;
+        size_t scan = 0;
+        size_t bisected = 0;
+    };
+}
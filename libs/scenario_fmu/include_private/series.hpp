@@ -2,12 +2,21 @@
 #pragma once
 
 #include "string.hpp"
+#include "compression.hpp"
+#include "shapes.hpp"
+#include "range_tree.hpp"
+#include "noise.hpp"
+#include "segment_grid.hpp"
+#include "map2d.hpp"
 
 #include <vector>
+#include <memory>
+#include <string_view>
+#include <cmath>
 #include <algorithm>
+#include <array>
+#include <limits>
 #include <stdexcept>
-#include <format>
-#include <iostream>
 #include <sstream>
 #include <locale>
 
@@ -35,6 +44,23 @@ namespace
         return Interpolation::Linear;
     }
 
+    // A map interpolates in its cells as a series between its points
+    static MapMethod map_method(Interpolation i)
+    {
+        switch (i)
+        {
+        case Interpolation::Zoh:
+            return MapMethod::Corner;
+        case Interpolation::NearestNeighbor:
+            return MapMethod::Nearest;
+        case Interpolation::Cubic:
+            return MapMethod::Bicubic;
+        case Interpolation::Linear:
+        default:
+            return MapMethod::Bilinear;
+        }
+    }
+
     static std::string interpolation_to_string(Interpolation i)
     {
         switch (i)
@@ -52,6 +78,65 @@ namespace
         }
     }
 
+    // FMI type a series is served as
+    enum class ValueType
+    {
+        Real,
+        Integer,
+        Boolean
+    };
+
+    static std::string value_type_to_string(ValueType t)
+    {
+        switch (t)
+        {
+        case ValueType::Integer:
+            return "Integer";
+        case ValueType::Boolean:
+            return "Boolean";
+        case ValueType::Real:
+        default:
+            return "Real";
+        }
+    }
+
+    // What a series does after its last point
+    enum class Extrapolation
+    {
+        Hold,   // keep the last value
+        Zero,   // output zero
+        Repeat  // start over from the first point, the series is one period
+    };
+
+    static std::string extrapolation_to_string(Extrapolation e)
+    {
+        switch (e)
+        {
+        case Extrapolation::Zero:
+            return "Zero";
+        case Extrapolation::Repeat:
+            return "Repeat";
+        case Extrapolation::Hold:
+        default:
+            return "Hold";
+        }
+    }
+
+    // Contiguous window of points the evaluator works on, either the full series or one decoded block
+    struct SeriesView
+    {
+        const double *times = nullptr;
+        const double *values = nullptr;
+        size_t size = 0;
+        size_t first_index = 0;          // index of times[0] within the full series
+        const float *values32 = nullptr; // set instead of values for float32 storage
+
+        double value(size_t index) const
+        {
+            return values32 ? static_cast<double>(values32[index]) : values[index];
+        }
+    };
+
     struct SeriesData
     {
         Interpolation interpolation = Interpolation::Linear;
@@ -61,8 +146,201 @@ namespace
         std::vector<double> times;
         std::vector<double> values;
 
+        // Integer and Boolean series only keep their change points, `times` holds when they change
+        ValueType type = ValueType::Real;
+        Extrapolation extrapolation = Extrapolation::Hold;
+        std::vector<int32_t> integers;
+        std::vector<uint64_t> booleans; // bit packed
+
+        // Series indexed lazily hold their unparsed points until first use
+        bool loaded = true;
+        std::string_view pending;
+
+        // Set when the points are stored block compressed, times/values are then empty
+        std::shared_ptr<const CompressedSeries> compressed;
+        BlockCache block_cache;
+
+        // Set when the points live in memory the series does not own, such as a shared memory
+        // segment mapped read only. `mapping` keeps that memory alive, the point vectors are then empty.
+        std::shared_ptr<const void> mapping;
+        const double *mapped_times = nullptr;
+        const void *mapped_values = nullptr; // same layout as values, integers or booleans
+
+        // Analytic segments, sorted by segment, most series have none
+        std::vector<SegmentShape> shapes;
+
+        // Real values stored as float32, `values` is then empty. Evaluation still runs in double.
+        std::vector<float> values32;
+        bool float32 = false;       // requested by the Float32 modifier
+        double float32_bound = 0.0; // largest error the modifier allows, 0 for no bound
+
+        // Integral from the first point up to every point, built for series with the Integral modifier,
+        // with the panel sums of every chirp segment sorted by segment
+        bool integral = false;
+        std::vector<double> cumulative;
+        std::vector<ChirpIntegral> chirp_integrals;
+
+        // Length of the moving window of the Window modifier, 0 for none. `range` holds the
+        // minimum and maximum of the points, `shape_range` those of the hermite and sine segments
+        // between them by first point, empty without such shapes. The mean uses `cumulative`.
+        double window = 0.0;
+        RangeTree range;
+        RangeTree shape_range;
+
+        // Noise added to the output, see noise.hpp
+        Noise noise;
+
+        // Times as integer ticks of `resolution` seconds, set by quantize_series for plain points
+        std::vector<int64_t> ticks;
+        double resolution = 0.0;
+
+        // Bucket index over the plain points, built by the real-time profile
+        SegmentGrid grid;
+
+        // Input the points are indexed by instead of time, declared by the Input modifier, empty for
+        // time. `input_index` is its position among the inputs of the scenario, see ScenarioState.
+        std::string input;
+        int input_index = -1;
+
+        // Table of the Map modifier over `input` and a second input `input2`, the points are then
+        // empty. `access_index` is the cell of the last lookup along `input`, `map_cursor` along `input2`.
+        std::shared_ptr<const LookupMap> map;
+        std::string input2;
+        int input2_index = -1;
+        size_t map_cursor = 0;
+
+        const SegmentShape *shape_at(size_t segment) const
+        {
+            if (shapes.empty())
+            {
+                return nullptr;
+            }
+            const auto it = std::lower_bound(shapes.begin(), shapes.end(), segment,
+                                             [](const SegmentShape &s, size_t value)
+                                             { return s.segment < value; });
+            return it != shapes.end() && it->segment == segment ? &*it : nullptr;
+        }
+
+        const ChirpIntegral *chirp_integral_at(size_t segment) const
+        {
+            const auto it = std::lower_bound(chirp_integrals.begin(), chirp_integrals.end(), segment,
+                                             [](const ChirpIntegral &c, size_t value)
+                                             { return c.segment < value; });
+            return it != chirp_integrals.end() && it->segment == segment ? &*it : nullptr;
+        }
+
+        // Back to the state right after parsing, decoded blocks stay cached
+        void rewind()
+        {
+            access_index = 0;
+            map_cursor = 0;
+        }
+
+        const double *times_data() const
+        {
+            return mapping ? mapped_times : times.data();
+        }
+
+        const double *values_data() const
+        {
+            return mapping ? static_cast<const double *>(mapped_values) : values.data();
+        }
+
+        double first_time() const
+        {
+            return compressed ? compressed->first_time() : times_data()[0];
+        }
+
+        double last_time() const
+        {
+            return compressed ? compressed->last_time() : times_data()[size - 1];
+        }
+
+        // Points around `time`, decoding the block holding it if the series is compressed
+        SeriesView view_at(double time)
+        {
+            if (!compressed)
+            {
+                if (!values32.empty())
+                {
+                    return {times_data(), nullptr, size, 0, values32.data()};
+                }
+                return {times_data(), values_data(), size, 0};
+            }
+            const size_t hint = access_index / CompressedSeries::block_stride;
+            const auto &block = block_cache.get(*compressed, compressed->find_block(time, hint));
+            return {block.times.data(), block.values.data(), block.times.size(), block.first_index};
+        }
+
+        bool boolean_at(size_t index) const
+        {
+            const uint64_t *words = mapping ? static_cast<const uint64_t *>(mapped_values) : booleans.data();
+            return (words[index >> 6] >> (index & 63)) & 1;
+        }
+
+        int32_t discrete_at(size_t index) const
+        {
+            if (type == ValueType::Boolean)
+            {
+                return static_cast<int32_t>(boolean_at(index));
+            }
+            return mapping ? static_cast<const int32_t *>(mapped_values)[index] : integers[index];
+        }
+
+        // Add a point to an Integer or Boolean series, points repeating the last value are dropped
+        void append_discrete(double time, int32_t value)
+        {
+            if (size > 0 && discrete_at(size - 1) == value)
+            {
+                return;
+            }
+            push_discrete(time, value);
+        }
+
+        void push_discrete(double time, int32_t value)
+        {
+            times.push_back(time);
+            if (type == ValueType::Boolean)
+            {
+                if ((size & 63) == 0)
+                {
+                    booleans.push_back(0);
+                }
+                booleans.back() |= static_cast<uint64_t>(value != 0) << (size & 63);
+            }
+            else
+            {
+                integers.push_back(value);
+            }
+            size += 1;
+        }
+
+        // Memory held by the points of this series
+        size_t footprint() const
+        {
+            size_t bytes = (times.capacity() + values.capacity()) * sizeof(double);
+            bytes += integers.capacity() * sizeof(int32_t) + booleans.capacity() * sizeof(uint64_t);
+            bytes += values32.capacity() * sizeof(float);
+            bytes += shapes.capacity() * sizeof(SegmentShape);
+            bytes += cumulative.capacity() * sizeof(double) + range.footprint() + shape_range.footprint();
+            bytes += ticks.capacity() * sizeof(int64_t) + grid.footprint();
+            for (const auto &chirp : chirp_integrals)
+            {
+                bytes += sizeof(ChirpIntegral) + chirp.sums.capacity() * sizeof(double);
+            }
+            if (map)
+            {
+                bytes += map->footprint();
+            }
+            if (compressed)
+            {
+                bytes += compressed->footprint() + block_cache.footprint();
+            }
+            return bytes;
+        }
+
         // Convert a SeriesData back into the serialized line format:
-        // name; <InterpToken>; t0,v0; t1,v1; ...
+        // name; <InterpToken>; [modifier; ...] t0,v0; t1,v1; ...
         std::string to_string()
         {
             std::ostringstream oss;
@@ -70,153 +348,608 @@ namespace
             oss.imbue(std::locale::classic());
 
             oss << name << "; " << interpolation_to_string(interpolation);
-            const size_t n = size;
-            for (size_t i = 0; i < n && i < times.size() && i < values.size(); ++i)
+            if (type != ValueType::Real)
+            {
+                oss << "; " << value_type_to_string(type);
+            }
+            if (extrapolation != Extrapolation::Hold)
+            {
+                oss << "; " << extrapolation_to_string(extrapolation);
+            }
+            if (float32)
+            {
+                oss << "; Float32";
+                if (float32_bound > 0.0)
+                {
+                    oss << "(" << float32_bound << ")";
+                }
+            }
+            if (!input2.empty())
+            {
+                oss << "; Map(" << input << "," << input2 << ")";
+            }
+            else if (!input.empty())
+            {
+                oss << "; Input(" << input << ")";
+            }
+            if (integral)
+            {
+                oss << "; Integral";
+            }
+            if (window > 0.0)
+            {
+                oss << "; Window(" << window << ")";
+            }
+            if (noise.enabled())
+            {
+                oss << "; " << (noise.band_limited ? "BandNoise(" : "Noise(") << noise.sigma << "," << noise.step << "," << noise.seed << ")";
+            }
+            if (map)
+            {
+                // Both axes, then one row of values per point of the first axis
+                for (const auto *axis : {&map->x, &map->y})
+                {
+                    for (size_t i = 0; i < axis->size(); ++i)
+                    {
+                        oss << (i == 0 ? "; " : ",") << (*axis)[i];
+                    }
+                }
+                for (size_t i = 0; i < map->z.size(); ++i)
+                {
+                    oss << (i % map->y.size() == 0 ? "; " : ",") << map->z[i];
+                }
+                return oss.str();
+            }
+            if (type != ValueType::Real)
+            {
+                for (size_t i = 0; i < size; ++i)
+                {
+                    oss << "; " << times_data()[i] << "," << discrete_at(i);
+                }
+                return oss.str();
+            }
+            if (compressed)
+            {
+                DecodedBlock block;
+                for (size_t b = 0; b < compressed->block_count(); ++b)
+                {
+                    compressed->decode(b, block);
+                    // Blocks share their boundary point, skip it for all but the first
+                    for (size_t i = (b == 0 ? 0 : 1); i < block.times.size(); ++i)
+                    {
+                        oss << "; " << block.times[i] << "," << block.values[i];
+                    }
+                }
+                return oss.str();
+            }
+            const auto view = view_at(0.0);
+            const size_t n = mapping ? size : std::min({size, times.size(), values.size() + values32.size()});
+            for (size_t i = 0; i < n; ++i)
             {
-                oss << "; " << times[i] << "," << values[i];
+                if (const auto *shape = i > 0 ? shape_at(i - 1) : nullptr)
+                {
+                    oss << "; " << shape_to_string(*shape, view.times[i] - view.times[i - 1]);
+                }
+                oss << "; " << view.times[i] << "," << view.value(i);
             }
             return oss.str();
         }
     };
 
-    // Parse scenario input
-    static std::vector<SeriesData> parse_scenario(std::string input)
+    // Replace the plain point arrays by their block compressed form
+    static void compress_series(SeriesData &sd)
     {
-        if (input.empty())
+        if (sd.compressed || sd.mapping || sd.type != ValueType::Real || sd.size < 2 || !sd.shapes.empty())
+        {
+            return;
+        }
+        if (!sd.values32.empty())
         {
-            throw std::runtime_error("No scenario found, make sure to set parameters before ExitInitializationMode");
+            // Rounded values compress well, the XOR of neighbours keeps few meaningful bits
+            sd.values.assign(sd.values32.begin(), sd.values32.end());
+            std::vector<float>().swap(sd.values32);
         }
+        sd.compressed = std::make_shared<const CompressedSeries>(sd.times, sd.values);
+        std::vector<double>().swap(sd.times);
+        std::vector<int64_t>().swap(sd.ticks);
+        std::vector<double>().swap(sd.values);
+    }
 
-        auto groups = split(input, "\n");
+    // Largest absolute change of a value of a Real series when stored as float32,
+    // infinity if a value is out of the float32 range
+    static double float32_error(const SeriesData &sd)
+    {
+        double error = 0.0;
+        for (const double v : sd.values)
+        {
+            const float f = static_cast<float>(v);
+            error = std::max(error, std::isfinite(f) || !std::isfinite(v) ? std::abs(static_cast<double>(f) - v)
+                                                                           : std::numeric_limits<double>::infinity());
+        }
+        return error;
+    }
 
-        size_t nr_variables = groups.size();
-        std::vector<SeriesData> out;
+    // Store the values of a plain Real series as float32
+    static void narrow_values(SeriesData &sd)
+    {
+        if (sd.type != ValueType::Real || sd.compressed || sd.mapping || sd.values.empty())
+        {
+            return;
+        }
+        sd.values32.assign(sd.values.begin(), sd.values.end());
+        std::vector<double>().swap(sd.values);
+    }
+
+    // Index i of the segment [times[i], times[i + 1]] used at `time`, continuing from `cursor`.
+    // This is the segment ending at the first point at or after `time`, clamped to the series.
+    template <class Time>
+    static size_t find_segment_in(const Time *times, size_t size, size_t cursor, Time time)
+    {
+        const size_t last_segment = size - 2;
+        cursor = std::min(cursor, last_segment);
 
-        std::vector<std::vector<double>> temp_rows;
-        for (const auto &g : groups)
+        if (cursor > 0 && times[cursor] >= time)
         {
-            auto fields = split(g, ";");
+            // Going backwards, search from the start
+            const auto upper = std::lower_bound(times, times + size, time) - times;
+            return std::min(static_cast<size_t>(std::max<ptrdiff_t>(upper, 1) - 1), last_segment);
+        }
 
-            SeriesData d;
-            d.name = trim(fields[0]);
-            d.interpolation = interpolation_from_string(trim(fields[1]));
+        // Going forwards, usually only a few points ahead, gallop if not
+        for (int probe = 0; probe < 8; ++probe)
+        {
+            if (cursor == last_segment || times[cursor + 1] >= time)
+            {
+                return cursor;
+            }
+            ++cursor;
+        }
+        const auto upper = std::lower_bound(times + cursor, times + size, time) - times;
+        return std::min(static_cast<size_t>(upper) - 1, last_segment);
+    }
+
+    static size_t find_segment(const SeriesView &view, size_t cursor, double time)
+    {
+        return find_segment_in(view.times, view.size, cursor, time);
+    }
 
-            for (int field_index = 2; field_index < fields.size(); field_index++)
+    // Same segment as find_segment_in for abscissae jumping in both directions, such as an input:
+    // the segment of the cursor and its neighbours first, then a binary search over all points
+    static size_t find_segment_near(const double *times, size_t size, size_t cursor, double time)
+    {
+        const size_t last_segment = size - 2;
+        cursor = std::min(cursor, last_segment);
+        const size_t to = std::min(cursor + 1, last_segment);
+        for (size_t i = cursor > 0 ? cursor - 1 : 0; i <= to; ++i)
+        {
+            if ((i == 0 || times[i] < time) && (i == last_segment || times[i + 1] >= time))
             {
-                auto coordinates = split(fields[field_index], ",");
-                auto x = parse_double_opt(trim(coordinates[0])).value();
-                auto y = parse_double_opt(trim(coordinates[1])).value();
-                d.times.push_back(x);
-                d.values.push_back(y);
-                d.size += 1;
+                return i;
             }
-            // std::cout << d.to_string() << std::endl;
-            out.push_back(std::move(d));
         }
+        const auto upper = std::lower_bound(times, times + size, time) - times;
+        return std::min(static_cast<size_t>(std::max<ptrdiff_t>(upper, 1) - 1), last_segment);
+    }
 
-        return out;
+    // Time on the grid of `resolution`, the same double for every time rounding to the same tick
+    static double quantize_time(double time, double resolution)
+    {
+        return resolution > 0.0 && std::abs(time / resolution) < 9.0e18 ? static_cast<double>(std::llround(time / resolution)) * resolution : time;
     }
 
-    static int counter = 0;
+    // Snap the points of a plain series onto a grid of `resolution` seconds and keep them as integer
+    // ticks. Times quantized the same way then hit the points exactly and search on integers.
+    static void quantize_series(SeriesData &sd, double resolution)
+    {
+        if (!(resolution > 0.0) || sd.compressed || sd.mapping || !sd.loaded || !sd.ticks.empty() || !sd.input.empty())
+        {
+            return;
+        }
+        for (size_t i = 0; i < sd.size; ++i)
+        {
+            if (!(std::abs(sd.times[i] / resolution) < 9.0e18))
+            {
+                return; // beyond int64 ticks, keep the series as it is
+            }
+        }
+        sd.resolution = resolution;
+        sd.ticks.resize(sd.size);
+        for (size_t i = 0; i < sd.size; ++i)
+        {
+            sd.ticks[i] = std::llround(sd.times[i] / resolution);
+            sd.times[i] = static_cast<double>(sd.ticks[i]) * resolution;
+        }
+    }
 
-    static double eval_value_at(SeriesData &sd, double time)
+    // find_segment through the real-time grid, or on the integer ticks of a quantized series when
+    // `time` is on its grid
+    static size_t locate_segment(const SeriesData &sd, const SeriesView &view, size_t cursor, double time)
     {
-        // empty or before first time, do nothing
-        if (sd.times.empty() || time < *sd.times.begin())
+        if (!sd.grid.empty() && view.size == sd.size)
         {
-            return 0.0;
+            return sd.grid.find(view.times, view.size, time);
         }
+        if (!sd.input.empty())
+        {
+            return find_segment_near(view.times, view.size, cursor, time);
+        }
+        if (!sd.ticks.empty() && view.size == sd.size && std::abs(time / sd.resolution) < 9.0e18)
+        {
+            const int64_t tick = std::llround(time / sd.resolution);
+            if (static_cast<double>(tick) * sd.resolution == time)
+            {
+                return find_segment_in(sd.ticks.data(), sd.size, cursor, tick);
+            }
+        }
+        return find_segment(view, cursor, time);
+    }
 
-        // interpolation territory
-        for (size_t index = sd.access_index; index < sd.size - 1; ++index)
+    static double interpolate(Interpolation interpolation, double t0, double v0, double t1, double v1, double time)
+    {
+        switch (interpolation)
         {
-            auto t0 = sd.times[index];
-            auto v0 = sd.values[index];
+        case Interpolation::Zoh:
+            return v0;
+        case Interpolation::NearestNeighbor:
+            return (std::abs(time - t0) <= std::abs(time - t1)) ? v0 : v1;
+        case Interpolation::Linear:
+        case Interpolation::Cubic: // no cubic spline yet, C series are linear
+        default:
+        {
+            const double alpha = (time - t0) / (t1 - t0);
+            return v0 + alpha * (v1 - v0);
+        }
+        }
+    }
 
-            auto t1 = sd.times[index + 1];
-            auto v1 = sd.values[index + 1];
+    // Fold a time after the last point of a Repeat series into (first, last], O(1) per call
+    static double wrap_time(const SeriesData &sd, double time)
+    {
+        const double first = sd.first_time();
+        const double last = sd.last_time();
+        const double period = last - first;
+        if (!(period > 0.0))
+        {
+            return time;
+        }
+        const double offset = std::fmod(time - first, period);
+        // A whole number of periods lands on the last point, as the first period does
+        return offset == 0.0 ? last : first + offset;
+    }
 
-            // std::cout << "Searching" << counter++ << std::endl;
+    // Apply the extrapolation of a non empty series to `time`.
+    // Returns false if the series is zero at `time`, otherwise `time` is where to evaluate it.
+    static bool extrapolate(const SeriesData &sd, double &time)
+    {
+        if (sd.extrapolation == Extrapolation::Hold || time <= sd.last_time())
+        {
+            return true;
+        }
+        if (sd.extrapolation == Extrapolation::Zero)
+        {
+            return false;
+        }
+        time = wrap_time(sd, time);
+        return true;
+    }
 
-            sd.access_index = index;
+    // Time of the first point strictly after `time`, infinity if there is none.
+    // Repeat series continue with the points of the following periods.
+    static double next_point_after(SeriesData &sd, double time)
+    {
+        constexpr double none = std::numeric_limits<double>::infinity();
+        if (sd.size == 0)
+        {
+            return none;
+        }
+        const double first = sd.first_time();
+        const double last = sd.last_time();
+        if (time < first)
+        {
+            return first;
+        }
 
-            if (t0 == time)
+        // Offset of the period holding `time`, 0 within the points themselves
+        double offset = 0.0;
+        if (time >= last)
+        {
+            const double period = last - first;
+            if (sd.extrapolation != Extrapolation::Repeat || !(period > 0.0))
             {
-                // std::cout << "OnPoint: Returning value " << v0 << " at " << time << std::endl;
-                return v0;
+                return none;
             }
-            else if (t0 < time && t1 > time)
+            offset = std::floor((time - first) / period) * period;
+            time = std::clamp(time - offset, first, last);
+            if (time == last)
             {
-                if (sd.interpolation == Interpolation::Zoh)
-                {
-                    // std::cout << "ZOH: Returning value " << v0 << " at " << time << std::endl;
-                    return v0;
-                }
-
-                if (sd.interpolation == Interpolation::NearestNeighbor)
-                {
-                    auto value = (std::abs(time - t0) <= std::abs(time - t1)) ? v0 : v1;
-                    // std::cout << "NN: Returning value " << value << " at " << time << std::endl;
-                    return value;
-                }
-                if (sd.interpolation == Interpolation::Linear)
-                {
-                    const double dt = (t1 - t0);
-                    if (dt == 0.0)
-                    {
-                        return v1;
-                    }
-                    const double alpha = (time - t0) / dt;
-                    auto value = v0 + alpha * (v1 - v0);
-                    // std::cout << "Linear: Returning value " << value << " at " << time << std::endl;
-                    return value;
-                }
+                // Rounded onto the end of the period, the next one starts here
+                offset += period;
+                time = first;
             }
         }
 
-        // std::cout << "Extrapolate after last point, use zero order hold for all, time " << time  << std::endl;
-        return sd.values[sd.access_index + 1];
+        auto view = sd.view_at(time);
+        auto it = std::upper_bound(view.times, view.times + view.size, time);
+        if (it == view.times + view.size)
+        {
+            // On the last point of a compressed block, the next point is in the following block
+            view = sd.view_at(std::nextafter(time, none));
+            it = std::upper_bound(view.times, view.times + view.size, time);
+        }
+        return offset + *it;
+    }
+
+    // Value and partial derivatives of a series with the Map modifier at its inputs `x` and `y`
+    static MapValue eval_map_at(SeriesData &sd, double x, double y)
+    {
+        return sd.map->eval(x, y, sd.access_index, sd.map_cursor);
+    }
+
+    // Values of a series with the Map modifier at the input pairs (x[i], y[i]), or with `partial_x`
+    // their partial derivatives over the first input
+    static void eval_map_batch(SeriesData &sd, const double *x, const double *y, size_t n, double *out, bool partial_x = false)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto m = eval_map_at(sd, x[i], y[i]);
+            out[i] = partial_x ? m.dx : m.value;
+        }
+    }
+
+    static double eval_value_at(SeriesData &sd, double time)
+    {
+        // empty or before first time, do nothing
+        if (sd.size == 0 || time < sd.first_time() || !extrapolate(sd, time))
+        {
+            return 0.0;
+        }
+
+        const auto view = sd.view_at(time);
+        if (view.size == 1)
+        {
+            return view.value(0);
+        }
+
+        const size_t index = locate_segment(sd, view, sd.access_index - std::min(sd.access_index, view.first_index), time);
+        sd.access_index = view.first_index + index;
+
+        const double t0 = view.times[index];
+        const double t1 = view.times[index + 1];
+        if (time <= t0)
+        {
+            return view.value(index);
+        }
+        if (time >= t1)
+        {
+            // On the next point, or extrapolate after last point using zero order hold for all
+            return view.value(index + 1);
+        }
+        if (const auto *shape = sd.shape_at(view.first_index + index))
+        {
+            return shape_value(*shape, t0, view.value(index), t1, view.value(index + 1), time);
+        }
+        return interpolate(sd.interpolation, t0, view.value(index), t1, view.value(index + 1), time);
     }
 
     // Evaluate the first derivative for a series at the requested time using interpolation data.
     static double eval_output_derivative_at(SeriesData &sd,
                                             double time)
     {
-        if (time < sd.times.front() || time > sd.times.back())
+        if (time < sd.first_time() || !extrapolate(sd, time))
         {
             return 0.0;
         }
 
-        size_t index = sd.access_index;
-        for (size_t i = index; i < sd.size - 1; ++i)
+        const auto view = sd.view_at(time);
+        const size_t index = locate_segment(sd, view, sd.access_index - std::min(sd.access_index, view.first_index), time);
+        sd.access_index = view.first_index + index;
+
+        const double t0 = view.times[index];
+        const double t1 = view.times[index + 1];
+        if (time > t1)
         {
-            if (time <= sd.times[i + 1])
-            {
-                index = i;
-                break;
-            }
+            return 0.0;
+        }
+        if (const auto *shape = sd.shape_at(view.first_index + index))
+        {
+            return shape_derivative(*shape, t0, view.value(index), t1, view.value(index + 1), std::max(time, t0));
         }
-        const double t0 = sd.times[index];
-        const double t1 = sd.times[index + 1];
 
         switch (sd.interpolation)
         {
         case Interpolation::Linear:
+        case Interpolation::Cubic: // evaluated as linear
         {
             const double dt = t1 - t0;
             if (dt == 0.0)
             {
                 return 0.0;
             }
-            const double v0 = sd.values[index];
-            const double v1 = sd.values[index + 1];
+            const double v0 = view.value(index);
+            const double v1 = view.value(index + 1);
             return (v1 - v0) / dt;
         }
         case Interpolation::Zoh:
         case Interpolation::NearestNeighbor:
-        case Interpolation::Cubic:
         default:
             return 0.0;
         }
     }
+
+    // Value of an Integer or Boolean series, held from its last change point
+    static int32_t eval_discrete_at(SeriesData &sd, double time)
+    {
+        if (sd.size == 0 || time < sd.first_time() || !extrapolate(sd, time))
+        {
+            return 0;
+        }
+        if (sd.size == 1)
+        {
+            return sd.discrete_at(0);
+        }
+
+        const SeriesView view{sd.times_data(), nullptr, sd.size, 0};
+        const size_t index = locate_segment(sd, view, sd.access_index, time);
+        sd.access_index = index;
+        return sd.discrete_at(time >= view.times[index + 1] ? index + 1 : index);
+    }
+
+    // Values of a Real series on one segment for all times in [first, last), same results as eval_value_at
+    template <Interpolation method>
+    static void eval_segment(double t0, double v0, double t1, double v1, const double *first, const double *last, double *out)
+    {
+        for (; first != last; ++first, ++out)
+        {
+            const double time = *first;
+            *out = time <= t0 ? v0 : time >= t1 ? v1 : interpolate(method, t0, v0, t1, v1, time);
+        }
+    }
+
+    static void eval_shape_segment(const SegmentShape &shape, double t0, double v0, double t1, double v1, const double *first, const double *last, double *out)
+    {
+        for (; first != last; ++first, ++out)
+        {
+            const double time = *first;
+            *out = time <= t0 ? v0 : time >= t1 ? v1 : shape_value(shape, t0, v0, t1, v1, time);
+        }
+    }
+
+    // Values of a Real series at ascending `times` in a single merge style pass over its points.
+    // Every segment evaluates the run of times it covers in one tight loop the compiler can vectorize.
+    template <Interpolation method>
+    static void sweep_sorted(SeriesData &sd, const double *times, size_t n, double *out)
+    {
+        // Nothing before the first point
+        size_t i = sd.size == 0 ? n : std::lower_bound(times, times + n, sd.first_time()) - times;
+        std::fill(out, out + i, 0.0);
+
+        while (i < n)
+        {
+            const auto view = sd.view_at(times[i]);
+            if (view.size == 1)
+            {
+                std::fill(out + i, out + n, view.value(0));
+                return;
+            }
+
+            const bool last_view = view.first_index + view.size == sd.size;
+            const size_t last_index = view.size - 2;
+            size_t index = find_segment(view, sd.access_index - std::min(sd.access_index, view.first_index), times[i]);
+            while (true)
+            {
+                const double t0 = view.times[index];
+                const double t1 = view.times[index + 1];
+
+                // The last segment also holds every later time, others the times up to their end
+                size_t end = last_view && index == last_index ? n : i + 1;
+                while (end < n && times[end] <= t1)
+                {
+                    ++end;
+                }
+                if (const auto *shape = sd.shape_at(view.first_index + index))
+                {
+                    eval_shape_segment(*shape, t0, view.value(index), t1, view.value(index + 1), times + i, times + end, out + i);
+                }
+                else
+                {
+                    eval_segment<method>(t0, view.value(index), t1, view.value(index + 1), times + i, times + end, out + i);
+                }
+                i = end;
+
+                if (i == n || index == last_index)
+                {
+                    break;
+                }
+                // Segment ending at the first point at or after the next time, as find_segment
+                while (index < last_index && view.times[index + 1] < times[i])
+                {
+                    ++index;
+                }
+                if (!last_view && view.times[index + 1] < times[i])
+                {
+                    // Past this block
+                    break;
+                }
+            }
+            sd.access_index = view.first_index + index;
+        }
+    }
+
+    static void eval_values_sorted(SeriesData &sd, const double *times, size_t n, double *out)
+    {
+        switch (sd.interpolation)
+        {
+        case Interpolation::Zoh:
+            sweep_sorted<Interpolation::Zoh>(sd, times, n, out);
+            break;
+        case Interpolation::NearestNeighbor:
+            sweep_sorted<Interpolation::NearestNeighbor>(sd, times, n, out);
+            break;
+        case Interpolation::Linear:
+        case Interpolation::Cubic:
+        default:
+            sweep_sorted<Interpolation::Linear>(sd, times, n, out);
+            break;
+        }
+    }
+
+    // Values of a Repeat series at ascending times after its last point. Times are folded into
+    // the first period in chunks, each chunk staying within one period so it can be swept.
+    static void eval_periods_sorted(SeriesData &sd, const double *times, size_t n, double *out)
+    {
+        std::array<double, 256> folded;
+        size_t i = 0;
+        while (i < n)
+        {
+            size_t count = 0;
+            double previous = -std::numeric_limits<double>::infinity();
+            while (i + count < n && count < folded.size())
+            {
+                const double time = wrap_time(sd, times[i + count]);
+                if (time < previous)
+                {
+                    break;
+                }
+                folded[count++] = previous = time;
+            }
+            eval_values_sorted(sd, folded.data(), count, out + i);
+            i += count;
+        }
+    }
+
+    // Values of a series at `n` times, Integer and Boolean series as reals.
+    // Ascending times are swept in one pass, others fall back to one lookup per time.
+    static void eval_batch(SeriesData &sd, const double *times, size_t n, double *out)
+    {
+        if (sd.type != ValueType::Real)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                out[i] = eval_discrete_at(sd, times[i]);
+            }
+        }
+        else if (std::is_sorted(times, times + n))
+        {
+            // Times after the last point of a Zero or Repeat series are not held
+            const size_t held = sd.extrapolation == Extrapolation::Hold || sd.size == 0
+                                    ? n
+                                    : std::upper_bound(times, times + n, sd.last_time()) - times;
+            eval_values_sorted(sd, times, held, out);
+            if (sd.extrapolation == Extrapolation::Zero)
+            {
+                std::fill(out + held, out + n, 0.0);
+            }
+            else
+            {
+                eval_periods_sorted(sd, times + held, n - held, out + held);
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                out[i] = eval_value_at(sd, times[i]);
+            }
+        }
+    }
 }
@@ -0,0 +1,368 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <locale>
+#include <numbers>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // Closed form replacing the interpolation of one segment, written between its two points:
+    //   ramp                 straight line between the points
+    //   step                 hold the first point until the next one
+    //   sin(amp,freq,phase)  sine on top of the line between the points
+    //   chirp(amp,f0,f1)     sine sweeping linearly from f0 to f1 on top of the line between the points
+    //   hermite(d0,d1)       cubic through the points with slope d0 at the first and d1 at the second
+    // The points themselves keep their values, the shape applies between them.
+    enum class ShapeKind : uint32_t
+    {
+        Ramp,
+        Step,
+        Sine,
+        Chirp,
+        Hermite
+    };
+
+    struct SegmentShape
+    {
+        uint64_t segment = 0; // index of the first point of the segment
+        ShapeKind kind = ShapeKind::Ramp;
+        uint32_t reserved = 0;
+        std::array<double, 3> params{};
+    };
+
+    static const char *shape_name(ShapeKind kind)
+    {
+        switch (kind)
+        {
+        case ShapeKind::Step:
+            return "step";
+        case ShapeKind::Sine:
+            return "sin";
+        case ShapeKind::Chirp:
+            return "chirp";
+        case ShapeKind::Hermite:
+            return "hermite";
+        case ShapeKind::Ramp:
+        default:
+            return "ramp";
+        }
+    }
+
+    // Number of parameters a shape takes, and how many of them may be left out
+    static size_t shape_param_count(ShapeKind kind)
+    {
+        if (kind == ShapeKind::Hermite)
+        {
+            return 2;
+        }
+        return kind == ShapeKind::Sine || kind == ShapeKind::Chirp ? 3 : 0;
+    }
+
+    static size_t shape_optional_params(ShapeKind kind)
+    {
+        return kind == ShapeKind::Sine ? 1 : 0; // phase
+    }
+
+    // A hermite shape is parsed with its two slopes and evaluated as v0 + p0 tau + p1 tau^2 + p2 tau^3,
+    // `tau` the time since the segment start. Turn the slopes into these coefficients once the points
+    // of the segment are known.
+    static void hermite_coefficients(SegmentShape &shape, double t0, double v0, double t1, double v1)
+    {
+        const double dt = t1 - t0;
+        const double d0 = shape.params[0];
+        const double d1 = shape.params[1];
+        if (!(dt > 0.0))
+        {
+            shape.params = {d0, 0.0, 0.0};
+            return;
+        }
+        const double slope = (v1 - v0) / dt;
+        shape.params = {d0, (3.0 * slope - 2.0 * d0 - d1) / dt, (d0 + d1 - 2.0 * slope) / (dt * dt)};
+    }
+
+    // Slope of a hermite shape at the end of its segment, the second parameter it was parsed with
+    static double hermite_end_slope(const SegmentShape &shape, double dt)
+    {
+        const auto &p = shape.params;
+        return p[0] + (2.0 * p[1] + 3.0 * p[2] * dt) * dt;
+    }
+
+    // Minimum and maximum of a hermite shape at its stationary points strictly between `from` and `to`,
+    // times since the segment start, +inf and -inf if it has none there. The ends are left to the caller.
+    static std::pair<double, double> hermite_extremes(const SegmentShape &shape, double v0, double from, double to)
+    {
+        double low = std::numeric_limits<double>::infinity();
+        double high = -std::numeric_limits<double>::infinity();
+        const auto &p = shape.params;
+        auto at = [&](double tau)
+        {
+            if (tau > from && tau < to)
+            {
+                const double v = v0 + tau * (p[0] + tau * (p[1] + tau * p[2]));
+                low = std::min(low, v);
+                high = std::max(high, v);
+            }
+        };
+
+        // Roots of the derivative 3 p2 tau^2 + 2 p1 tau + p0, without cancellation
+        const double a = 3.0 * p[2];
+        const double b = 2.0 * p[1];
+        const double c = p[0];
+        if (a == 0.0)
+        {
+            if (b != 0.0)
+            {
+                at(-c / b);
+            }
+            return {low, high};
+        }
+        const double discriminant = b * b - 4.0 * a * c;
+        if (discriminant >= 0.0)
+        {
+            const double q = -0.5 * (b + std::copysign(std::sqrt(discriminant), b));
+            if (q != 0.0)
+            {
+                at(q / a);
+                at(c / q);
+            }
+        }
+        return {low, high};
+    }
+
+    // Oscillating part of a shape and its derivative, `tau` is the time since the segment start
+    static double shape_phase(const SegmentShape &shape, double tau, double duration)
+    {
+        const auto &p = shape.params;
+        if (shape.kind == ShapeKind::Chirp)
+        {
+            return 2.0 * std::numbers::pi * (p[1] * tau + 0.5 * (p[2] - p[1]) * tau * tau / duration);
+        }
+        return 2.0 * std::numbers::pi * p[1] * tau + p[2];
+    }
+
+    static double shape_frequency(const SegmentShape &shape, double tau, double duration)
+    {
+        const auto &p = shape.params;
+        if (shape.kind == ShapeKind::Chirp)
+        {
+            return p[1] + (p[2] - p[1]) * tau / duration;
+        }
+        return p[1];
+    }
+
+    // Value inside the segment, t0 < time < t1
+    static double shape_value(const SegmentShape &shape, double t0, double v0, double t1, double v1, double time)
+    {
+        if (shape.kind == ShapeKind::Step)
+        {
+            return v0;
+        }
+        if (shape.kind == ShapeKind::Hermite)
+        {
+            const auto &p = shape.params;
+            const double tau = time - t0;
+            return v0 + tau * (p[0] + tau * (p[1] + tau * p[2]));
+        }
+        const double alpha = (time - t0) / (t1 - t0);
+        const double line = v0 + alpha * (v1 - v0);
+        if (shape.kind == ShapeKind::Ramp)
+        {
+            return line;
+        }
+        return line + shape.params[0] * std::sin(shape_phase(shape, time - t0, t1 - t0));
+    }
+
+    // Minimum and maximum of a sine shape on [from, to], times since the segment start, +inf and -inf
+    // for an empty segment. A phase moves the sine off the points, so the ends count with the value of
+    // the shape there. Inside, the slope of the line plus amp omega cos(theta) vanishes at
+    // theta = +-acos(c) + 2 pi k, sin(theta) is the same on each of the two families and the line is
+    // monotonic, so only the first and last root of a family count.
+    static std::pair<double, double> sine_extremes(const SegmentShape &shape, double t0, double v0, double t1, double v1,
+                                                   double from, double to)
+    {
+        double low = std::numeric_limits<double>::infinity();
+        double high = -std::numeric_limits<double>::infinity();
+        const double dt = t1 - t0;
+        if (!(dt > 0.0))
+        {
+            return {low, high};
+        }
+        auto at = [&](double tau)
+        {
+            const double v = shape_value(shape, t0, v0, t1, v1, t0 + tau);
+            low = std::min(low, v);
+            high = std::max(high, v);
+        };
+        at(from);
+        at(to);
+
+        const auto &p = shape.params;
+        const double omega = 2.0 * std::numbers::pi * p[1];
+        if (omega == 0.0 || p[0] == 0.0)
+        {
+            return {low, high};
+        }
+        const double c = -(v1 - v0) / dt / (p[0] * omega);
+        if (!(std::abs(c) <= 1.0))
+        {
+            return {low, high};
+        }
+        const double alpha = std::acos(c);
+        const double theta_from = omega * from + p[2];
+        const double theta_to = omega * to + p[2];
+        const double lowest = std::min(theta_from, theta_to);
+        const double highest = std::max(theta_from, theta_to);
+        constexpr double turn = 2.0 * std::numbers::pi;
+        for (const double root : {alpha, -alpha})
+        {
+            const double first = std::ceil((lowest - root) / turn);
+            const double last = std::floor((highest - root) / turn);
+            // Neighbours as well, a root rounded across an end is dropped by the range check
+            for (const double k : {first - 1.0, first, first + 1.0, last - 1.0, last, last + 1.0})
+            {
+                const double tau = (root + turn * k - p[2]) / omega;
+                if (tau > from && tau < to)
+                {
+                    at(tau);
+                }
+            }
+        }
+        return {low, high};
+    }
+
+    static double shape_derivative(const SegmentShape &shape, double t0, double v0, double t1, double v1, double time)
+    {
+        const double dt = t1 - t0;
+        if (shape.kind == ShapeKind::Step || dt == 0.0)
+        {
+            return 0.0;
+        }
+        if (shape.kind == ShapeKind::Hermite)
+        {
+            const auto &p = shape.params;
+            const double tau = time - t0;
+            return p[0] + tau * (2.0 * p[1] + 3.0 * p[2] * tau);
+        }
+        const double slope = (v1 - v0) / dt;
+        if (shape.kind == ShapeKind::Ramp)
+        {
+            return slope;
+        }
+        const double tau = time - t0;
+        return slope + shape.params[0] * std::cos(shape_phase(shape, tau, dt)) * 2.0 * std::numbers::pi * shape_frequency(shape, tau, dt);
+    }
+
+    // Integral of the oscillating part of a chirp, sin of its quadratic phase without the amplitude,
+    // from `from` to `to` by 5 point Gauss-Legendre on one panel
+    static double chirp_panel(const SegmentShape &shape, double duration, double from, double to)
+    {
+        constexpr std::array<double, 5> nodes = {0.0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640, 0.9061798459386640};
+        constexpr std::array<double, 5> weights = {0.5688888888888889, 0.4786286704993665, 0.4786286704993665, 0.2369268850561891, 0.2369268850561891};
+        const double half = 0.5 * (to - from);
+        const double middle = from + half;
+        double sum = 0.0;
+        for (size_t j = 0; j < nodes.size(); ++j)
+        {
+            sum += weights[j] * std::sin(shape_phase(shape, middle + half * nodes[j], duration));
+        }
+        return half * sum;
+    }
+
+    // Running integral of the oscillating part of a chirp segment at the ends of equal panels of an
+    // eighth of its shortest period, at most 65536 of them. Built with the Integral modifier, an
+    // integral then only sums the panel holding its time.
+    struct ChirpIntegral
+    {
+        uint64_t segment = 0; // index of the first point of the segment
+        double width = 0.0;   // of a panel
+        std::vector<double> sums; // up to the start of every panel and the end of the segment
+    };
+
+    static ChirpIntegral chirp_integral(const SegmentShape &shape, uint64_t segment, double duration)
+    {
+        const auto &p = shape.params;
+        const double cycles = std::max(std::abs(p[1]), std::abs(p[2])) * duration;
+        const size_t panels = static_cast<size_t>(std::clamp(std::ceil(8.0 * cycles), 1.0, 65536.0));
+
+        ChirpIntegral table;
+        table.segment = segment;
+        table.width = duration / static_cast<double>(panels);
+        table.sums.resize(panels + 1, 0.0);
+        for (size_t k = 0; k < panels; ++k)
+        {
+            const double from = static_cast<double>(k) * table.width;
+            table.sums[k + 1] = table.sums[k] + chirp_panel(shape, duration, from, from + table.width);
+        }
+        return table;
+    }
+
+    // Integral from t0 to `time`, t0 <= time <= t1. Closed form but for the chirp, whose sine of a
+    // quadratic phase is taken from `chirp`, the table of its segment, plus the partial panel up to `time`.
+    static double shape_integral(const SegmentShape &shape, double t0, double v0, double t1, double v1, double time,
+                                 const ChirpIntegral *chirp = nullptr)
+    {
+        const double tau = time - t0;
+        if (shape.kind == ShapeKind::Step || tau == 0.0)
+        {
+            return v0 * tau;
+        }
+        if (shape.kind == ShapeKind::Hermite)
+        {
+            const auto &p = shape.params;
+            return tau * (v0 + tau * (p[0] / 2.0 + tau * (p[1] / 3.0 + tau * p[2] / 4.0)));
+        }
+        const double dt = t1 - t0;
+        const double line = tau * (v0 + 0.5 * tau / dt * (v1 - v0));
+        if (shape.kind == ShapeKind::Ramp)
+        {
+            return line;
+        }
+
+        const auto &p = shape.params;
+        if (shape.kind == ShapeKind::Sine)
+        {
+            const double omega = 2.0 * std::numbers::pi * p[1];
+            if (omega == 0.0)
+            {
+                return line + p[0] * std::sin(p[2]) * tau;
+            }
+            return line + p[0] * (std::cos(p[2]) - std::cos(omega * tau + p[2])) / omega;
+        }
+
+        if (!chirp)
+        {
+            const auto table = chirp_integral(shape, 0, dt);
+            return shape_integral(shape, t0, v0, t1, v1, time, &table);
+        }
+        const size_t panel = std::min(static_cast<size_t>(tau / chirp->width), chirp->sums.size() - 1);
+        const double from = static_cast<double>(panel) * chirp->width;
+        return line + p[0] * (chirp->sums[panel] + chirp_panel(shape, dt, from, tau));
+    }
+
+    // Text of a shape on a segment of `duration` seconds
+    static std::string shape_to_string(const SegmentShape &shape, double duration)
+    {
+        std::ostringstream oss;
+        oss.imbue(std::locale::classic());
+        oss << shape_name(shape.kind);
+        const size_t count = shape_param_count(shape.kind);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const bool end_slope = shape.kind == ShapeKind::Hermite && i == 1;
+            oss << (i == 0 ? "(" : ",") << (end_slope ? hermite_end_slope(shape, duration) : shape.params[i]);
+        }
+        if (count > 0)
+        {
+            oss << ")";
+        }
+        return oss.str();
+    }
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "binary.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SCENARIO_SHARED_MEMORY 1
+#endif
+
+namespace
+{
+    // Binary scenario published in a named POSIX shared memory segment, so instances in
+    // different processes evaluate one read only copy of the same parsed scenario.
+    //
+    // The segment is named after a hash of the scenario and its settings, a second hash stored in
+    // the header guards against collisions. `ready` is set last, a segment still being written is not used.
+    // `writer` is stored first: a segment left unfinished by a publisher that is gone is removed, so
+    // the next instance publishes it again. Process ids only tell within one PID namespace, a segment
+    // of a publisher in another one (containers sharing /dev/shm), or one without a header yet, counts
+    // as gone once it has not changed for shared_abandoned_after seconds. Only segments of the same
+    // user are mapped.
+    //
+    // SharedHeader
+    // binary scenario, see binary.hpp
+    inline constexpr char shared_magic[8] = {'S', 'C', 'E', 'N', 'S', 'H', 'M', '3'};
+
+    struct SharedHeader
+    {
+        char magic[8];
+        uint64_t check;
+        uint64_t ready;
+        uint64_t size;   // of the binary scenario
+        uint64_t writer;        // process id of the publisher
+        uint64_t pid_namespace; // of the publisher, see pid_namespace
+    };
+
+    inline constexpr std::time_t shared_abandoned_after = 60;
+
+    static uint64_t fnv1a(std::string_view text, uint64_t hash)
+    {
+        for (const unsigned char c : text)
+        {
+            hash = (hash ^ c) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    // What a segment holds: the scenario text and the settings it was parsed with
+    struct SharedKey
+    {
+        uint64_t name_hash;
+        uint64_t check;
+    };
+
+    static SharedKey shared_key(std::string_view content, std::string_view settings)
+    {
+        const std::string_view version(reinterpret_cast<const char *>(&binary_version), sizeof(binary_version));
+        return {fnv1a(settings, fnv1a(version, fnv1a(content, 0xcbf29ce484222325ull))),
+                fnv1a(settings, fnv1a(version, fnv1a(content, 0x84222325cbf29ce4ull)))};
+    }
+
+    // Name of the segment, short enough for the 31 characters macOS allows
+    static std::string shared_name(const SharedKey &key)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "/scenario_%016llx", static_cast<unsigned long long>(key.name_hash));
+        return name;
+    }
+
+    // Mapping of a segment, unmapped when the last series referencing it is gone.
+    // The publishing instance also removes the name, processes that mapped it keep their mapping.
+    class SharedSegment
+    {
+    public:
+        SharedSegment(std::string name, void *address, size_t length, bool owner)
+            : name(std::move(name)), address(address), length(length), owner(owner)
+        {
+        }
+
+        SharedSegment(const SharedSegment &) = delete;
+        SharedSegment &operator=(const SharedSegment &) = delete;
+
+        ~SharedSegment()
+        {
+#ifdef SCENARIO_SHARED_MEMORY
+            munmap(address, length);
+            if (owner)
+            {
+                shm_unlink(name.c_str());
+            }
+#endif
+        }
+
+        const char *data() const { return static_cast<const char *>(address) + sizeof(SharedHeader); }
+        size_t size() const { return length - sizeof(SharedHeader); }
+
+        const std::string name;
+        void *const address;
+        const size_t length;
+        const bool owner; // published by this process
+    };
+
+#ifdef SCENARIO_SHARED_MEMORY
+    // Identity of the PID namespace of this process, 0 where it can not be told
+    static uint64_t pid_namespace()
+    {
+#ifdef __linux__
+        struct stat st{};
+        if (stat("/proc/self/ns/pid", &st) == 0)
+        {
+            return static_cast<uint64_t>(st.st_ino);
+        }
+#endif
+        return 0;
+    }
+
+    // Publisher of an unfinished segment exited without finishing it. `header` is nullptr for a
+    // segment created but not yet written.
+    static bool writer_gone(const SharedHeader *header, const struct stat &st)
+    {
+        if (header != nullptr && header->writer > 0 && header->pid_namespace == pid_namespace())
+        {
+            return kill(static_cast<pid_t>(header->writer), 0) != 0 && errno == ESRCH;
+        }
+        return std::time(nullptr) - st.st_mtime > shared_abandoned_after;
+    }
+
+    // Read only mapping of a ready segment of this user, nullptr otherwise. An unfinished segment
+    // whose publisher is gone is removed.
+    static std::shared_ptr<const SharedSegment> map_shared_fd(int fd, const std::string &name, const SharedKey &key, bool owner)
+    {
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_uid != geteuid())
+        {
+            return nullptr;
+        }
+        if (static_cast<size_t>(st.st_size) < sizeof(SharedHeader))
+        {
+            // Created, the publisher did not get to write its header
+            if (!owner && writer_gone(nullptr, st))
+            {
+                shm_unlink(name.c_str());
+            }
+            return nullptr;
+        }
+        const size_t length = static_cast<size_t>(st.st_size);
+        void *address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED)
+        {
+            return nullptr;
+        }
+
+        auto *header = static_cast<SharedHeader *>(address);
+        const uint64_t ready = std::atomic_ref<uint64_t>(header->ready).load(std::memory_order_acquire);
+        if (ready == 0 && !owner && writer_gone(header, st))
+        {
+            shm_unlink(name.c_str());
+        }
+        if (ready == 0 || std::memcmp(header->magic, shared_magic, sizeof(shared_magic)) != 0 ||
+            header->check != key.check || header->size > length - sizeof(SharedHeader))
+        {
+            munmap(address, length);
+            return nullptr;
+        }
+        return std::make_shared<const SharedSegment>(name, address, length, owner);
+    }
+#endif
+
+    // Segment published for `key` by any process, nullptr if there is none or it is not complete yet
+    static std::shared_ptr<const SharedSegment> attach_shared(const SharedKey &key)
+    {
+#ifdef SCENARIO_SHARED_MEMORY
+        const auto name = shared_name(key);
+        const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        auto segment = map_shared_fd(fd, name, key, false);
+        close(fd);
+        return segment;
+#else
+        return nullptr;
+#endif
+    }
+
+    // Publish a binary scenario under `key`. Returns the read only mapping of the new segment,
+    // nullptr if the segment exists already or shared memory is not available.
+    static std::shared_ptr<const SharedSegment> publish_shared(const SharedKey &key, const std::vector<char> &binary)
+    {
+#ifdef SCENARIO_SHARED_MEMORY
+        const auto name = shared_name(key);
+        const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        SharedHeader unfinished{};
+        unfinished.writer = static_cast<uint64_t>(getpid());
+        unfinished.pid_namespace = pid_namespace();
+        const size_t length = sizeof(SharedHeader) + binary.size();
+        const bool started = pwrite(fd, &unfinished, sizeof(unfinished), 0) == static_cast<ssize_t>(sizeof(unfinished));
+        void *address = started && ftruncate(fd, static_cast<off_t>(length)) == 0
+                            ? mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                            : MAP_FAILED;
+        if (address == MAP_FAILED)
+        {
+            close(fd);
+            shm_unlink(name.c_str());
+            return nullptr;
+        }
+
+        auto *header = static_cast<SharedHeader *>(address);
+        std::memcpy(header->magic, shared_magic, sizeof(shared_magic));
+        header->check = key.check;
+        header->size = binary.size();
+        std::memcpy(header + 1, binary.data(), binary.size());
+        std::atomic_ref<uint64_t>(header->ready).store(1, std::memory_order_release);
+        munmap(address, length);
+
+        // Evaluate the same read only pages as the other processes
+        auto segment = map_shared_fd(fd, name, key, true);
+        close(fd);
+        if (!segment)
+        {
+            shm_unlink(name.c_str());
+        }
+        return segment;
+#else
+        return nullptr;
+#endif
+    }
+
+    // Series evaluating the points of a segment in place
+    static std::vector<SeriesData> map_shared_scenario(const std::shared_ptr<const SharedSegment> &segment)
+    {
+        return map_scenario(segment->data(), segment->size(), segment);
+    }
+}
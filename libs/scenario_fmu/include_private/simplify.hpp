@@ -0,0 +1,121 @@
+#pragma once
+
+#include "series.hpp"
+
+#include <vector>
+#include <utility>
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    // Mark the points of times/values[first..last] needed to keep linear interpolation within
+    // `epsilon` of the original (Ramer-Douglas-Peucker on the vertical distance).
+    // The error of two polylines is largest at a breakpoint, so checking the removed points is enough.
+    static void mark_linear_points(const std::vector<double> &times, const std::vector<double> &values,
+                                   size_t first, size_t last, double epsilon, std::vector<bool> &keep)
+    {
+        std::vector<std::pair<size_t, size_t>> stack{{first, last}};
+        while (!stack.empty())
+        {
+            const auto [a, b] = stack.back();
+            stack.pop_back();
+            if (b <= a + 1)
+            {
+                continue;
+            }
+
+            const double t0 = times[a];
+            const double v0 = values[a];
+            const double slope = (values[b] - v0) / (times[b] - t0);
+
+            size_t worst = a;
+            double worst_error = epsilon;
+            for (size_t i = a + 1; i < b; ++i)
+            {
+                const double error = std::abs(values[i] - (v0 + slope * (times[i] - t0)));
+                if (error > worst_error)
+                {
+                    worst = i;
+                    worst_error = error;
+                }
+            }
+
+            if (worst != a)
+            {
+                keep[worst] = true;
+                stack.push_back({a, worst});
+                stack.push_back({worst, b});
+            }
+        }
+    }
+
+    // Remove points that do not change the output by more than `tolerance`, relative to the
+    // magnitude of the series. Linear series are simplified within the tolerance, zero order hold
+    // series only lose points repeating the previous value so their steps stay exact.
+    // Returns the number of removed points.
+    static size_t simplify_series(SeriesData &sd, double tolerance)
+    {
+        const size_t n = sd.size;
+        if (sd.compressed || sd.mapping || sd.type != ValueType::Real || n < 3 || !sd.shapes.empty() || !sd.values32.empty())
+        {
+            return 0;
+        }
+
+        std::vector<bool> keep(n, false);
+        keep.front() = true;
+        keep.back() = true;
+
+        if (sd.interpolation == Interpolation::Zoh)
+        {
+            for (size_t i = 1; i + 1 < n; ++i)
+            {
+                keep[i] = sd.values[i] != sd.values[i - 1];
+            }
+        }
+        else if (sd.interpolation == Interpolation::Linear)
+        {
+            double magnitude = 1.0;
+            for (double v : sd.values)
+            {
+                magnitude = std::max(magnitude, std::abs(v));
+            }
+            const double epsilon = tolerance * magnitude;
+
+            // Points sharing a time form a discontinuity, keep them and simplify in between
+            size_t anchor = 0;
+            for (size_t i = 1; i < n; ++i)
+            {
+                const bool jump = sd.times[i] == sd.times[i - 1] || (i + 1 < n && sd.times[i] == sd.times[i + 1]);
+                if (jump || i == n - 1)
+                {
+                    keep[i] = true;
+                    mark_linear_points(sd.times, sd.values, anchor, i, epsilon, keep);
+                    anchor = i;
+                }
+            }
+        }
+        else
+        {
+            return 0;
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (keep[i])
+            {
+                sd.times[kept] = sd.times[i];
+                sd.values[kept] = sd.values[i];
+                ++kept;
+            }
+        }
+        sd.times.resize(kept);
+        sd.values.resize(kept);
+        sd.times.shrink_to_fit();
+        sd.values.shrink_to_fit();
+        sd.size = kept;
+        sd.access_index = 0;
+        return n - kept;
+    }
+}
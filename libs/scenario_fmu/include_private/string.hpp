@@ -2,8 +2,10 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <optional>
 #include <vector>
+#include <charconv>
 
 namespace
 {
@@ -28,17 +30,45 @@ namespace
         return std::string(b, e + 1);
     }
 
-    static std::optional<double> parse_double_opt(const std::string &s)
+    static std::string_view trim_view(std::string_view s)
     {
-        if (s.empty())
-            return std::nullopt;
-        char *end = nullptr;
-        const double v = std::strtod(s.c_str(), &end);
-        if (end == s.c_str())
+        size_t b = 0;
+        size_t e = s.size();
+        while (b < e && std::isspace(static_cast<unsigned char>(s[b])))
+        {
+            ++b;
+        }
+        while (e > b && std::isspace(static_cast<unsigned char>(s[e - 1])))
+        {
+            --e;
+        }
+        return s.substr(b, e - b);
+    }
+
+    // Locale independent number parsing of a trimmed token
+    static std::optional<double> parse_double_opt(std::string_view s)
+    {
+        if (!s.empty() && s.front() == '+')
+            s.remove_prefix(1);
+        double v = 0.0;
+        const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+        if (ec != std::errc() || end == s.data())
             return std::nullopt; // no parse
         return v;
     }
 
+    // Integer filling the whole trimmed token, 2.7 or 1x do not parse
+    static std::optional<long long> parse_integer_opt(std::string_view s)
+    {
+        if (!s.empty() && s.front() == '+')
+            s.remove_prefix(1);
+        long long v = 0;
+        const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+        if (ec != std::errc() || end == s.data() || end != s.data() + s.size())
+            return std::nullopt; // no parse or trailing characters
+        return v;
+    }
+
     static std::vector<std::string> split(std::string s, const std::string &delimiter)
     {
         std::vector<std::string> tokens;
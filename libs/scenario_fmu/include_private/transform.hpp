@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Gain, offset, time shift and time scale applied to a series while it is evaluated,
+    // so variants of a scenario share one parse:
+    //
+    //   output(t) = gain * series((t - time_shift) / time_scale) + offset
+    //
+    // time_scale stretches the series, it must be positive. Integer and Boolean series only
+    // use the time part.
+    struct Transform
+    {
+        double gain = 1.0;
+        double offset = 0.0;
+        double time_shift = 0.0;
+        double time_scale = 1.0;
+
+        bool identity() const
+        {
+            return gain == 1.0 && offset == 0.0 && identity_time();
+        }
+
+        bool identity_time() const
+        {
+            return time_shift == 0.0 && time_scale == 1.0;
+        }
+
+        // Time of the series at simulation time `time`
+        double local_time(double time) const
+        {
+            return (time - time_shift) / time_scale;
+        }
+
+        // Simulation time at which the series reaches `local`, never early after rounding
+        double simulation_time(double local) const
+        {
+            if (!std::isfinite(local))
+            {
+                return local;
+            }
+            double time = local * time_scale + time_shift;
+            while (local_time(time) < local)
+            {
+                time = std::nextafter(time, std::numeric_limits<double>::infinity());
+            }
+            return time;
+        }
+
+        double value(double v) const
+        {
+            return gain * v + offset;
+        }
+
+        // Derivative over simulation time of a series derivative over its own time
+        double derivative(double d) const
+        {
+            return gain * d / time_scale;
+        }
+
+        // Integral over simulation time of a series integral over its own time,
+        // `elapsed` is the time of the series the integral covers
+        double integral(double i, double elapsed) const
+        {
+            return time_scale * (gain * i + offset * elapsed);
+        }
+
+        // This transform applied inside `outer`
+        Transform within(const Transform &outer) const
+        {
+            return {outer.gain * gain,
+                    outer.gain * offset + outer.offset,
+                    outer.time_shift + outer.time_scale * time_shift,
+                    outer.time_scale * time_scale};
+        }
+    };
+
+    // Field of a transform by its position in a value reference range
+    static double *transform_field(Transform &transform, unsigned int field)
+    {
+        switch (field)
+        {
+        case 0:
+            return &transform.gain;
+        case 1:
+            return &transform.offset;
+        case 2:
+            return &transform.time_shift;
+        case 3:
+            return &transform.time_scale;
+        default:
+            return nullptr;
+        }
+    }
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "integral.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // Moving minimum, maximum and mean of a Real series over the window [time - window, time], for
+    // series with the Window modifier. The extremes are the points inside the window, from the range
+    // tree, and the values at both ends of it, which covers every interpolation. Hermite and sine
+    // shapes add their stationary points, from a second tree for the segments inside the window and
+    // in closed form for the two segments the window ends in. Chirp segments are rejected by the
+    // parser. The mean is the difference of two integrals divided by the length.
+    // The window starts no earlier than the first point, before it every statistic is 0.
+    enum class WindowStat
+    {
+        Min,
+        Max,
+        Mean
+    };
+
+    // Extremes of a hermite or sine segment [t0, t1] between `from` and `to`, times since t0, beyond
+    // the values at the points. +inf and -inf for other shapes.
+    static std::pair<double, double> shape_extremes(const SegmentShape &shape, double t0, double v0, double t1, double v1,
+                                                    double from, double to)
+    {
+        if (shape.kind == ShapeKind::Hermite)
+        {
+            return hermite_extremes(shape, v0, from, to);
+        }
+        if (shape.kind == ShapeKind::Sine)
+        {
+            return sine_extremes(shape, t0, v0, t1, v1, from, to);
+        }
+        return {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+    }
+
+    // Range tree over the points and the integral for the mean, on the plain points
+    static void build_window(SeriesData &sd)
+    {
+        if (!(sd.window > 0.0) || !sd.loaded || sd.compressed || sd.type != ValueType::Real || sd.range.size() == sd.size)
+        {
+            return;
+        }
+        build_integral(sd);
+        const auto view = sd.view_at(0.0);
+        sd.range.build(sd.size, [&view](size_t i)
+                       { return view.value(i); });
+
+        const bool curved = std::any_of(sd.shapes.begin(), sd.shapes.end(), [](const SegmentShape &shape)
+                                        { return shape.kind == ShapeKind::Hermite || shape.kind == ShapeKind::Sine; });
+        if (curved)
+        {
+            const std::pair none(std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity());
+            std::vector<std::pair<double, double>> extremes(sd.size, none);
+            for (const auto &shape : sd.shapes)
+            {
+                const size_t i = shape.segment;
+                extremes[i] = shape_extremes(shape, view.times[i], view.value(i), view.times[i + 1], view.value(i + 1),
+                                             0.0, view.times[i + 1] - view.times[i]);
+            }
+            sd.shape_range.build(sd.size, [&extremes](size_t i)
+                                 { return extremes[i].first; }, [&extremes](size_t i)
+                                 { return extremes[i].second; });
+        }
+    }
+
+    // Number of points at or before `time`
+    static size_t points_until(SeriesData &sd, double time)
+    {
+        const auto view = sd.view_at(time);
+        return view.first_index + (std::upper_bound(view.times, view.times + view.size, time) - view.times);
+    }
+
+    // Minimum and maximum of the points [first, last) and of the curved segments between them
+    static std::pair<double, double> points_between(const SeriesData &sd, size_t first, size_t last)
+    {
+        const auto points = sd.range.query(first, last);
+        if (sd.shape_range.size() == 0 || last <= first + 1)
+        {
+            return points;
+        }
+        const auto segments = sd.shape_range.query(first, last - 1);
+        return {std::min(points.first, segments.first), std::max(points.second, segments.second)};
+    }
+
+    // Stationary points within [from, to] of the curved segment holding `time`, times[i] <= time < times[i + 1]
+    static std::pair<double, double> segment_extremes(SeriesData &sd, double time, double from, double to)
+    {
+        const std::pair none(std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity());
+        if (sd.shape_range.size() == 0)
+        {
+            return none;
+        }
+        const auto view = sd.view_at(0.0);
+        const size_t upper = std::upper_bound(view.times, view.times + view.size, time) - view.times;
+        const auto *shape = upper > 0 && upper < view.size ? sd.shape_at(upper - 1) : nullptr;
+        if (shape == nullptr)
+        {
+            return none;
+        }
+        const double t0 = view.times[upper - 1];
+        const double t1 = view.times[upper];
+        return shape_extremes(*shape, t0, view.value(upper - 1), t1, view.value(upper), std::max(from, t0) - t0, std::min(to, t1) - t0);
+    }
+
+    // Minimum and maximum of the points in the window (from, to], both within one period of the series
+    static std::pair<double, double> window_points(SeriesData &sd, double from, double to)
+    {
+        const double first = sd.first_time();
+        const double last = sd.last_time();
+        const double period = last - first;
+        if (sd.extrapolation != Extrapolation::Repeat || to <= last || !(period > 0.0))
+        {
+            return points_between(sd, points_until(sd, from), points_until(sd, std::min(to, last)));
+        }
+        if (to - from >= period)
+        {
+            return points_between(sd, 0, sd.size);
+        }
+
+        // Folded into the first period, a window across the end of a period takes both ends of it
+        const double a = from <= last ? from : wrap_time(sd, from);
+        const double b = wrap_time(sd, to);
+        if (a < b)
+        {
+            return points_between(sd, points_until(sd, a), points_until(sd, b));
+        }
+        const auto tail = points_between(sd, points_until(sd, a), sd.size);
+        const auto head = points_between(sd, 0, points_until(sd, b));
+        return {std::min(tail.first, head.first), std::max(tail.second, head.second)};
+    }
+
+    static double eval_window_at(SeriesData &sd, WindowStat stat, double time)
+    {
+        if (sd.size == 0 || sd.range.size() != sd.size || time < sd.first_time())
+        {
+            return 0.0;
+        }
+        const double start = std::max(time - sd.window, sd.first_time());
+
+        // The start first, the cursor ends at `time` for the next step
+        if (stat == WindowStat::Mean)
+        {
+            const double before = eval_integral_at(sd, start);
+            const double after = eval_integral_at(sd, time);
+            return time > start ? (after - before) / (time - start) : eval_value_at(sd, time);
+        }
+        const double at_start = eval_value_at(sd, start);
+        const double at_end = eval_value_at(sd, time);
+        const auto [low, high] = window_points(sd, start, time);
+
+        // Curved segments the window starts and ends in, within the first period for Repeat series
+        const auto local = [&sd](double t)
+        { return sd.extrapolation == Extrapolation::Repeat && t > sd.last_time() ? wrap_time(sd, t) : t; };
+        const double length = time - start;
+        const double from = local(start);
+        const double to = local(time);
+        const auto head = segment_extremes(sd, from, from, from + length);
+        const auto tail = segment_extremes(sd, std::nextafter(to, -std::numeric_limits<double>::infinity()), to - length, to);
+        if (stat == WindowStat::Min)
+        {
+            return std::min({low, at_start, at_end, head.first, tail.first});
+        }
+        return std::max({high, at_start, at_end, head.second, tail.second});
+    }
+}
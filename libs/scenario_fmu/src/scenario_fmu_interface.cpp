@@ -1,11 +1,12 @@
 
 #include "fmi2.h"
+#include "scenario.h"
 
 // Internal helper base class capturing FMI2 model data/state
 #include "fmi2model.hpp"
 
 // Utils
-#include "series.hpp"
+#include "scenario_state.hpp"
 #include "string.hpp"
 
 #include <vector>
@@ -14,32 +15,17 @@
 #include <optional>
 #include <algorithm>
 #include <cctype>
-#include <format>
 #include <exception>
 #include <stdexcept>
 
 namespace
 {
-    // Value references for parameters
-    inline constexpr unsigned int vrScenarioInput = 0;
-
-    // - Outputs start at this value reference and continue sequentially.
-    // time is the first ouput
-    inline constexpr unsigned int vrFirstOutput = 1;
-
-    class Model : public FMI2::fmi2Model
+    class Model : public FMI2::fmi2Model, public ScenarioState
     {
     public:
         Model()
-            : outputs_count(0), current_time(0.0)
         {
             experiment = new FMI2::fmi2Experiment();
-            experiment->toleranceDefined = fmiFalse;
-            experiment->stopTimeDefined = fmiFalse;
-            experiment->tolerance = 0.0;
-            experiment->startTime = 0.0;
-            experiment->stopTime = 0.0;
-            experiment->time = 0.0;
         }
 
         ~Model()
@@ -47,16 +33,22 @@ namespace
             delete experiment;
         }
 
-        // Parameters
-        std::string scenario_input;      // raw string
-
-        // Parsed
-        std::vector<SeriesData> series;
-        unsigned int outputs_count;
-
-        // Time state
-        double current_time;
+        // Logger for ScenarioState
+        auto logger()
+        {
+            return [this](bool error, const std::string &message)
+            {
+                log(error ? fmi2Error : fmi2OK, error ? "logStatusError" : "logStatusInfo", message);
+            };
+        }
     };
+
+    // Series of an output, parsing its points first if it was indexed lazily.
+    // Returns nullptr, after logging the error, if the points can not be parsed.
+    static SeriesData *loaded_series(Model &model, unsigned int index)
+    {
+        return model.loaded_series(index, model.logger());
+    }
 }
 
 extern "C" {
@@ -84,6 +76,7 @@ fmi2Component fmi2Instantiate(fmi2String instanceName,
     model->type = fmuType;
     model->GUID = std::string(fmuGUID);
     model->resourceLocation = fmuResourceLocation ? std::string(fmuResourceLocation) : std::string();
+    model->resources = resource_directory(model->resourceLocation);
     model->callbacks = functions;
     model->visible = visible;
     model->loggingOn = loggingOn;
@@ -107,12 +100,12 @@ fmi2Status fmi2SetupExperiment(fmi2Component comp,
                                fmi2Real stopTime)
 {
     auto *model = Model::from_component<Model>(comp);
-    model->experiment = new FMI2::fmi2Experiment();
     model->experiment->toleranceDefined = toleranceDefined;
     model->experiment->tolerance = tolerance;
     model->experiment->startTime = startTime;
     model->experiment->stopTimeDefined = stopTimeDefined;
     model->experiment->stopTime = stopTime;
+    model->tolerance = toleranceDefined ? tolerance : 0.0;
 
     return fmi2OK;
 }
@@ -127,10 +120,16 @@ fmi2Status fmi2EnterInitializationMode(fmi2Component comp)
 fmi2Status fmi2ExitInitializationMode(fmi2Component comp)
 {
     auto *model = Model::from_component<Model>(comp);
-
-    model->series = parse_scenario(model->scenario_input);
-    model->outputs_count = static_cast<unsigned int>(model->series.size());
-
+    try
+    {
+        model->initialize(model->logger());
+    }
+    catch (const std::exception &e)
+    {
+        // The C boundary stops exceptions, a scenario that does not parse is an error status
+        model->log(fmi2Error, "logStatusError", e.what());
+        return fmi2Error;
+    }
     model->state = FMI2::StepComplete;
     return fmi2OK;
 }
@@ -147,7 +146,7 @@ fmi2Status fmi2SetTime(fmi2Component comp,
                        fmi2Real time)
 {
     auto *model = Model::from_component<Model>(comp);
-    model->current_time = time;
+    model->set_time(time);
     if (model->experiment)
         model->experiment->time = time;
     return fmi2OK;
@@ -160,11 +159,9 @@ fmi2Status fmi2SetString(fmi2Component comp,
     auto *model = Model::from_component<Model>(comp);
     for (size_t i = 0; i < nvr; ++i)
     {
-        const auto ref = vr[i];
-        const char *val_c = value[i] ? value[i] : "";
-        if (ref == vrScenarioInput)
+        if (vr[i] == vrScenarioInput)
         {
-            model->scenario_input = std::string(val_c);
+            model->set_input(value[i] ? value[i] : "");
         }
     }
     return fmi2OK;
@@ -177,7 +174,7 @@ fmi2Status fmi2DoStep(fmi2Component comp,
 {
     auto *model = Model::from_component<Model>(comp);
     const double new_time = currentCommunicationPoint + communicationStepSize;
-    model->current_time = new_time;
+    model->set_time(new_time);
     if (model->experiment)
         model->experiment->time = new_time;
     model->state = FMI2::StepComplete;
@@ -194,10 +191,21 @@ fmi2Status fmi2GetReal(fmi2Component comp,
 
     for (size_t i = 0; i < nvr; ++i)
     {
-        const unsigned int index = vr[i] - vrFirstOutput; // 0-based
-        if (index >= 0 && index < model->outputs_count)
+        if (model->real_input(vr[i], value[i]))
+        {
+            continue;
+        }
+        const auto [derived, kind] = model->derived_output(vr[i]);
+        const unsigned int index = derived >= 0 ? derived : vr[i] - vrFirstOutput; // 0-based
+        if (index >= 0 && index < model->outputs_count && model->series[index].type == ValueType::Real)
         {
-            value[i] = eval_value_at(model->series[index], model->current_time);
+            auto *series = loaded_series(*model, index);
+            if (series == nullptr)
+            {
+                value[i] = 0.0;
+                return fmi2Error;
+            }
+            value[i] = derived >= 0 ? model->derived_value(*series, kind) : model->real_value(*series);
         }
         else
         {
@@ -233,7 +241,7 @@ fmi2Status fmi2GetRealOutputDerivatives(fmi2Component comp,
         const unsigned int index = ref - vrFirstOutput;
         // std::cout << "aaa Index:" << index << " / " <<  model->outputs_count<< " Time:" << model->current_time << std::endl;
 
-        if (index >= model->outputs_count)
+        if (index >= model->outputs_count || model->series[index].type != ValueType::Real)
         {
             value[i] = 0.0;
             status = fmi2Warning;
@@ -249,8 +257,13 @@ fmi2Status fmi2GetRealOutputDerivatives(fmi2Component comp,
         }
         // std::cout << "aac" << std::endl;
         
-        auto &series = model->series[index];
-        if (series.size < 2)
+        auto *series = loaded_series(*model, index);
+        if (series == nullptr)
+        {
+            value[i] = 0.0;
+            return fmi2Error;
+        }
+        if (series->size < 2 && !series->map)
         {
             value[i] = 0.0;
             status = fmi2Warning;
@@ -258,7 +271,7 @@ fmi2Status fmi2GetRealOutputDerivatives(fmi2Component comp,
         }
         // std::cout << "aad"<< std::endl;;
 
-        const double derivative = eval_output_derivative_at(series, model->current_time);
+        const double derivative = model->real_derivative(*series);
         value[i] = derivative;
     }
 
@@ -268,6 +281,15 @@ fmi2Status fmi2GetRealOutputDerivatives(fmi2Component comp,
 fmi2Status fmi2Reset(fmi2Component comp)
 {
     auto *model = Model::from_component<Model>(comp);
+
+    // Parameters back to their defaults, the parsed series are kept and the next
+    // ExitInitializationMode only parses again if the scenario input or parse settings differ
+    model->experiment->reset();
+    model->reset_parameters();
+    model->tolerance = 0.0;
+    model->current_time = 0.0;
+    model->rewind();
+    model->state = FMI2::Instantiated;
     return fmi2OK;
 }
 
@@ -277,6 +299,7 @@ fmi2Status fmi2SetDebugLogging(fmi2Component comp,
                                const fmi2String categories[])
 {
     auto *model = Model::from_component<Model>(comp);
+    model->loggingOn = loggingOn;
     return fmi2OK;
 }
 
@@ -333,7 +356,30 @@ fmi2Status fmi2GetDirectionalDerivative(fmi2Component comp,
                                         fmi2Real dvUnknown[])
 {
     auto *model = Model::from_component<Model>(comp);
-    return fmi2OK;
+    auto status = fmi2OK;
+
+    // Only the Real outputs of Input and Map series depend on a known, the inputs
+    for (size_t i = 0; i < nUnknown; ++i)
+    {
+        dvUnknown[i] = 0.0;
+        const unsigned int index = vUnknown_ref[i] - vrFirstOutput; // 0-based
+        if (vUnknown_ref[i] < vrFirstOutput || index >= model->outputs_count || model->series[index].type != ValueType::Real)
+        {
+            if (model->derived_output(vUnknown_ref[i]).first < 0)
+            {
+                // Not an output
+                status = fmi2Warning;
+            }
+            continue;
+        }
+        auto *series = loaded_series(*model, index);
+        if (series == nullptr)
+        {
+            return fmi2Error;
+        }
+        dvUnknown[i] = model->directional_derivative(*series, vKnown_ref, nKnown, dvKnown);
+    }
+    return status;
 }
 
 fmi2Status fmi2SetContinuousStates(fmi2Component comp,
@@ -348,7 +394,28 @@ fmi2Status fmi2GetInteger(fmi2Component comp,
                           fmi2Integer value[])
 {
     auto *model = Model::from_component<Model>(comp);
-    return fmi2OK;
+    auto status = fmi2OK;
+
+    for (size_t i = 0; i < nvr; ++i)
+    {
+        const unsigned int index = vr[i] - vrFirstOutput; // 0-based
+        if (index < model->outputs_count && model->series[index].type == ValueType::Integer)
+        {
+            auto *series = loaded_series(*model, index);
+            if (series == nullptr)
+            {
+                value[i] = 0;
+                return fmi2Error;
+            }
+            value[i] = model->discrete_value(*series);
+        }
+        else
+        {
+            value[i] = 0;
+            status = fmi2Warning;
+        }
+    }
+    return status;
 }
 
 fmi2Status fmi2GetBoolean(fmi2Component comp,
@@ -356,7 +423,28 @@ fmi2Status fmi2GetBoolean(fmi2Component comp,
                           fmi2Boolean value[])
 {
     auto *model = Model::from_component<Model>(comp);
-    return fmi2OK;
+    auto status = fmi2OK;
+
+    for (size_t i = 0; i < nvr; ++i)
+    {
+        const unsigned int index = vr[i] - vrFirstOutput; // 0-based
+        if (index < model->outputs_count && model->series[index].type == ValueType::Boolean)
+        {
+            auto *series = loaded_series(*model, index);
+            if (series == nullptr)
+            {
+                value[i] = fmiFalse;
+                return fmi2Error;
+            }
+            value[i] = model->discrete_value(*series) ? fmiTrue : fmiFalse;
+        }
+        else
+        {
+            value[i] = fmiFalse;
+            status = fmi2Warning;
+        }
+    }
+    return status;
 }
 
 fmi2Status fmi2GetString(fmi2Component comp,
@@ -372,7 +460,15 @@ fmi2Status fmi2SetReal(fmi2Component comp,
                        const fmi2Real value[])
 {
     auto *model = Model::from_component<Model>(comp);
-    return fmi2OK;
+    auto status = fmi2OK;
+    for (size_t i = 0; i < nvr; ++i)
+    {
+        if (!model->set_real_input(vr[i], value[i]) && !model->set_real_option(vr[i], value[i]))
+        {
+            status = fmi2Warning;
+        }
+    }
+    return status;
 }
 
 fmi2Status fmi2SetInteger(fmi2Component comp,
@@ -380,7 +476,15 @@ fmi2Status fmi2SetInteger(fmi2Component comp,
                           const fmi2Integer value[])
 {
     auto *model = Model::from_component<Model>(comp);
-    return fmi2OK;
+    auto status = fmi2OK;
+    for (size_t i = 0; i < nvr; ++i)
+    {
+        if (!model->set_integer_option(vr[i], value[i]))
+        {
+            status = fmi2Warning;
+        }
+    }
+    return status;
 }
 
 fmi2Status fmi2SetBoolean(fmi2Component comp,
@@ -388,7 +492,15 @@ fmi2Status fmi2SetBoolean(fmi2Component comp,
                           const fmi2Boolean value[])
 {
     auto *model = Model::from_component<Model>(comp);
-    return fmi2OK;
+    auto status = fmi2OK;
+    for (size_t i = 0; i < nvr; ++i)
+    {
+        if (!model->set_boolean_option(vr[i], value[i] != fmiFalse))
+        {
+            status = fmi2Warning;
+        }
+    }
+    return status;
 }
 
 /* Enter and exit the different modes */
@@ -512,4 +624,28 @@ fmi2Status fmi2GetStringStatus(fmi2Component comp,
     return fmi2OK;
 }
 
+/* Scenario specific API */
+fmi2Status scenario_eval_batch(fmi2Component comp,
+                               fmi2ValueReference vr,
+                               const fmi2Real times[], size_t n,
+                               fmi2Real out[])
+{
+    auto *model = Model::from_component<Model>(comp);
+
+    const unsigned int index = vr - vrFirstOutput; // 0-based
+    if (index >= model->outputs_count)
+    {
+        model->log(fmi2Error, "logStatusError", "scenario_eval_batch: value reference " + std::to_string(vr) + " is not an output");
+        return fmi2Error;
+    }
+
+    auto *series = loaded_series(*model, index);
+    if (series == nullptr)
+    {
+        return fmi2Error;
+    }
+    model->batch_values(*series, times, n, out);
+    return fmi2OK;
+}
+
 } // extern "C"
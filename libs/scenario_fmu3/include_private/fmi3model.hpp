@@ -0,0 +1,78 @@
+#pragma once
+
+#include "fmi3.h"
+
+#include <string>
+#include <cstdint>
+
+// not part of the standard
+namespace FMI3
+{
+
+    typedef enum
+    {
+        StartAndEnd = 1 << 0,
+        Instantiated = 1 << 1,
+        InitializationMode = 1 << 2,
+        ConfigurationMode = 1 << 3,
+        EventMode = 1 << 4,
+
+        // ME states
+        ContinuousTimeMode = 1 << 5,
+
+        // CS states
+        StepMode = 1 << 6,
+
+        Terminated = 1 << 7,
+    } ModelState;
+
+    typedef enum
+    {
+        ModelExchange,
+        CoSimulation,
+        ScheduledExecution
+    } InterfaceType;
+
+    class fmi3Model
+    {
+    public:
+        fmi3Model() {}
+        ~fmi3Model() {}
+
+        template <class T>
+        static T *from_instance(fmi3Instance instance)
+        {
+            return static_cast<T *>(instance);
+        }
+
+        // Forward a message to the environment's logger, if logging is on
+        void log(fmi3Status status, fmi3String category, const std::string &message) const
+        {
+            if (loggingOn && logMessage)
+            {
+                logMessage(instanceEnvironment, status, category, message.c_str());
+            }
+        }
+
+        std::string name;
+        InterfaceType type = CoSimulation;
+        std::string instantiationToken;
+        std::string resourcePath;
+        fmi3Boolean visible = fmi3False;
+        fmi3Boolean loggingOn = fmi3False;
+
+        // Co-Simulation capabilities requested by the importer
+        fmi3Boolean eventModeUsed = fmi3False;
+        fmi3Boolean earlyReturnAllowed = fmi3False;
+
+        fmi3InstanceEnvironment instanceEnvironment = nullptr;
+        fmi3LogMessageCallback logMessage = nullptr;
+
+        ModelState state = Instantiated;
+
+        // Experiment
+        fmi3Float64 startTime = 0.0;
+        fmi3Boolean stopTimeDefined = fmi3False;
+        fmi3Float64 stopTime = 0.0;
+    };
+}
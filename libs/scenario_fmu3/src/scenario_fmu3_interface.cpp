@@ -0,0 +1,943 @@
+
+#include "fmi3.h"
+
+// Internal helper base class capturing FMI3 model data/state
+#include "fmi3model.hpp"
+
+// Utils
+#include "scenario_state.hpp"
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include <exception>
+
+namespace
+{
+    // Array variables holding every output of one type, in output order.
+    // They use a range below the options so the scalar outputs keep their value references.
+    inline constexpr unsigned int vrFirstArray = 0x20000000;
+    inline constexpr unsigned int vrFloat64Array = vrFirstArray + 0;
+    inline constexpr unsigned int vrInt32Array = vrFirstArray + 1;
+    inline constexpr unsigned int vrBooleanArray = vrFirstArray + 2;
+
+    // Output clock ticking when a piecewise constant output changes
+    inline constexpr unsigned int vrChangeClock = vrFirstArray + 3;
+
+    class Model : public FMI3::fmi3Model, public ScenarioState
+    {
+    public:
+        // Set when a change point was reached, cleared once the importer read the clock
+        bool clock_active = false;
+
+        // Logger for ScenarioState
+        auto logger()
+        {
+            return [this](bool error, const std::string &message)
+            {
+                log(error ? fmi3Error : fmi3OK, error ? "logStatusError" : "logStatusInfo", message);
+            };
+        }
+
+        // Series only changing at their points in time: zero order hold Real, Integer and Boolean
+        bool piecewise_constant(unsigned int index) const
+        {
+            const auto &s = series[index];
+            return s.input.empty() && (s.type != ValueType::Real || (s.interpolation == Interpolation::Zoh && s.shapes.empty()));
+        }
+
+        // Inputs the output `vr` depends on besides time, as pairs of the element index of the output
+        // (0 for scalars, 1-based within the arrays) and the input index. Only series indexed by
+        // inputs have any, known once the scenario is parsed.
+        std::vector<std::pair<size_t, unsigned int>> input_dependencies(fmi3ValueReference vr) const
+        {
+            std::vector<std::pair<size_t, unsigned int>> dependencies;
+            auto add = [&](const SeriesData &s, size_t element)
+            {
+                if (s.input_index >= 0)
+                {
+                    dependencies.emplace_back(element, static_cast<unsigned int>(s.input_index));
+                }
+                if (s.input2_index >= 0 && s.input2_index != s.input_index)
+                {
+                    dependencies.emplace_back(element, static_cast<unsigned int>(s.input2_index));
+                }
+            };
+
+            if (vr >= vrFloat64Array && vr <= vrBooleanArray)
+            {
+                const ValueType types[3] = {ValueType::Real, ValueType::Integer, ValueType::Boolean};
+                size_t element = 0;
+                for (unsigned int index = 0; index < outputs_count; ++index)
+                {
+                    if (series[index].type == types[vr - vrFloat64Array])
+                    {
+                        add(series[index], ++element);
+                    }
+                }
+            }
+            else if (vr >= vrFirstOutput && vr - vrFirstOutput < outputs_count)
+            {
+                add(series[vr - vrFirstOutput], 0);
+            }
+            return dependencies;
+        }
+
+        // First change point of a piecewise constant output after `time`, infinity if there is none
+        double next_change_after(double time)
+        {
+            double next = std::numeric_limits<double>::infinity();
+            for (unsigned int i = 0; i < outputs_count; ++i)
+            {
+                if (!piecewise_constant(i))
+                {
+                    continue;
+                }
+                if (auto *s = loaded_series(i, logger()))
+                {
+                    next = std::min(next, next_point(*s, time));
+                }
+            }
+            return next;
+        }
+    };
+
+    // Series of an output, parsing its points first if it was indexed lazily.
+    // Returns nullptr, after logging the error, if the points can not be parsed.
+    static SeriesData *loaded_series(Model &model, unsigned int index)
+    {
+        return model.loaded_series(index, model.logger());
+    }
+
+    // Write the value of one scalar output, or of every element of the array of all outputs of
+    // `type`, to values[k...], advancing k. `eval(series)` gives a single value.
+    template <class T, class Eval>
+    static fmi3Status get_output(Model &model, ValueType type, unsigned int vrArray, fmi3ValueReference vr,
+                                 T values[], size_t nValues, size_t &k, Eval &&eval)
+    {
+        auto put = [&](unsigned int index) -> bool
+        {
+            if (k >= nValues)
+            {
+                model.log(fmi3Error, "logStatusError", "More values than the " + std::to_string(nValues) + " requested");
+                return false;
+            }
+            auto *series = loaded_series(model, index);
+            if (series == nullptr)
+            {
+                return false;
+            }
+            values[k++] = eval(*series);
+            return true;
+        };
+
+        if (vr == vrArray)
+        {
+            for (unsigned int index = 0; index < model.outputs_count; ++index)
+            {
+                if (model.series[index].type == type && !put(index))
+                {
+                    return fmi3Error;
+                }
+            }
+            return fmi3OK;
+        }
+
+        const unsigned int index = vr - vrFirstOutput; // 0-based
+        if (index < model.outputs_count && model.series[index].type == type)
+        {
+            return put(index) ? fmi3OK : fmi3Error;
+        }
+        if (k >= nValues)
+        {
+            return fmi3Error;
+        }
+        // Not an output
+        // return 0
+        values[k++] = T{};
+        return fmi3Warning;
+    }
+
+    template <class T, class Eval>
+    static fmi3Status get_outputs(Model &model, ValueType type, unsigned int vrArray,
+                                  const fmi3ValueReference vr[], size_t nvr,
+                                  T values[], size_t nValues, Eval &&eval)
+    {
+        auto status = fmi3OK;
+        size_t k = 0;
+        for (size_t i = 0; i < nvr && status != fmi3Error; ++i)
+        {
+            status = std::max(status, get_output(model, type, vrArray, vr[i], values, nValues, k, eval));
+        }
+        return status;
+    }
+
+    // Getters and setters for types the scenario has no variables of
+    static fmi3Status no_variables(size_t nvr)
+    {
+        return nvr == 0 ? fmi3OK : fmi3Error;
+    }
+
+    static Model *instantiate(FMI3::InterfaceType type,
+                              fmi3String instanceName,
+                              fmi3String instantiationToken,
+                              fmi3String resourcePath,
+                              fmi3Boolean visible,
+                              fmi3Boolean loggingOn,
+                              fmi3InstanceEnvironment instanceEnvironment,
+                              fmi3LogMessageCallback logMessage)
+    {
+        auto model = new Model();
+        model->name = instanceName ? std::string(instanceName) : std::string();
+        model->type = type;
+        model->instantiationToken = instantiationToken ? std::string(instantiationToken) : std::string();
+        model->resourcePath = resourcePath ? std::string(resourcePath) : std::string();
+        model->resources = resource_directory(model->resourcePath);
+        model->visible = visible;
+        model->loggingOn = loggingOn;
+        model->instanceEnvironment = instanceEnvironment;
+        model->logMessage = logMessage;
+
+        model->state = FMI3::Instantiated;
+        return model;
+    }
+}
+
+extern "C" {
+
+const char *fmi3GetVersion(void)
+{
+    return fmi3Version;
+}
+
+fmi3Status fmi3SetDebugLogging(fmi3Instance instance,
+                               fmi3Boolean loggingOn,
+                               size_t nCategories,
+                               const fmi3String categories[])
+{
+    auto *model = Model::from_instance<Model>(instance);
+    model->loggingOn = loggingOn;
+    return fmi3OK;
+}
+
+/* Creation and destruction of FMU instances */
+fmi3Instance fmi3InstantiateModelExchange(fmi3String instanceName,
+                                          fmi3String instantiationToken,
+                                          fmi3String resourcePath,
+                                          fmi3Boolean visible,
+                                          fmi3Boolean loggingOn,
+                                          fmi3InstanceEnvironment instanceEnvironment,
+                                          fmi3LogMessageCallback logMessage)
+{
+    return instantiate(FMI3::ModelExchange, instanceName, instantiationToken, resourcePath,
+                       visible, loggingOn, instanceEnvironment, logMessage);
+}
+
+fmi3Instance fmi3InstantiateCoSimulation(fmi3String instanceName,
+                                         fmi3String instantiationToken,
+                                         fmi3String resourcePath,
+                                         fmi3Boolean visible,
+                                         fmi3Boolean loggingOn,
+                                         fmi3Boolean eventModeUsed,
+                                         fmi3Boolean earlyReturnAllowed,
+                                         const fmi3ValueReference requiredIntermediateVariables[],
+                                         size_t nRequiredIntermediateVariables,
+                                         fmi3InstanceEnvironment instanceEnvironment,
+                                         fmi3LogMessageCallback logMessage,
+                                         fmi3IntermediateUpdateCallback intermediateUpdate)
+{
+    auto *model = instantiate(FMI3::CoSimulation, instanceName, instantiationToken, resourcePath,
+                              visible, loggingOn, instanceEnvironment, logMessage);
+    model->eventModeUsed = eventModeUsed;
+    model->earlyReturnAllowed = earlyReturnAllowed;
+    return model;
+}
+
+fmi3Instance fmi3InstantiateScheduledExecution(fmi3String instanceName,
+                                               fmi3String instantiationToken,
+                                               fmi3String resourcePath,
+                                               fmi3Boolean visible,
+                                               fmi3Boolean loggingOn,
+                                               fmi3InstanceEnvironment instanceEnvironment,
+                                               fmi3LogMessageCallback logMessage,
+                                               fmi3ClockUpdateCallback clockUpdate,
+                                               fmi3LockPreemptionCallback lockPreemption,
+                                               fmi3UnlockPreemptionCallback unlockPreemption)
+{
+    // Not supported, see modelDescription.xml
+    return nullptr;
+}
+
+void fmi3FreeInstance(fmi3Instance instance)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    delete model;
+}
+
+/* Enter and exit initialization mode, enter event mode, terminate and reset */
+fmi3Status fmi3EnterInitializationMode(fmi3Instance instance,
+                                       fmi3Boolean toleranceDefined,
+                                       fmi3Float64 tolerance,
+                                       fmi3Float64 startTime,
+                                       fmi3Boolean stopTimeDefined,
+                                       fmi3Float64 stopTime)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    model->tolerance = toleranceDefined ? tolerance : 0.0;
+    model->startTime = startTime;
+    model->stopTimeDefined = stopTimeDefined;
+    model->stopTime = stopTime;
+    model->set_time(startTime);
+    model->state = FMI3::InitializationMode;
+    return fmi3OK;
+}
+
+fmi3Status fmi3ExitInitializationMode(fmi3Instance instance)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    try
+    {
+        model->initialize(model->logger());
+    }
+    catch (const std::exception &e)
+    {
+        model->log(fmi3Error, "logStatusError", e.what());
+        return fmi3Error;
+    }
+    // Again on the time grid and calendar of the series just parsed
+    model->set_time(model->startTime);
+
+    // Co-Simulation without event mode goes straight to stepping
+    const bool step_mode = model->type == FMI3::CoSimulation && !model->eventModeUsed;
+    model->state = step_mode ? FMI3::StepMode : FMI3::EventMode;
+    return fmi3OK;
+}
+
+fmi3Status fmi3EnterEventMode(fmi3Instance instance)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    // A time event of Model Exchange lands exactly on the change point
+    const double time = model->current_time;
+    if (model->next_change_after(std::nextafter(time, -std::numeric_limits<double>::infinity())) <= time)
+    {
+        model->clock_active = true;
+    }
+    model->state = FMI3::EventMode;
+    return fmi3OK;
+}
+
+fmi3Status fmi3Terminate(fmi3Instance instance)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    model->state = FMI3::Terminated;
+    return fmi3OK;
+}
+
+fmi3Status fmi3Reset(fmi3Instance instance)
+{
+    auto *model = Model::from_instance<Model>(instance);
+
+    // Parameters back to their defaults, the parsed series are kept and the next
+    // ExitInitializationMode only parses again if the scenario input or parse settings differ
+    model->reset_parameters();
+    model->startTime = 0.0;
+    model->stopTimeDefined = fmi3False;
+    model->stopTime = 0.0;
+    model->tolerance = 0.0;
+    model->current_time = 0.0;
+    model->clock_active = false;
+    model->rewind();
+    model->state = FMI3::Instantiated;
+    return fmi3OK;
+}
+
+/* Getting and setting variable values */
+fmi3Status fmi3GetFloat32(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3Float32 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3GetFloat64(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3Float64 values[], size_t nValues)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    auto status = fmi3OK;
+    size_t k = 0;
+    for (size_t i = 0; i < nValueReferences && status != fmi3Error; ++i)
+    {
+        if (k < nValues && model->real_input(valueReferences[i], values[k]))
+        {
+            ++k;
+            continue;
+        }
+
+        // Integral and window outputs evaluate the series of their output
+        const auto [derived, kind] = model->derived_output(valueReferences[i]);
+        if (derived >= 0)
+        {
+            status = std::max(status, get_output(*model, ValueType::Real, vrFloat64Array, vrFirstOutput + derived, values, nValues, k,
+                                                 [model, kind](SeriesData &s)
+                                                 { return model->derived_value(s, kind); }));
+        }
+        else
+        {
+            status = std::max(status, get_output(*model, ValueType::Real, vrFloat64Array, valueReferences[i], values, nValues, k,
+                                                 [model](SeriesData &s)
+                                                 { return model->real_value(s); }));
+        }
+    }
+    return status;
+}
+
+fmi3Status fmi3GetInt8(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3Int8 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3GetUInt8(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3UInt8 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3GetInt16(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3Int16 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3GetUInt16(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3UInt16 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3GetInt32(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3Int32 values[], size_t nValues)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    return get_outputs(*model, ValueType::Integer, vrInt32Array, valueReferences, nValueReferences, values, nValues,
+                       [model](SeriesData &s)
+                       { return model->discrete_value(s); });
+}
+
+fmi3Status fmi3GetUInt32(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3UInt32 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3GetInt64(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3Int64 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3GetUInt64(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3UInt64 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3GetBoolean(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3Boolean values[], size_t nValues)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    return get_outputs(*model, ValueType::Boolean, vrBooleanArray, valueReferences, nValueReferences, values, nValues,
+                       [model](SeriesData &s)
+                       { return model->discrete_value(s) != 0; });
+}
+
+fmi3Status fmi3GetString(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3String values[], size_t nValues)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    auto status = fmi3OK;
+    for (size_t i = 0; i < nValueReferences && i < nValues; ++i)
+    {
+        if (valueReferences[i] == vrScenarioInput)
+        {
+            values[i] = model->scenario_input->c_str();
+        }
+        else
+        {
+            values[i] = "";
+            status = fmi3Warning;
+        }
+    }
+    return status;
+}
+
+fmi3Status fmi3GetBinary(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, size_t valueSizes[], fmi3Binary values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3GetClock(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3Clock values[])
+{
+    auto *model = Model::from_instance<Model>(instance);
+    auto status = fmi3OK;
+    bool read = false;
+    for (size_t i = 0; i < nValueReferences; ++i)
+    {
+        if (valueReferences[i] == vrChangeClock)
+        {
+            values[i] = model->clock_active ? fmi3ClockActive : fmi3ClockInactive;
+            read = true;
+        }
+        else
+        {
+            values[i] = fmi3ClockInactive;
+            status = fmi3Warning;
+        }
+    }
+    // Output clocks are deactivated once their tick was reported
+    if (read)
+    {
+        model->clock_active = false;
+    }
+    return status;
+}
+
+fmi3Status fmi3SetFloat32(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3Float32 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3SetFloat64(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3Float64 values[], size_t nValues)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    auto status = fmi3OK;
+    for (size_t i = 0; i < nValueReferences && i < nValues; ++i)
+    {
+        if (!model->set_real_input(valueReferences[i], values[i]) && !model->set_real_option(valueReferences[i], values[i]))
+        {
+            status = fmi3Warning;
+        }
+    }
+    return status;
+}
+
+fmi3Status fmi3SetInt8(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3Int8 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3SetUInt8(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3UInt8 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3SetInt16(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3Int16 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3SetUInt16(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3UInt16 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3SetInt32(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3Int32 values[], size_t nValues)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    auto status = fmi3OK;
+    for (size_t i = 0; i < nValueReferences && i < nValues; ++i)
+    {
+        if (!model->set_integer_option(valueReferences[i], values[i]))
+        {
+            status = fmi3Warning;
+        }
+    }
+    return status;
+}
+
+fmi3Status fmi3SetUInt32(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3UInt32 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3SetInt64(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3Int64 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3SetUInt64(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3UInt64 values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3SetBoolean(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3Boolean values[], size_t nValues)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    auto status = fmi3OK;
+    for (size_t i = 0; i < nValueReferences && i < nValues; ++i)
+    {
+        if (!model->set_boolean_option(valueReferences[i], values[i]))
+        {
+            status = fmi3Warning;
+        }
+    }
+    return status;
+}
+
+fmi3Status fmi3SetString(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3String values[], size_t nValues)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    for (size_t i = 0; i < nValueReferences && i < nValues; ++i)
+    {
+        if (valueReferences[i] == vrScenarioInput)
+        {
+            model->set_input(values[i] ? values[i] : "");
+        }
+    }
+    return fmi3OK;
+}
+
+fmi3Status fmi3SetBinary(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const size_t valueSizes[], const fmi3Binary values[], size_t nValues)
+{
+    return no_variables(nValueReferences);
+}
+
+fmi3Status fmi3SetClock(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3Clock values[])
+{
+    // No input clocks
+    return no_variables(nValueReferences);
+}
+
+/* Getting Variable Dependency Information */
+fmi3Status fmi3GetNumberOfVariableDependencies(fmi3Instance instance,
+                                               fmi3ValueReference valueReference,
+                                               size_t *nDependencies)
+{
+    // Outputs depend on time, series indexed by inputs also on their inputs
+    auto *model = Model::from_instance<Model>(instance);
+    *nDependencies = model->input_dependencies(valueReference).size();
+    return fmi3OK;
+}
+
+fmi3Status fmi3GetVariableDependencies(fmi3Instance instance,
+                                       fmi3ValueReference dependent,
+                                       size_t elementIndicesOfDependent[],
+                                       fmi3ValueReference independents[],
+                                       size_t elementIndicesOfIndependents[],
+                                       fmi3DependencyKind dependencyKinds[],
+                                       size_t nDependencies)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    const auto dependencies = model->input_dependencies(dependent);
+    if (nDependencies < dependencies.size())
+    {
+        model->log(fmi3Error, "logStatusError", "Output " + std::to_string(dependent) + " has " + std::to_string(dependencies.size()) + " dependencies");
+        return fmi3Error;
+    }
+    for (size_t i = 0; i < dependencies.size(); ++i)
+    {
+        // A lookup in a table is no linear function of its input
+        elementIndicesOfDependent[i] = dependencies[i].first;
+        independents[i] = vrFirstInput + dependencies[i].second;
+        elementIndicesOfIndependents[i] = 0;
+        dependencyKinds[i] = fmi3Dependent;
+    }
+    return fmi3OK;
+}
+
+/* Getting and setting the internal FMU state, not supported */
+fmi3Status fmi3GetFMUState(fmi3Instance instance, fmi3FMUState *FMUState)
+{
+    return fmi3Error;
+}
+
+fmi3Status fmi3SetFMUState(fmi3Instance instance, fmi3FMUState FMUState)
+{
+    return fmi3Error;
+}
+
+fmi3Status fmi3FreeFMUState(fmi3Instance instance, fmi3FMUState *FMUState)
+{
+    return fmi3OK;
+}
+
+fmi3Status fmi3SerializedFMUStateSize(fmi3Instance instance, fmi3FMUState FMUState, size_t *size)
+{
+    return fmi3Error;
+}
+
+fmi3Status fmi3SerializeFMUState(fmi3Instance instance, fmi3FMUState FMUState, fmi3Byte serializedState[], size_t size)
+{
+    return fmi3Error;
+}
+
+fmi3Status fmi3DeserializeFMUState(fmi3Instance instance, const fmi3Byte serializedState[], size_t size, fmi3FMUState *FMUState)
+{
+    return fmi3Error;
+}
+
+/* Getting partial derivatives, of the scalar Float64 outputs over the inputs */
+fmi3Status fmi3GetDirectionalDerivative(fmi3Instance instance,
+                                        const fmi3ValueReference unknowns[], size_t nUnknowns,
+                                        const fmi3ValueReference knowns[], size_t nKnowns,
+                                        const fmi3Float64 seed[], size_t nSeed,
+                                        fmi3Float64 sensitivity[], size_t nSensitivity)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    if (nSeed != nKnowns || nSensitivity != nUnknowns)
+    {
+        model->log(fmi3Error, "logStatusError", "fmi3GetDirectionalDerivative: " + std::to_string(nSeed) + " seeds for " + std::to_string(nKnowns) +
+                                                    " knowns and " + std::to_string(nSensitivity) + " sensitivities for " + std::to_string(nUnknowns) +
+                                                    " unknowns, the sizes must match");
+        return fmi3Error;
+    }
+    auto status = fmi3OK;
+
+    // Only the Float64 outputs of Input and Map series depend on a known, the inputs
+    for (size_t i = 0; i < nUnknowns; ++i)
+    {
+        sensitivity[i] = 0.0;
+        const unsigned int index = unknowns[i] - vrFirstOutput; // 0-based
+        if (unknowns[i] < vrFirstOutput || index >= model->outputs_count || model->series[index].type != ValueType::Real)
+        {
+            if (model->derived_output(unknowns[i]).first < 0)
+            {
+                status = fmi3Warning;
+            }
+            continue;
+        }
+        auto *series = loaded_series(*model, index);
+        if (series == nullptr)
+        {
+            return fmi3Error;
+        }
+        sensitivity[i] = model->directional_derivative(*series, knowns, nKnowns, seed);
+    }
+    return status;
+}
+
+fmi3Status fmi3GetAdjointDerivative(fmi3Instance instance,
+                                    const fmi3ValueReference unknowns[], size_t nUnknowns,
+                                    const fmi3ValueReference knowns[], size_t nKnowns,
+                                    const fmi3Float64 seed[], size_t nSeed,
+                                    fmi3Float64 sensitivity[], size_t nSensitivity)
+{
+    return fmi3Error;
+}
+
+/* Entering and exiting the Configuration or Reconfiguration Mode */
+fmi3Status fmi3EnterConfigurationMode(fmi3Instance instance)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    model->state = FMI3::ConfigurationMode;
+    return fmi3OK;
+}
+
+fmi3Status fmi3ExitConfigurationMode(fmi3Instance instance)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    model->state = FMI3::Instantiated;
+    return fmi3OK;
+}
+
+/* Clock related functions, the change clock is triggered and has no interval */
+fmi3Status fmi3GetIntervalDecimal(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3Float64 intervals[], fmi3IntervalQualifier qualifiers[])
+{
+    return fmi3Error;
+}
+
+fmi3Status fmi3GetIntervalFraction(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3UInt64 counters[], fmi3UInt64 resolutions[], fmi3IntervalQualifier qualifiers[])
+{
+    return fmi3Error;
+}
+
+fmi3Status fmi3GetShiftDecimal(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3Float64 shifts[])
+{
+    return fmi3Error;
+}
+
+fmi3Status fmi3GetShiftFraction(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, fmi3UInt64 counters[], fmi3UInt64 resolutions[])
+{
+    return fmi3Error;
+}
+
+fmi3Status fmi3SetIntervalDecimal(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3Float64 intervals[])
+{
+    return fmi3Error;
+}
+
+fmi3Status fmi3SetIntervalFraction(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3UInt64 counters[], const fmi3UInt64 resolutions[])
+{
+    return fmi3Error;
+}
+
+fmi3Status fmi3SetShiftDecimal(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3Float64 shifts[])
+{
+    return fmi3Error;
+}
+
+fmi3Status fmi3SetShiftFraction(fmi3Instance instance, const fmi3ValueReference valueReferences[], size_t nValueReferences, const fmi3UInt64 counters[], const fmi3UInt64 resolutions[])
+{
+    return fmi3Error;
+}
+
+fmi3Status fmi3EvaluateDiscreteStates(fmi3Instance instance)
+{
+    return fmi3OK;
+}
+
+fmi3Status fmi3UpdateDiscreteStates(fmi3Instance instance,
+                                    fmi3Boolean *discreteStatesNeedUpdate,
+                                    fmi3Boolean *terminateSimulation,
+                                    fmi3Boolean *nominalsOfContinuousStatesChanged,
+                                    fmi3Boolean *valuesOfContinuousStatesChanged,
+                                    fmi3Boolean *nextEventTimeDefined,
+                                    fmi3Float64 *nextEventTime)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    const double next = model->next_change_after(model->current_time);
+
+    *discreteStatesNeedUpdate = fmi3False;
+    *terminateSimulation = fmi3False;
+    *nominalsOfContinuousStatesChanged = fmi3False;
+    *valuesOfContinuousStatesChanged = fmi3False;
+    *nextEventTimeDefined = std::isfinite(next) ? fmi3True : fmi3False;
+    *nextEventTime = std::isfinite(next) ? next : 0.0;
+    return fmi3OK;
+}
+
+/* Functions for Model Exchange */
+fmi3Status fmi3EnterContinuousTimeMode(fmi3Instance instance)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    model->clock_active = false;
+    model->state = FMI3::ContinuousTimeMode;
+    return fmi3OK;
+}
+
+fmi3Status fmi3CompletedIntegratorStep(fmi3Instance instance,
+                                       fmi3Boolean noSetFMUStatePriorToCurrentPoint,
+                                       fmi3Boolean *enterEventMode,
+                                       fmi3Boolean *terminateSimulation)
+{
+    // Change points are time events, announced by fmi3UpdateDiscreteStates
+    *enterEventMode = fmi3False;
+    *terminateSimulation = fmi3False;
+    return fmi3OK;
+}
+
+fmi3Status fmi3SetTime(fmi3Instance instance, fmi3Float64 time)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    model->set_time(time);
+    return fmi3OK;
+}
+
+fmi3Status fmi3SetContinuousStates(fmi3Instance instance, const fmi3Float64 continuousStates[], size_t nContinuousStates)
+{
+    return fmi3OK;
+}
+
+fmi3Status fmi3GetContinuousStateDerivatives(fmi3Instance instance, fmi3Float64 derivatives[], size_t nContinuousStates)
+{
+    return fmi3OK;
+}
+
+fmi3Status fmi3GetEventIndicators(fmi3Instance instance, fmi3Float64 eventIndicators[], size_t nEventIndicators)
+{
+    return fmi3OK;
+}
+
+fmi3Status fmi3GetContinuousStates(fmi3Instance instance, fmi3Float64 continuousStates[], size_t nContinuousStates)
+{
+    return fmi3OK;
+}
+
+fmi3Status fmi3GetNominalsOfContinuousStates(fmi3Instance instance, fmi3Float64 nominals[], size_t nContinuousStates)
+{
+    return fmi3OK;
+}
+
+fmi3Status fmi3GetNumberOfEventIndicators(fmi3Instance instance, size_t *nEventIndicators)
+{
+    *nEventIndicators = 0;
+    return fmi3OK;
+}
+
+fmi3Status fmi3GetNumberOfContinuousStates(fmi3Instance instance, size_t *nContinuousStates)
+{
+    *nContinuousStates = 0;
+    return fmi3OK;
+}
+
+/* Functions for Co-Simulation */
+fmi3Status fmi3EnterStepMode(fmi3Instance instance)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    model->clock_active = false;
+    model->state = FMI3::StepMode;
+    return fmi3OK;
+}
+
+fmi3Status fmi3GetOutputDerivatives(fmi3Instance instance,
+                                    const fmi3ValueReference valueReferences[],
+                                    size_t nValueReferences,
+                                    const fmi3Int32 orders[],
+                                    fmi3Float64 values[],
+                                    size_t nValues)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    auto status = fmi3OK;
+    size_t k = 0;
+    for (size_t i = 0; i < nValueReferences && status != fmi3Error; ++i)
+    {
+        // Only the first derivative is provided
+        const bool first_order = orders[i] == 1;
+        if (!first_order)
+        {
+            status = std::max(status, fmi3Warning);
+        }
+        status = std::max(status, get_output(*model, ValueType::Real, vrFloat64Array, valueReferences[i], values, nValues, k,
+                                             [model, first_order](SeriesData &s)
+                                             { return first_order && s.size >= 2 ? model->real_derivative(s) : 0.0; }));
+    }
+    return status;
+}
+
+fmi3Status fmi3DoStep(fmi3Instance instance,
+                      fmi3Float64 currentCommunicationPoint,
+                      fmi3Float64 communicationStepSize,
+                      fmi3Boolean noSetFMUStatePriorToCurrentPoint,
+                      fmi3Boolean *eventHandlingNeeded,
+                      fmi3Boolean *terminateSimulation,
+                      fmi3Boolean *earlyReturn,
+                      fmi3Float64 *lastSuccessfulTime)
+{
+    auto *model = Model::from_instance<Model>(instance);
+    double end_time = currentCommunicationPoint + communicationStepSize;
+
+    *eventHandlingNeeded = fmi3False;
+    *terminateSimulation = fmi3False;
+    *earlyReturn = fmi3False;
+
+    if (model->eventModeUsed)
+    {
+        // Stop at the first change point inside the step, or flag it at the end of the step
+        const double next = model->next_change_after(currentCommunicationPoint);
+        if (next < end_time && model->earlyReturnAllowed)
+        {
+            end_time = next;
+            *earlyReturn = fmi3True;
+        }
+        if (next <= end_time)
+        {
+            *eventHandlingNeeded = fmi3True;
+            model->clock_active = true;
+        }
+    }
+
+    model->set_time(end_time);
+    *lastSuccessfulTime = end_time;
+    model->state = FMI3::StepMode;
+    return fmi3OK;
+}
+
+/* Functions for Scheduled Execution */
+fmi3Status fmi3ActivateModelPartition(fmi3Instance instance,
+                                      fmi3ValueReference clockReference,
+                                      fmi3Float64 activationTime)
+{
+    return fmi3Error;
+}
+
+} // extern "C"
@@ -0,0 +1,317 @@
+// Python extension exposing the scenario evaluation core.
+// Uses the same parser and evaluator as scenario.so, so results are bit identical to the FMU.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "series.hpp"
+#include "parser.hpp"
+#include "binary.hpp"
+
+#include <exception>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    struct ScenarioObject
+    {
+        PyObject_HEAD
+        std::vector<SeriesData> *series;
+    };
+
+    PyTypeObject ScenarioType = {PyVarObject_HEAD_INIT(nullptr, 0)};
+
+    static PyObject *wrap_series(std::vector<SeriesData> &&series)
+    {
+        auto *self = PyObject_New(ScenarioObject, &ScenarioType);
+        if (self == nullptr)
+        {
+            return nullptr;
+        }
+        self->series = new std::vector<SeriesData>(std::move(series));
+        return reinterpret_cast<PyObject *>(self);
+    }
+
+    static void scenario_dealloc(PyObject *obj)
+    {
+        delete reinterpret_cast<ScenarioObject *>(obj)->series;
+        PyObject_Free(obj);
+    }
+
+    // Buffer of contiguous float64 values, released on scope exit
+    class DoubleBuffer
+    {
+    public:
+        bool acquire(PyObject *obj, bool writable, const char *what)
+        {
+            const int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0);
+            if (PyObject_GetBuffer(obj, &view, flags) != 0)
+            {
+                return false;
+            }
+            acquired = true;
+            const std::string_view format = view.format ? view.format : "B";
+            if (view.itemsize != sizeof(double) || (format != "d" && format != "<d" && format != "=d"))
+            {
+                PyErr_Format(PyExc_TypeError, "%s must be a contiguous float64 buffer", what);
+                return false;
+            }
+            return true;
+        }
+
+        ~DoubleBuffer()
+        {
+            if (acquired)
+            {
+                PyBuffer_Release(&view);
+            }
+        }
+
+        double *data() const { return static_cast<double *>(view.buf); }
+        size_t size() const { return static_cast<size_t>(view.len) / sizeof(double); }
+
+    private:
+        Py_buffer view{};
+        bool acquired = false;
+    };
+
+    // Fill out[i] with the series value or derivative at times[i]
+    static PyObject *scenario_eval_into(PyObject *obj, PyObject *args, bool derivative)
+    {
+        auto &series = *reinterpret_cast<ScenarioObject *>(obj)->series;
+        Py_ssize_t index = 0;
+        PyObject *times_obj = nullptr;
+        PyObject *out_obj = nullptr;
+        PyObject *second_obj = Py_None;
+        if (!PyArg_ParseTuple(args, "nOO|O", &index, &times_obj, &out_obj, &second_obj))
+        {
+            return nullptr;
+        }
+        if (index < 0 || static_cast<size_t>(index) >= series.size())
+        {
+            PyErr_Format(PyExc_IndexError, "Series index %zd out of range", index);
+            return nullptr;
+        }
+
+        DoubleBuffer times;
+        DoubleBuffer out;
+        if (!times.acquire(times_obj, false, "times") || !out.acquire(out_obj, true, "out"))
+        {
+            return nullptr;
+        }
+        if (times.size() != out.size())
+        {
+            PyErr_SetString(PyExc_ValueError, "times and out must have the same length");
+            return nullptr;
+        }
+
+        auto &sd = series[index];
+        try
+        {
+            load_series(sd);
+        }
+        catch (const std::exception &e)
+        {
+            PyErr_SetString(PyExc_ValueError, e.what());
+            return nullptr;
+        }
+
+        // Maps take the values of both inputs, `times` holds the first one
+        DoubleBuffer second;
+        if (sd.map && second_obj == Py_None)
+        {
+            PyErr_Format(PyExc_ValueError, "Series %s is a map, it needs the values of its second input", sd.name.c_str());
+            return nullptr;
+        }
+        if (!sd.map && second_obj != Py_None)
+        {
+            PyErr_Format(PyExc_ValueError, "Series %s is no map, it has no second input", sd.name.c_str());
+            return nullptr;
+        }
+        if (sd.map && !second.acquire(second_obj, false, "second"))
+        {
+            return nullptr;
+        }
+        if (sd.map && second.size() != times.size())
+        {
+            PyErr_SetString(PyExc_ValueError, "times and second must have the same length");
+            return nullptr;
+        }
+
+        const double *t = times.data();
+        double *v = out.data();
+        const size_t n = times.size();
+        if (sd.map)
+        {
+            // The derivative is the partial derivative over the first input
+            eval_map_batch(sd, t, second.data(), n, v, derivative);
+        }
+        else if (derivative)
+        {
+            // Same rules as fmi2GetRealOutputDerivatives
+            const bool defined = sd.type == ValueType::Real && sd.size >= 2;
+            for (size_t i = 0; i < n; ++i)
+            {
+                v[i] = defined ? eval_output_derivative_at(sd, t[i]) : 0.0;
+                if (defined && sd.noise.enabled() && t[i] >= sd.first_time())
+                {
+                    v[i] += noise_derivative_at(sd.noise, t[i]);
+                }
+            }
+        }
+        else
+        {
+            eval_batch(sd, t, n, v);
+            if (sd.type == ValueType::Real && sd.noise.enabled() && sd.size > 0)
+            {
+                add_noise(sd.noise, sd.first_time(), t, n, v);
+            }
+        }
+        Py_RETURN_NONE;
+    }
+
+    static PyObject *scenario_evaluate_into(PyObject *obj, PyObject *args)
+    {
+        return scenario_eval_into(obj, args, false);
+    }
+
+    static PyObject *scenario_derivative_into(PyObject *obj, PyObject *args)
+    {
+        return scenario_eval_into(obj, args, true);
+    }
+
+    // List of (name, interpolation, type) per series, in value reference order
+    static PyObject *scenario_series(PyObject *obj, PyObject *)
+    {
+        const auto &series = *reinterpret_cast<ScenarioObject *>(obj)->series;
+        PyObject *list = PyList_New(static_cast<Py_ssize_t>(series.size()));
+        if (list == nullptr)
+        {
+            return nullptr;
+        }
+        for (size_t i = 0; i < series.size(); ++i)
+        {
+            const auto &sd = series[i];
+            PyObject *item = Py_BuildValue("(s#ss)", sd.name.data(), static_cast<Py_ssize_t>(sd.name.size()),
+                                           interpolation_to_string(sd.interpolation).c_str(),
+                                           value_type_to_string(sd.type).c_str());
+            if (item == nullptr)
+            {
+                Py_DECREF(list);
+                return nullptr;
+            }
+            PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i), item);
+        }
+        return list;
+    }
+
+    static PyObject *scenario_to_binary(PyObject *obj, PyObject *)
+    {
+        auto &series = *reinterpret_cast<ScenarioObject *>(obj)->series;
+        try
+        {
+            for (auto &sd : series)
+            {
+                load_series(sd);
+            }
+            const auto bytes = serialize_scenario(series);
+            return PyBytes_FromStringAndSize(bytes.data(), static_cast<Py_ssize_t>(bytes.size()));
+        }
+        catch (const std::exception &e)
+        {
+            PyErr_SetString(PyExc_ValueError, e.what());
+            return nullptr;
+        }
+    }
+
+    PyMethodDef scenario_methods[] = {
+        {"series", scenario_series, METH_NOARGS, "List of (name, interpolation, type) for every series."},
+        {"to_binary", scenario_to_binary, METH_NOARGS, "Serialize the parsed scenario to bytes."},
+        {"evaluate_into", scenario_evaluate_into, METH_VARARGS, "evaluate_into(index, times, out, second=None): values of a series at float64 times, of a map at the values of its inputs."},
+        {"derivative_into", scenario_derivative_into, METH_VARARGS, "derivative_into(index, times, out, second=None): first derivative of a series at float64 times, of a map over its first input."},
+        {nullptr, nullptr, 0, nullptr},
+    };
+
+    static PyObject *native_parse(PyObject *, PyObject *args)
+    {
+        const char *text = nullptr;
+        Py_ssize_t length = 0;
+        unsigned int threads = 1;
+        if (!PyArg_ParseTuple(args, "s#|I", &text, &length, &threads))
+        {
+            return nullptr;
+        }
+        try
+        {
+            return wrap_series(parse_scenario(std::string_view(text, static_cast<size_t>(length)), threads));
+        }
+        catch (const std::exception &e)
+        {
+            PyErr_SetString(PyExc_ValueError, e.what());
+            return nullptr;
+        }
+    }
+
+    static PyObject *native_load(PyObject *, PyObject *args)
+    {
+        Py_buffer buffer;
+        if (!PyArg_ParseTuple(args, "y*", &buffer))
+        {
+            return nullptr;
+        }
+        PyObject *result = nullptr;
+        try
+        {
+            result = wrap_series(deserialize_scenario(static_cast<const char *>(buffer.buf), static_cast<size_t>(buffer.len)));
+        }
+        catch (const std::exception &e)
+        {
+            PyErr_SetString(PyExc_ValueError, e.what());
+        }
+        PyBuffer_Release(&buffer);
+        return result;
+    }
+
+    PyMethodDef native_methods[] = {
+        {"parse", native_parse, METH_VARARGS, "parse(text, threads=1): parse a scenario string."},
+        {"load", native_load, METH_VARARGS, "load(data): load a scenario serialized with Scenario.to_binary."},
+        {nullptr, nullptr, 0, nullptr},
+    };
+
+    PyModuleDef native_module = {
+        PyModuleDef_HEAD_INIT,
+        "_native",
+        "Scenario evaluation core",
+        -1,
+        native_methods,
+    };
+}
+
+PyMODINIT_FUNC PyInit__native()
+{
+    ScenarioType.tp_name = "scenario_fmu_generator._native.Scenario";
+    ScenarioType.tp_basicsize = sizeof(ScenarioObject);
+    ScenarioType.tp_flags = Py_TPFLAGS_DEFAULT;
+    ScenarioType.tp_doc = "Parsed scenario";
+    ScenarioType.tp_dealloc = scenario_dealloc;
+    ScenarioType.tp_methods = scenario_methods;
+    if (PyType_Ready(&ScenarioType) < 0)
+    {
+        return nullptr;
+    }
+
+    PyObject *module = PyModule_Create(&native_module);
+    if (module == nullptr)
+    {
+        return nullptr;
+    }
+    Py_INCREF(&ScenarioType);
+    if (PyModule_AddObject(module, "Scenario", reinterpret_cast<PyObject *>(&ScenarioType)) < 0)
+    {
+        Py_DECREF(&ScenarioType);
+        Py_DECREF(module);
+        return nullptr;
+    }
+    return module;
+}
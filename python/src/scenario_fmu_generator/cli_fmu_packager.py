@@ -1,9 +1,10 @@
 import argparse
+from pathlib import Path
 
-from .fmu_packager import ScenarioFmuPackager
+from .fmu_packager import FMI_VERSIONS, ScenarioFmuPackager
 
 """
-Package the Scenario FMU as a valid FMI 2.0 Co-Simulation FMU (.fmu).
+Package the Scenario FMU as a valid FMI 2.0 or FMI 3.0 Co-Simulation FMU (.fmu).
 
 - Generates modelDescription.xml with configurable outputs.
 - Copies the built shared library to binaries/<platform>/.
@@ -30,6 +31,12 @@ def main() -> int:
     ap.add_argument(
         "--guid", default=None, help="GUID to embed (default: random uuid4)"
     )
+    ap.add_argument(
+        "--fmi-version",
+        choices=FMI_VERSIONS,
+        default="2.0",
+        help="FMI version, 3.0 adds array outputs per type and a clock ticking at the zero order hold change points",
+    )
     ap.add_argument(
         "-s",
         "--scenario-data",
@@ -37,11 +44,110 @@ def main() -> int:
         default="",
         help="Scenario data, if empty it will create a number of generic outputs that can be parameterized",
     )
+    ap.add_argument(
+        "--compress",
+        action="store_true",
+        help="Store the series block compressed in memory (default value of compress_series)",
+    )
+    ap.add_argument(
+        "--simplify",
+        action="store_true",
+        help="Drop points within the experiment tolerance at initialization (default value of simplify_series)",
+    )
+    ap.add_argument(
+        "--parse-threads",
+        type=int,
+        default=None,
+        help="Threads used to parse the scenario, 0 for one per hardware thread, 1 for single threaded",
+    )
+    ap.add_argument(
+        "--lazy",
+        action="store_true",
+        help="Parse the points of a series on first access (default value of lazy_parse)",
+    )
+    ap.add_argument(
+        "--shared-memory",
+        action="store_true",
+        help="Share the parsed scenario between processes through POSIX shared memory (default value of shared_memory)",
+    )
+    ap.add_argument(
+        "--float32",
+        action="store_true",
+        help="Store the values of Real series as float32 (default value of float32_values)",
+    )
+    ap.add_argument(
+        "--float32-bound",
+        type=float,
+        default=None,
+        help="Largest error float32 storage may cause, series exceeding it stay double (default value of float32_bound)",
+    )
+    ap.add_argument(
+        "--event-calendar",
+        action="store_true",
+        help="Advance the series from one merged calendar of their points (default value of event_calendar)",
+    )
+    ap.add_argument(
+        "--time-resolution",
+        type=float,
+        default=None,
+        help="Grid of the integer time base in seconds, points and step times are quantized onto it (default value of time_resolution)",
+    )
+    ap.add_argument(
+        "--realtime",
+        action="store_true",
+        help="Bounded lookups and no allocation while stepping, for libraries built with -DSCENARIO_REALTIME=ON (default value of realtime)",
+    )
+    ap.add_argument(
+        "--series-transforms",
+        action="store_true",
+        help="Add gain, offset, time_shift and time_scale parameters for every series (<series>.gain, ...)",
+    )
+    ap.add_argument(
+        "--library",
+        action="append",
+        default=[],
+        metavar="FILE",
+        help="Scenario text file added to the packaged library, selected by scenario_index in the given order. Can be repeated",
+    )
+    ap.add_argument(
+        "--compiled-source",
+        default=None,
+        metavar="FILE",
+        help="Write the scenario as a C++ source for -DSCENARIO_COMPILED_SOURCE instead of packaging, the library built with it evaluates the scenario without parsing",
+    )
     args = ap.parse_args()
 
-    b = ScenarioFmuPackager(args.model_id, args.model_name, args.guid)
+    b = ScenarioFmuPackager(args.model_id, args.model_name, args.guid, args.fmi_version)
     if args.scenario_data:
         b.add_raw(args.scenario_data)
+    for path in args.library:
+        b.add_library_scenario(Path(path).read_text(encoding="utf-8"))
+    if args.compress:
+        b.set_option("compress_series", True)
+    if args.simplify:
+        b.set_option("simplify_series", True)
+    if args.lazy:
+        b.set_option("lazy_parse", True)
+    if args.shared_memory:
+        b.set_option("shared_memory", True)
+    if args.float32:
+        b.set_option("float32_values", True)
+    if args.float32_bound is not None:
+        b.set_option("float32_bound", args.float32_bound)
+    if args.event_calendar:
+        b.set_option("event_calendar", True)
+    if args.time_resolution is not None:
+        b.set_option("time_resolution", args.time_resolution)
+    if args.realtime:
+        b.set_option("realtime", True)
+    if args.series_transforms:
+        b.set_option("series_transforms", True)
+    if args.parse_threads is not None:
+        b.set_option("parse_threads", args.parse_threads)
+
+    if args.compiled_source:
+        b.write_compiled_source(args.compiled_source)
+        return 0
 
     return b.build(args.out)
 
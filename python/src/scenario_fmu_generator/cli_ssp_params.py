@@ -21,12 +21,31 @@ def main() -> int:
         "--scenario-data",
         type=str,
         default="",
-        help="Scenario data",
+        help="Scenario data, if empty the scenario of the FMU is kept",
+    )
+    ap.add_argument("--gain", type=float, default=None, help="Gain of all series")
+    ap.add_argument("--offset", type=float, default=None, help="Offset of all series")
+    ap.add_argument("--time-shift", type=float, default=None, help="Time shift of all series")
+    ap.add_argument("--time-scale", type=float, default=None, help="Time scale of all series, must be positive")
+    ap.add_argument(
+        "--series-transform",
+        action="append",
+        default=[],
+        metavar="SERIES.FIELD=VALUE",
+        help="Transform of one series, FIELD is gain, offset, time_shift or time_scale. Can be repeated",
     )
     args = ap.parse_args()
 
     b = ParameterSetBuilder(name=args.name)
-    b.add_string("scenario_input", args.scenario_data)
+    if args.scenario_data:
+        b.add_string("scenario_input", args.scenario_data)
+    b.add_transform(gain=args.gain, offset=args.offset, time_shift=args.time_shift, time_scale=args.time_scale)
+    for item in args.series_transform:
+        name, sep, value = item.partition("=")
+        series, dot, field = name.rpartition(".")
+        if not sep or not dot or field not in ("gain", "offset", "time_shift", "time_scale"):
+            ap.error(f"Invalid --series-transform {item}, expected SERIES.FIELD=VALUE")
+        b.add_transform(series, **{field: float(value)})
     b.build(args.out)
 
     return 0
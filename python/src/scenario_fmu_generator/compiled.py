@@ -0,0 +1,53 @@
+"""
+Scenario compiled into the shared library: a C++ source holding the binary scenario as constant words.
+
+Built with `-DSCENARIO_COMPILED_SOURCE=<file>`, the library evaluates the points in place in its read only
+data when scenario_input is the text the source was written for, without parsing. Requires the `_native`
+extension, built with `-DSCENARIO_BUILD_PYTHON=ON`, which serializes the scenario. The symbols mirror compiled.hpp.
+"""
+
+import struct
+
+_FNV_PRIME = 0x100000001B3
+_MASK = (1 << 64) - 1
+
+
+def _fnv1a(data: bytes, value: int) -> int:
+    for c in data:
+        value = ((value ^ c) * _FNV_PRIME) & _MASK
+    return value
+
+
+def compiled_key(text: str, binary: bytes) -> tuple[int, int]:
+    """shared_key of shared_store.hpp for the text without settings, the version is the one of the binary"""
+    content = text.encode("utf-8")
+    version = binary[8:12]
+    return (
+        _fnv1a(version, _fnv1a(content, 0xCBF29CE484222325)),
+        _fnv1a(version, _fnv1a(content, 0x84222325CBF29CE4)),
+    )
+
+
+def compiled_source(text: str) -> str:
+    """C++ source of the scenario text, for the platform building the library"""
+    from . import _native
+
+    binary = _native.parse(text).to_binary()
+    padded = binary + bytes(-len(binary) % 8)
+    words = struct.unpack(f"={len(padded) // 8}Q", padded)
+    key = compiled_key(text, binary)
+
+    lines = [
+        "// Scenario compiled into the library, written by scenario-fmu-package --compiled-source",
+        "#include <cstdint>",
+        "",
+        'extern "C"',
+        "{",
+        f"    extern constexpr uint64_t compiled_scenario_key[2] = {{0x{key[0]:016x}ull, 0x{key[1]:016x}ull}};",
+        f"    extern constexpr uint64_t compiled_scenario_size = {len(binary)};",
+        f"    extern constexpr uint64_t compiled_scenario_words[{len(words)}] = {{",
+    ]
+    for start in range(0, len(words), 4):
+        lines.append("        " + " ".join(f"0x{w:016x}ull," for w in words[start : start + 4]))
+    lines += ["    };", "}", ""]
+    return "\n".join(lines)
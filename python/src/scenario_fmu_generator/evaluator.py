@@ -0,0 +1,87 @@
+"""
+Vectorized evaluation of scenario series, backed by the same C++ code as the FMU.
+
+Requires numpy and the `_native` extension, built with `-DSCENARIO_BUILD_PYTHON=ON`.
+"""
+
+from pathlib import Path
+
+import numpy as np
+
+from . import _native
+
+
+class ScenarioEvaluator:
+    """
+    Parsed scenario, evaluates whole time arrays in one native call.
+
+    evaluator = ScenarioEvaluator.from_string("var1; L; 0,0; 10,5")
+    values = evaluator.evaluate("var1", np.linspace(0, 10, 101))
+    """
+
+    def __init__(self, scenario):
+        self._scenario = scenario
+        self._series = scenario.series()
+        self._index = {name: i for i, (name, _, _) in enumerate(self._series)}
+
+    @staticmethod
+    def from_string(string: str, threads: int = 1):
+        return ScenarioEvaluator(_native.parse(string, threads))
+
+    @staticmethod
+    def from_binary(data: bytes):
+        return ScenarioEvaluator(_native.load(data))
+
+    @staticmethod
+    def from_file(path):
+        data = Path(path).read_bytes()
+        if data.startswith(b"SCENARIO"):
+            return ScenarioEvaluator.from_binary(data)
+        return ScenarioEvaluator.from_string(data.decode("utf-8"))
+
+    def to_binary(self) -> bytes:
+        return self._scenario.to_binary()
+
+    @property
+    def names(self) -> list[str]:
+        return [name for name, _, _ in self._series]
+
+    def interpolation(self, series) -> str:
+        return self._series[self._resolve(series)][1]
+
+    def type(self, series) -> str:
+        return self._series[self._resolve(series)][2]
+
+    def evaluate(self, series, times, out=None, second=None) -> np.ndarray:
+        """
+        Values of a series (name or index) at every time, Integer and Boolean series as floats.
+        Series indexed by an input take its values as times, maps also the values of their
+        second input in `second`.
+        """
+        times, out = self._prepare(times, out)
+        self._scenario.evaluate_into(self._resolve(series), times, out, *self._second(second, times))
+        return out
+
+    def derivative(self, series, times, out=None, second=None) -> np.ndarray:
+        """First derivative of a series (name or index) at every time, of a map over its first input"""
+        times, out = self._prepare(times, out)
+        self._scenario.derivative_into(self._resolve(series), times, out, *self._second(second, times))
+        return out
+
+    def _resolve(self, series) -> int:
+        if isinstance(series, str):
+            return self._index[series]
+        return int(series)
+
+    @staticmethod
+    def _second(second, times) -> tuple:
+        if second is None:
+            return ()
+        return (np.ascontiguousarray(np.broadcast_to(second, times.shape), dtype=np.float64),)
+
+    @staticmethod
+    def _prepare(times, out):
+        times = np.ascontiguousarray(times, dtype=np.float64)
+        if out is None:
+            out = np.empty_like(times)
+        return times, out
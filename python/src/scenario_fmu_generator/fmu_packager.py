@@ -8,17 +8,34 @@ from zipfile import ZipFile, ZIP_DEFLATED
 
 
 from . import __version__
-from .model_description import generate_model_description
-from .utils import detect_platform_folder, lib_name_for, packaged_library_path
+from .compiled import compiled_source
+from .library import LIBRARY_FILE, build_library
+from .model_description import generate_model_description, generate_model_description_fmi3
+from .utils import (
+    detect_platform_folder,
+    detect_platform_tuple,
+    fmi3_lib_name_for,
+    lib_name_for,
+    packaged_library_path,
+)
 from .variable import Variable, Variables
 
 
+# Supported FMI versions, 3.0 packages the scenario3 library
+FMI_VERSIONS = ("2.0", "3.0")
+
+
 class ScenarioFmuPackager:
-    def __init__(self, model_id: str, model_name: str, guid: str):
+    def __init__(self, model_id: str, model_name: str, guid: str, fmi_version: str = "2.0"):
+        if fmi_version not in FMI_VERSIONS:
+            raise ValueError(f"Unsupported FMI version {fmi_version}, expected one of {FMI_VERSIONS}")
         self.model_id = model_id
         self.model_name = model_name
         self.guid = guid or str(uuid.uuid4())
         self.version = __version__
+        self.fmi_version = fmi_version
+        self.options = {}
+        self.library: list[str] = []
 
         # Always add local time as first output
         # Default
@@ -41,19 +58,46 @@ class ScenarioFmuPackager:
 
         self.variables += variable
 
+    def add_library_scenario(self, scenario_data: str):
+        """Scenario of the packaged library, selected by scenario_index in the order added.
+        The outputs are all series of the library, replacing the ones added before"""
+        self.library.append(scenario_data)
+
+    def set_option(self, name: str, value):
+        self.options[name] = value
+
+    def write_compiled_source(self, path: str):
+        """C++ source of the scenario_input start value, built into the library with
+        -DSCENARIO_COMPILED_SOURCE=<path> to evaluate it without parsing"""
+        if self.library:
+            raise ValueError("A scenario library can not be compiled into the shared library")
+        source = Path(path)
+        source.parent.mkdir(parents=True, exist_ok=True)
+        source.write_text(compiled_source(Variables.to_string(self.variables)), encoding="utf-8")
+        print(f"Wrote compiled scenario: {source}")
+
     def build(self, output_: str):
         output = Path(output_)
 
         print("Locate shared library")
-        lib_src = packaged_library_path(self.model_id)
+        fmi3 = self.fmi_version == "3.0"
+        lib_src = packaged_library_path("scenario3" if fmi3 else self.model_id)
         if lib_src.exists():
             print(f"- Using packaged library: {lib_src}")
         else:
             print(f"error: shared library not found. Tried {lib_src}", file=sys.stderr)
             return 2
 
-        md = generate_model_description(
-            self.model_name, self.model_id, self.guid, self.variables, self.version
+        library = None
+        if self.library:
+            print(f"Build library of {len(self.library)} scenarios")
+            self.variables, library = build_library(self.library)
+            self.use_default = False
+            self.options.setdefault("scenario_index", 0)
+
+        generate = generate_model_description_fmi3 if fmi3 else generate_model_description
+        md = generate(
+            self.model_name, self.model_id, self.guid, self.variables, self.version, self.options
         )
 
         print("Generate fmu structure and content")
@@ -63,27 +107,34 @@ class ScenarioFmuPackager:
             (tmp / "modelDescription.xml").write_bytes(md)
 
             print("- Place binaries")
-            platform_folder = detect_platform_folder()
+            platform_folder = detect_platform_tuple() if fmi3 else detect_platform_folder()
             bin_dir = tmp / "binaries" / platform_folder
             bin_dir.mkdir(parents=True, exist_ok=True)
-            lib_target_name = lib_name_for(self.model_id)
+            lib_target_name = fmi3_lib_name_for(self.model_id) if fmi3 else lib_name_for(self.model_id)
             shutil.copy2(lib_src, bin_dir / lib_target_name)
 
+            if library is not None:
+                print("- Write scenario library")
+                (tmp / "resources").mkdir()
+                (tmp / "resources" / LIBRARY_FILE).write_bytes(library)
+
             print("- Pack zip")
             output.parent.mkdir(parents=True, exist_ok=True)
             with ZipFile(output, "w", compression=ZIP_DEFLATED) as zf:
                 print("-- Add modelDescription.xml")
                 zf.write(tmp / "modelDescription.xml", arcname="modelDescription.xml")
-                print("-- Add binaries")
-                for root, _dirs, files in os.walk(tmp / "binaries"):
-                    for f in files:
-                        p = Path(root) / f
-                        arc = p.relative_to(tmp)
-                        zf.write(p, arcname=str(arc))
+                print("-- Add binaries and resources")
+                for folder in ("binaries", "resources"):
+                    for root, _dirs, files in os.walk(tmp / folder):
+                        for f in files:
+                            p = Path(root) / f
+                            arc = p.relative_to(tmp)
+                            zf.write(p, arcname=str(arc))
 
         print(f"Created FMU: {output}")
         print(f"  modelIdentifier: {self.model_id}")
         print(f"  modelName:      {self.model_name}")
+        print(f"  fmiVersion:     {self.fmi_version}")
         print(f"  guid:           {self.guid}")
         print(f"  outputs:        {len(self.variables)}")
         if output.exists():
@@ -0,0 +1,94 @@
+"""
+Library of pre-parsed scenarios packaged in resources/scenarios.bin, the FMU selects one by scenario_index.
+
+Requires the `_native` extension, built with `-DSCENARIO_BUILD_PYTHON=ON`, which serializes the scenarios.
+The layout mirrors library.hpp.
+"""
+
+import struct
+
+from .variable import Variable, Variables
+
+LIBRARY_MAGIC = b"SCENLIB1"
+LIBRARY_FILE = "scenarios.bin"
+
+
+def _rows(scenario: str) -> list[str]:
+    return [row for row in scenario.split("\n") if row.strip()]
+
+
+def _align8(n: int) -> int:
+    return (n + 7) & ~7
+
+
+def _is_layout_modifier(modifier: str) -> bool:
+    """Modifiers deciding the outputs and inputs of a series, the same in every scenario of a library"""
+    return modifier in ("Integer", "Boolean") or modifier == "Integral" or modifier.startswith(("Window(", "Input(", "Map("))
+
+
+def _layout_modifiers(var: Variable) -> list[str]:
+    """Layout modifiers of a series in a comparable form, window lengths may differ as the outputs are the same"""
+    return sorted("Window" if m.startswith("Window(") else m for m in var.modifiers if _is_layout_modifier(m))
+
+
+def library_layout(scenarios: list[str]) -> list[Variable]:
+    """Outputs of a library: every series in order of first appearance, with the points of that first scenario.
+    Raises ValueError if a series has another type, Integral, Window, Input or Map modifier in another scenario."""
+    layout: dict[str, Variable] = {}
+    for scenario in scenarios:
+        for var in Variables.from_string("\n".join(_rows(scenario))):
+            known = layout.get(var.name)
+            if known is None:
+                layout[var.name] = var
+            elif known.type != var.type:
+                raise ValueError(f"Series {var.name} is {known.type} in one scenario and {var.type} in another")
+            elif _layout_modifiers(known) != _layout_modifiers(var):
+                raise ValueError(
+                    f"Series {var.name} has the modifiers {';'.join(known.modifiers)} in one scenario"
+                    f" and {';'.join(var.modifiers)} in another"
+                )
+    return list(layout.values())
+
+
+def _placeholder(var: Variable) -> Variable:
+    """Series without points with the outputs and inputs of `var`, outputs 0"""
+    modifiers = [m for m in var.modifiers if _is_layout_modifier(m)]
+    placeholder = Variable(var.name, var.interpolation, [], modifiers)
+    if var.map is not None:
+        # A map needs two points per axis
+        placeholder.map = ([0.0, 1.0], [0.0, 1.0], [[0.0, 0.0], [0.0, 0.0]])
+    return placeholder
+
+
+def _aligned(scenario: str, layout: list[Variable]) -> str:
+    """Scenario text with the series in output order, series it lacks have no points and output 0"""
+    by_name = {row.split(";")[0].strip(): row for row in _rows(scenario)}
+    rows = []
+    for var in layout:
+        row = by_name.get(var.name)
+        if row is None:
+            row = _placeholder(var).to_str()
+        rows.append(row)
+    return "\n".join(rows)
+
+
+def build_library(scenarios: list[str]) -> tuple[list[Variable], bytes]:
+    """Outputs and content of scenarios.bin for scenario texts, in scenario_index order"""
+    from . import _native
+
+    layout = library_layout(scenarios)
+    binaries = [_native.parse(_aligned(scenario, layout)).to_binary() for scenario in scenarios]
+
+    # LibraryHeader, LibraryEntry[count], binary scenarios
+    entries = []
+    offset = _align8(24 + 16 * len(binaries))
+    for binary in binaries:
+        entries.append((offset, len(binary)))
+        offset = _align8(offset + len(binary))
+
+    out = bytearray(offset)
+    struct.pack_into("<8sIIQ", out, 0, LIBRARY_MAGIC, len(binaries), 0, offset)
+    for i, ((start, size), binary) in enumerate(zip(entries, binaries)):
+        struct.pack_into("<QQ", out, 24 + 16 * i, start, size)
+        out[start : start + size] = binary
+    return layout, bytes(out)
@@ -1,10 +1,96 @@
 from .variable import Variable, Variables
 import xml.etree.ElementTree as ET
 
+# Configuration parameters, value references mirror the reserved range in scenario_fmu_interface.cpp
+OPTION_VR_BASE = 0x40000000
+OPTIONS = [
+    # name, type, value reference, default
+    ("compress_series", "Boolean", OPTION_VR_BASE + 0, False),
+    ("simplify_series", "Boolean", OPTION_VR_BASE + 1, False),
+    ("parse_threads", "Integer", OPTION_VR_BASE + 2, 0),
+    ("lazy_parse", "Boolean", OPTION_VR_BASE + 3, False),
+    ("shared_memory", "Boolean", OPTION_VR_BASE + 4, False),
+    ("float32_values", "Boolean", OPTION_VR_BASE + 5, False),
+    ("float32_bound", "Real", OPTION_VR_BASE + 6, 0.0),
+    ("event_calendar", "Boolean", OPTION_VR_BASE + 7, False),
+    ("scenario_gain", "Real", OPTION_VR_BASE + 8, 1.0),
+    ("scenario_offset", "Real", OPTION_VR_BASE + 9, 0.0),
+    ("scenario_time_shift", "Real", OPTION_VR_BASE + 10, 0.0),
+    ("scenario_time_scale", "Real", OPTION_VR_BASE + 11, 1.0),
+    ("scenario_index", "Integer", OPTION_VR_BASE + 12, -1),
+    ("time_resolution", "Real", OPTION_VR_BASE + 13, 0.0),
+    ("realtime", "Boolean", OPTION_VR_BASE + 14, False),
+]
+
+# Transform of one series, four value references per output in output order
+SERIES_TRANSFORM_VR_BASE = 0x30000000
+TRANSFORM_FIELDS = [("gain", 1.0), ("offset", 0.0), ("time_shift", 0.0), ("time_scale", 1.0)]
+
+
+def series_transform_parameters(variables: list[Variable], options: dict) -> list[tuple]:
+    """Parameters `<series>.<field>` of the per series transforms, as OPTIONS entries.
+    All of them with the series_transforms option, otherwise only those given a value in `options`"""
+    everything = options.get("series_transforms", False)
+    parameters = []
+    for i, var in enumerate(variables):
+        for f, (field, default) in enumerate(TRANSFORM_FIELDS):
+            name = f"{var.name}.{field}"
+            if everything or name in options:
+                parameters.append((name, "Real", SERIES_TRANSFORM_VR_BASE + 4 * i + f, default))
+    return parameters
+
+
+# Integral of a series with the Integral modifier, one value reference per output in output order
+INTEGRAL_VR_BASE = 0x10000000
+# Moving minimum, maximum and mean of a series with the Window modifier, three per output in output order
+WINDOW_VR_BASE = 0x11000000
+WINDOW_STATS = ["min", "max", "mean"]
+
+
+def derived_outputs(variables: list[Variable]) -> list[tuple[str, int]]:
+    """Real outputs computed from a series, with their value references:
+    `<series>_integral` for the Integral modifier, `<series>_min`, `_max` and `_mean` for Window(length)"""
+    outputs = []
+    for i, var in enumerate(variables):
+        if var.type != "Real":
+            continue
+        if "Integral" in var.modifiers:
+            outputs.append((f"{var.name}_integral", INTEGRAL_VR_BASE + i))
+        if any(m.startswith("Window(") for m in var.modifiers):
+            outputs += [(f"{var.name}_{stat}", WINDOW_VR_BASE + 3 * i + k) for k, stat in enumerate(WINDOW_STATS)]
+    return outputs
+
+
+# Real inputs of the Input modifiers, in order of first use
+INPUT_VR_BASE = 0x12000000
+
+
+def model_inputs(variables: list[Variable]) -> list[tuple[str, int]]:
+    """Inputs series and maps are indexed by instead of time, with their value references"""
+    names = []
+    for var in variables:
+        for name in var.inputs:
+            if name not in names:
+                names.append(name)
+    return [(name, INPUT_VR_BASE + k) for k, name in enumerate(names)]
+
+
+def _start_value(value) -> str:
+    if isinstance(value, bool):
+        return "true" if value else "false"
+    return str(value)
+
 
 def generate_model_description(
-    model_name: str, model_id: str, guid: str, variables: list[Variable], version: str
+    model_name: str,
+    model_id: str,
+    guid: str,
+    variables: list[Variable],
+    version: str,
+    options: dict = None,
 ) -> bytes:
+    options = options or {}
+
     root = ET.Element(
         "fmiModelDescription",
         attrib={
@@ -29,7 +115,7 @@ def generate_model_description(
             "needsExecutionTool": "false",
             "canBeInstantiatedOnlyOncePerProcess": "false",
             "canNotUseMemoryManagementFunctions": "true",
-            "providesDirectionalDerivative": "false",
+            "providesDirectionalDerivative": "true",
             "maxOutputDerivativeOrder":"1"
         },
     )
@@ -64,11 +150,51 @@ def generate_model_description(
                 "causality": "output",
             },
         )
+        ET.SubElement(svi, var.type)
+
+    derived = derived_outputs(variables)
+    for name, vr in derived:
+        svi = ET.SubElement(
+            mvars,
+            "ScalarVariable",
+            attrib={
+                "name": name,
+                "valueReference": str(vr),
+                "causality": "output",
+            },
+        )
         ET.SubElement(svi, "Real")
 
+    for name, vr in model_inputs(variables):
+        svi = ET.SubElement(
+            mvars,
+            "ScalarVariable",
+            attrib={
+                "name": name,
+                "valueReference": str(vr),
+                "causality": "input",
+                "variability": "continuous",
+            },
+        )
+        ET.SubElement(svi, "Real", attrib={"start": "0.0"})
+
+    # Inputs and options are placed after the outputs to keep the output indices below unchanged
+    for name, type_, vr, default in OPTIONS + series_transform_parameters(variables, options):
+        svo = ET.SubElement(
+            mvars,
+            "ScalarVariable",
+            attrib={
+                "name": name,
+                "valueReference": str(vr),
+                "causality": "parameter",
+                "variability": "fixed",
+            },
+        )
+        ET.SubElement(svo, type_, attrib={"start": _start_value(options.get(name, default))})
+
     mstr = ET.SubElement(root, "ModelStructure")
     outs = ET.SubElement(mstr, "Outputs")
-    for i in range(len(variables)):
+    for i in range(len(variables) + len(derived)):
         index = 2 + i  # 1-based index into ModelVariables list
         ET.SubElement(outs, "Unknown", attrib={"index": str(index)})
     # Dymola fails if this is present...
@@ -80,3 +206,178 @@ def generate_model_description(
     tree = ET.ElementTree(root)
     ET.indent(tree, space="\t", level=0)
     return ET.tostring(root, encoding="utf-8", xml_declaration=True)
+
+
+# FMI 3.0 arrays of all outputs per type and the change clock, mirror scenario_fmu3_interface.cpp
+ARRAY_VR_BASE = 0x20000000
+FMI3_ARRAYS = [
+    # name, FMI 2.0 type of the elements, FMI 3.0 type, value reference
+    ("scenario_real", "Real", "Float64", ARRAY_VR_BASE + 0),
+    ("scenario_integer", "Integer", "Int32", ARRAY_VR_BASE + 1),
+    ("scenario_boolean", "Boolean", "Boolean", ARRAY_VR_BASE + 2),
+]
+CHANGE_CLOCK_VR = ARRAY_VR_BASE + 3
+
+FMI3_TYPES = {"Real": "Float64", "Integer": "Int32", "Boolean": "Boolean"}
+
+
+def _piecewise_constant(var: Variable) -> bool:
+    """Outputs only changing at their points in time, these tick the change clock"""
+    return not var.inputs and (var.type != "Real" or (var.interpolation == "ZOH" and not var.shapes))
+
+
+def generate_model_description_fmi3(
+    model_name: str,
+    model_id: str,
+    guid: str,
+    variables: list[Variable],
+    version: str,
+    options: dict = None,
+) -> bytes:
+    options = options or {}
+
+    root = ET.Element(
+        "fmiModelDescription",
+        attrib={
+            "fmiVersion": "3.0",
+            "modelName": model_name,
+            "instantiationToken": guid,
+            "author": "scenario_fmu",
+            "version": version,
+            "generationTool": "scenario_fmu",
+            "variableNamingConvention": "structured",
+        },
+    )
+
+    ET.SubElement(
+        root,
+        "CoSimulation",
+        attrib={
+            "modelIdentifier": model_id,
+            "canHandleVariableCommunicationStepSize": "true",
+            "needsExecutionTool": "false",
+            "canBeInstantiatedOnlyOncePerProcess": "false",
+            "providesDirectionalDerivatives": "true",
+            "maxOutputDerivativeOrder": "1",
+            "hasEventMode": "true",
+            "mightReturnEarlyFromDoStep": "true",
+        },
+    )
+
+    log_categories = ET.SubElement(root, "LogCategories")
+    for name in ("logStatusInfo", "logStatusError"):
+        ET.SubElement(log_categories, "Category", attrib={"name": name})
+
+    ET.SubElement(
+        root,
+        "DefaultExperiment",
+        attrib={"startTime": "0.0", "stopTime": "10.0", "tolerance": "0.0001"},
+    )
+
+    mvars = ET.SubElement(root, "ModelVariables")
+    outputs = []
+
+    sv0 = ET.SubElement(
+        mvars,
+        "String",
+        attrib={
+            "name": "scenario_input",
+            "valueReference": "0",
+            "causality": "parameter",
+            "variability": "tunable",
+        },
+    )
+    ET.SubElement(sv0, "Start", attrib={"value": Variables.to_string(variables)})
+
+    for i, var in enumerate(variables):
+        ET.SubElement(
+            mvars,
+            FMI3_TYPES[var.type],
+            attrib={
+                "name": f"{var.name}",
+                "valueReference": str(i + 1),
+                "causality": "output",
+                "variability": "discrete" if _piecewise_constant(var) else "continuous",
+            },
+        )
+        outputs.append(i + 1)
+
+    for name, vr in derived_outputs(variables):
+        ET.SubElement(
+            mvars,
+            "Float64",
+            attrib={
+                "name": name,
+                "valueReference": str(vr),
+                "causality": "output",
+                "variability": "continuous",
+            },
+        )
+        outputs.append(vr)
+
+    # Every output of a type as one array, fetched into contiguous memory in one call
+    for name, type_, type3, vr in FMI3_ARRAYS:
+        members = [var for var in variables if var.type == type_]
+        if not members:
+            continue
+        continuous = any(not _piecewise_constant(var) for var in members)
+        sva = ET.SubElement(
+            mvars,
+            type3,
+            attrib={
+                "name": name,
+                "valueReference": str(vr),
+                "causality": "output",
+                "variability": "continuous" if continuous else "discrete",
+            },
+        )
+        ET.SubElement(sva, "Dimension", attrib={"start": str(len(members))})
+        outputs.append(vr)
+
+    if any(_piecewise_constant(var) for var in variables):
+        ET.SubElement(
+            mvars,
+            "Clock",
+            attrib={
+                "name": "scenario_change",
+                "valueReference": str(CHANGE_CLOCK_VR),
+                "causality": "output",
+                "variability": "discrete",
+                "intervalVariability": "triggered",
+            },
+        )
+        outputs.append(CHANGE_CLOCK_VR)
+
+    for name, vr in model_inputs(variables):
+        ET.SubElement(
+            mvars,
+            "Float64",
+            attrib={
+                "name": name,
+                "valueReference": str(vr),
+                "causality": "input",
+                "variability": "continuous",
+                "start": "0.0",
+            },
+        )
+
+    for name, type_, vr, default in OPTIONS + series_transform_parameters(variables, options):
+        ET.SubElement(
+            mvars,
+            FMI3_TYPES[type_],
+            attrib={
+                "name": name,
+                "valueReference": str(vr),
+                "causality": "parameter",
+                "variability": "fixed",
+                "start": _start_value(options.get(name, default)),
+            },
+        )
+
+    mstr = ET.SubElement(root, "ModelStructure")
+    for vr in outputs:
+        ET.SubElement(mstr, "Output", attrib={"valueReference": str(vr)})
+
+    tree = ET.ElementTree(root)
+    ET.indent(tree, space="\t", level=0)
+    return ET.tostring(root, encoding="utf-8", xml_declaration=True)
@@ -39,6 +39,22 @@ class ParameterSetBuilder:
     def add_boolean(self, name: str, value: str = "false") -> "ParameterSetBuilder":
         return self.add_(name, "Boolean", str(value))
 
+    def add_transform(
+        self,
+        series: Optional[str] = None,
+        gain: Optional[float] = None,
+        offset: Optional[float] = None,
+        time_shift: Optional[float] = None,
+        time_scale: Optional[float] = None,
+    ) -> "ParameterSetBuilder":
+        """Transform of one series, or of the whole scenario without `series`. Only given fields are added,
+        a variant of a scenario is then a few numbers instead of a copy of scenario_input"""
+        fields = {"gain": gain, "offset": offset, "time_shift": time_shift, "time_scale": time_scale}
+        for field, value in fields.items():
+            if value is not None:
+                self.add_real(f"{series}.{field}" if series else f"scenario_{field}", repr(float(value)))
+        return self
+
     def extend(self, items: Iterable[Parameter]) -> "ParameterSetBuilder":
         for p in items:
             self.add_(p.name, p.type, p.value)
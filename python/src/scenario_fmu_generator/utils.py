@@ -31,3 +31,24 @@ def packaged_library_path(model_id: str) -> Path:
     """Path to the library shipped inside this package for current platform."""
     plat = detect_platform_folder()
     return Path(__file__).resolve().parent / "_binaries" / plat / lib_name_for(model_id)
+
+
+def detect_platform_tuple() -> str:
+    """FMI 3.0 binaries folder, <arch>-<os>"""
+    sysplat = sys.platform
+    machine = platform.machine().lower()
+    arch = {"amd64": "x86_64", "arm64": "aarch64", "i386": "x86", "i686": "x86"}.get(machine, machine)
+    if sysplat == "darwin":
+        return f"{arch}-darwin"
+    if sysplat in ("win32", "cygwin", "win64"):
+        return f"{arch}-windows"
+    return f"{arch}-linux"
+
+
+def fmi3_lib_name_for(model_id: str) -> str:
+    sysplat = sys.platform
+    if sysplat == "darwin":
+        return f"{model_id}.dylib"
+    if sysplat in ("win32", "cygwin", "win64"):
+        return f"{model_id}.dll"
+    return f"{model_id}.so"
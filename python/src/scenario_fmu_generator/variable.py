@@ -1,39 +1,201 @@
+import math
 
 
 class Variable:
     """
-    name;interpolation_method;time_0,var_1.0;t1,var_1.2\nname,inter....
+    name;interpolation_method;[modifier;...]time_0,var_1.0;t1,var_1.2\nname,inter....
+
+    Modifiers start with a letter, e.g. the FMI type of the output: Real (default), Integer or Boolean
+    and what happens after the last point: Hold (default), Zero or Repeat.
+    Float32 or Float32(bound) stores the values of a Real series as float32
+    Input(name) indexes the points of a Real series by the Real input `name` instead of time, a characteristic curve
+    Map(x,y) turns a Real series into a table over the Real inputs `x` and `y`, kept in `map` instead of points:
+    the first axis, the second axis, then one row per point of the first axis, e.g. `torque;C;Map(speed,load);1000,2000;0,1;10,20;15,25`
+    Integral adds the output `<name>_integral`, the time integral of a Real series from its first point
+    Window(length) adds `<name>_min`, `<name>_max` and `<name>_mean` over the last `length` seconds, not for series with chirp segments
+    Noise(sigma,step[,seed]) and BandNoise(sigma,step[,seed]) add reproducible noise generated while evaluating
+
+    Segment shapes between two points replace the interpolation of that segment:
+    ramp, step, sin(amp,freq[,phase]), chirp(amp,f0,f1) or hermite(d0,d1), kept in `shapes` by the index of the first point
     """
 
-    def __init__(self, name, interpolation, series):
+    TYPES = ("Real", "Integer", "Boolean")
+
+    def __init__(self, name, interpolation, series, modifiers=None, shapes=None):
         self.name = name
         self.interpolation = interpolation
         self.series: list[list[float, float]] = series
+        self.modifiers: list[str] = list(modifiers or [])
+        self.shapes: dict[int, str] = dict(shapes or {})
+        # Axes and rows of a series with the Map modifier
+        self.map: tuple[list[float], list[float], list[list[float]]] | None = None
+
+    @staticmethod
+    def lookup_map(name, inputs: tuple[str, str], x: list[float], y: list[float], z: list[list[float]], interpolation="L", modifiers=None):
+        """Table of z[i][j] at (x[i], y[j]), interpolation L is bilinear and C bicubic"""
+        if len(z) != len(x) or any(len(row) != len(y) for row in z):
+            raise ValueError(f"Map {name} needs one row of {len(y)} values per point of the first axis")
+        var = Variable(name, interpolation, [], [f"Map({inputs[0]},{inputs[1]})"] + list(modifiers or []))
+        var.map = (list(x), list(y), [list(row) for row in z])
+        return var
+
+    @property
+    def input(self) -> str | None:
+        """Input of the Input modifier, None for series indexed by time"""
+        for m in self.modifiers:
+            if m.startswith("Input(") and m.endswith(")"):
+                return m[6:-1].strip()
+        return None
+
+    @property
+    def inputs(self) -> list[str]:
+        """Inputs of the Input or Map modifier, empty for series indexed by time"""
+        for m in self.modifiers:
+            if m.startswith("Map(") and m.endswith(")"):
+                return [x.strip() for x in m[4:-1].split(",")]
+        return [self.input] if self.input is not None else []
+
+    @property
+    def type(self) -> str:
+        for m in self.modifiers:
+            if m in Variable.TYPES:
+                return m
+        return "Real"
 
     def start_value(self):
+        if self.map is not None:
+            return self.map[2][0][0]
         return self.series[0][1]
 
     @staticmethod
     def from_str(string: str):
-        parts = string.split(";")
-        coordinates = parts[2:]
+        parts = [x.strip() for x in string.split(";")]
+        fields = parts[2:]
+
+        modifiers = []
+        while fields and fields[0][:1].isalpha():
+            modifiers.append(fields.pop(0))
 
         def f(s: str):
-            return [float(x.strip()) for x in s.split(",")]
+            x, y = s.split(",")
+            y = {"true": "1", "false": "0"}.get(y.strip(), y)
+            return [float(x), float(y)]
+
+        if any(m.startswith("Map(") for m in modifiers):
+            rows = [[float(v) for v in x.split(",")] for x in fields if x]
+            var = Variable(parts[0], parts[1], [], modifiers)
+            var.map = (rows[0], rows[1], rows[2:])
+            return var
 
-        coordinates = [f(x) for x in coordinates]
-        return Variable(parts[0], parts[1], coordinates)
+        coordinates = []
+        shapes = {}
+        for x in fields:
+            if x[:1].isalpha():
+                shapes[len(coordinates) - 1] = x
+            else:
+                coordinates.append(f(x))
+        return Variable(parts[0], parts[1], coordinates, modifiers, shapes)
 
     def to_str(self):
-        values = ";".join([f"{x[0]},{x[1]}" for x in self.series])
-        return f"{self.name};{self.interpolation};{values}"
+        fields = list(self.modifiers)
+        if self.map is not None:
+            fields += [",".join(str(v) for v in row) for row in [self.map[0], self.map[1]] + self.map[2]]
+        elif self.type == "Real":
+            for i, x in enumerate(self.series):
+                if i - 1 in self.shapes:
+                    fields.append(self.shapes[i - 1])
+                fields.append(f"{x[0]},{x[1]}")
+        else:
+            fields += [f"{x[0]},{int(x[1])}" for x in self.series]
+        return ";".join([self.name, self.interpolation] + fields)
 
 
 class Variables:
     @staticmethod
     def from_string(string: str):
+        if string.lstrip().startswith("["):
+            return Variables.from_records(string)
         return [Variable.from_str(x) for x in string.split("\n")]
 
+    @staticmethod
+    def from_records(string: str, tolerance: float = 1e-9):
+        """
+        Record form [[t;v;d;l][t;v;d;l]...][[...]...], one group per series named var1, var2, ...
+
+        Record [t;v;d;l] starts a hermite segment of length l at t with value v and slope d, ending in the
+        value and slope of the next record, the last one continues with its slope. Same points and the
+        same errors as parser.hpp: raises ValueError for a record without four finite numbers, a negative
+        length, decreasing times, a record overlapping the next one, an unterminated record or group and
+        text outside the groups.
+        """
+        variables = []
+        pos = 0
+
+        def skip_space():
+            nonlocal pos
+            while pos < len(string) and string[pos].isspace():
+                pos += 1
+
+        def expect(c: str, where: str):
+            nonlocal pos
+            skip_space()
+            if pos >= len(string) or string[pos] != c:
+                raise ValueError(f"Expected '{c}' {where}")
+            pos += 1
+
+        skip_space()
+        while pos < len(string):
+            var = Variable(f"var{len(variables) + 1}", "L", [])
+            expect("[", f"at the start of series {var.name}")
+
+            records = []
+            skip_space()
+            while pos < len(string) and string[pos] == "[":
+                end = string.find("]", pos)
+                if end < 0:
+                    raise ValueError(f"Unterminated record in series {var.name}")
+                text = string[pos + 1 : end]
+                fields = text.split(";")
+                if len(fields) != 4:
+                    raise ValueError(f"Record [{text}] of series {var.name} needs time, value, derivative and length")
+                try:
+                    record = [float(x) for x in fields]
+                except ValueError:
+                    raise ValueError(f"Record [{text}] of series {var.name} holds a value that is not a number") from None
+                if not all(math.isfinite(x) for x in record):
+                    raise ValueError(f"Record values of series {var.name} must be finite")
+                if record[3] < 0.0 or (records and record[0] < records[-1][0]):
+                    raise ValueError(f"Records of series {var.name} need a length of at least 0 and increasing times")
+                records.append(record)
+                pos = end + 1
+                skip_space()
+            expect("]", f"at the end of series {var.name}")
+
+            def point(time, value):
+                if not var.series or var.series[-1] != [time, value]:
+                    var.series.append([time, value])
+
+            for k, (t, v, d, length) in enumerate(records):
+                last = k + 1 == len(records)
+                point(t, v)
+                if last and length == 0.0:
+                    break
+                # The next record may start a rounding error before or after the end of this one
+                margin = tolerance * max(length, abs(t))
+                following = t + length if last else records[k + 1][0]
+                if following < t + length - margin:
+                    raise ValueError(f"Record at {t} of series {var.name} overlaps the next one")
+                end = t + length if last or following > t + length + margin else following
+                end_value, end_slope = (v + d * length, d) if last else (records[k + 1][1], records[k + 1][2])
+                if end > t:
+                    var.shapes[len(var.series) - 1] = f"hermite({d},{end_slope})"
+                    var.series.append([end, end_value])
+                else:
+                    point(end, end_value)
+            variables.append(var)
+            skip_space()
+        return variables
+
     @staticmethod
     def to_string(variables: list[Variable]):
-        return "\n".join([x.to_str() for x in variables])
\ No newline at end of file
+        return "\n".join([x.to_str() for x in variables])
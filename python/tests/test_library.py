@@ -0,0 +1,39 @@
+import pytest
+
+from scenario_fmu_generator.library import _aligned, library_layout
+
+
+def test_layout_accepts_matching_modifiers():
+    scenarios = [
+        "speed; L; Integral; Window(2); 0,0; 10,10\ngear; ZOH; Integer; 0,1",
+        "gear; ZOH; Integer; 0,3\nspeed; L; Window(5); Integral; Float32; 0,5; 10,5",
+    ]
+    layout = library_layout(scenarios)
+    assert [var.name for var in layout] == ["speed", "gear"]
+    assert layout[0].modifiers == ["Integral", "Window(2)"]
+
+
+@pytest.mark.parametrize(
+    "other",
+    [
+        "speed; L; 0,0; 10,10",
+        "speed; L; Integral; 0,0; 10,10",
+        "speed; L; Input(load); Window(2); 0,0; 10,10",
+        "speed; L; Map(time,load); 0,1; 0,1; 1,2; 3,4",
+    ],
+)
+def test_layout_rejects_differing_modifiers(other):
+    with pytest.raises(ValueError, match="speed"):
+        library_layout(["speed; L; Input(rpm); Window(2); 0,0; 10,10", other])
+
+
+def test_missing_series_keep_outputs_and_inputs():
+    scenarios = [
+        "a; L; Integral; Window(2); 0,0; 1,1\nb; L; Input(speed); 0,0; 1,1\nt; C; Map(speed,load); 0,1; 0,1; 1,2; 3,4",
+        "c; ZOH; Boolean; 0,1",
+    ]
+    rows = _aligned(scenarios[1], library_layout(scenarios)).split("\n")
+    assert rows[0] == "a;L;Integral;Window(2)"
+    assert rows[1] == "b;L;Input(speed)"
+    assert rows[2].startswith("t;C;Map(speed,load);")
+    assert rows[3] == "c; ZOH; Boolean; 0,1"
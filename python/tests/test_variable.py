@@ -0,0 +1,31 @@
+import pytest
+
+from scenario_fmu_generator.variable import Variables
+
+
+def test_records_become_hermite_segments():
+    variables = Variables.from_records("[[0;0;1;2][2;1;0;1]]\n[[0;5;0;1] [3;2;-1;1]]")
+    assert [var.name for var in variables] == ["var1", "var2"]
+    assert variables[0].series == [[0.0, 0.0], [2.0, 1.0], [3.0, 1.0]]
+    assert variables[1].series == [[0.0, 5.0], [1.0, 2.0], [3.0, 2.0], [4.0, 1.0]]
+
+
+@pytest.mark.parametrize(
+    "records",
+    [
+        "[[0;0;1]]",
+        "[[0;0;1;1;2]]",
+        "[[0;x;1;1]]",
+        "[[0;nan;1;1]]",
+        "[[0;0;1;-1]]",
+        "[[1;0;1;0][0;0;1;1]]",
+        "[[0;0;1;2][1;0;0;1]]",
+        "[[0;0;1;1]",
+        "[[0;0;1;1",
+        "[[0;0;1;1]]x",
+        "x[[0;0;1;1]]",
+    ],
+)
+def test_malformed_records_are_rejected(records):
+    with pytest.raises(ValueError):
+        Variables.from_records(records)
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "scenario.h"
+}
+
+#include "parser.hpp"
+
+namespace
+{
+    const char *scenario = "var1; L; 1,0; 3,0.5; 5,4; 5,6; 9,2\n"
+                           "var2; ZOH; 2,0; 3,0.5; 5,4; 9,2\n"
+                           "var3; NN; 0,0; 1,0.5; 2,4; 3,2\n"
+                           "gear; ZOH; Integer; 0,1; 4,2; 8,-3\n"
+                           "single; L; 2,7";
+
+    std::vector<double> grid(double from, double to, double step)
+    {
+        std::vector<double> times;
+        for (double t = from; t <= to; t += step)
+        {
+            times.push_back(t);
+        }
+        return times;
+    }
+
+    // Every point evaluated on its own, what fmi2GetReal returns at that time
+    std::vector<double> reference(SeriesData sd, const std::vector<double> &times)
+    {
+        std::vector<double> out;
+        for (const double t : times)
+        {
+            out.push_back(sd.type == ValueType::Real ? eval_value_at(sd, t) : eval_discrete_at(sd, t));
+        }
+        return out;
+    }
+
+    // Points shared with the series so breakpoints are hit exactly
+    std::vector<double> with_breakpoints(std::vector<double> times)
+    {
+        for (const double t : {1.0, 2.0, 3.0, 4.0, 5.0, 8.0, 9.0})
+        {
+            times.push_back(t);
+        }
+        std::sort(times.begin(), times.end());
+        return times;
+    }
+}
+
+TEST(Batch, SortedSweepMatchesSingleLookups)
+{
+    auto series = parse_scenario(scenario);
+    const auto times = with_breakpoints(grid(-1.0, 12.0, 0.0625 / 3.0));
+
+    for (auto &sd : series)
+    {
+        const auto expected = reference(sd, times);
+        std::vector<double> out(times.size());
+        eval_batch(sd, times.data(), times.size(), out.data());
+        for (size_t i = 0; i < times.size(); ++i)
+        {
+            ASSERT_EQ(expected[i], out[i]) << sd.name << " at " << times[i];
+        }
+    }
+}
+
+TEST(Batch, CompressedSweepMatchesSingleLookups)
+{
+    SeriesData sd;
+    sd.name = "long";
+    sd.interpolation = Interpolation::Linear;
+    for (size_t i = 0; i < 2000; ++i)
+    {
+        sd.times.push_back(0.5 * static_cast<double>(i));
+        sd.values.push_back(std::sin(0.01 * static_cast<double>(i)));
+    }
+    sd.size = sd.times.size();
+
+    // Denser than the points, and sparse enough to skip whole blocks
+    const auto dense = grid(-3.0, 1100.0, 0.1);
+    const auto sparse = grid(-3.0, 1100.0, 173.3);
+    const auto expected_dense = reference(sd, dense);
+    const auto expected_sparse = reference(sd, sparse);
+
+    compress_series(sd);
+    ASSERT_TRUE(sd.compressed);
+    std::vector<double> out(dense.size());
+    eval_batch(sd, dense.data(), dense.size(), out.data());
+    for (size_t i = 0; i < dense.size(); ++i)
+    {
+        ASSERT_EQ(expected_dense[i], out[i]) << "at " << dense[i];
+    }
+
+    sd.rewind();
+    out.resize(sparse.size());
+    eval_batch(sd, sparse.data(), sparse.size(), out.data());
+    EXPECT_EQ(expected_sparse, out);
+}
+
+TEST(Batch, UnsortedTimes)
+{
+    auto series = parse_scenario(scenario);
+    const std::vector<double> times = {4.0, 1.5, 9.5, 0.0, 3.0, 2.0};
+    const auto expected = reference(series[0], times);
+
+    std::vector<double> out(times.size());
+    eval_batch(series[0], times.data(), times.size(), out.data());
+    EXPECT_EQ(expected, out);
+}
+
+TEST(Batch, ExportedEntryPoint)
+{
+    fmi2CallbackFunctions cbs{};
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+    const fmi2ValueReference vr_in[1] = {0};
+    const fmi2String values[1] = {scenario};
+    fmi2SetString(comp, vr_in, 1, values);
+    fmi2EnterInitializationMode(comp);
+    fmi2ExitInitializationMode(comp);
+
+    const std::vector<double> times = {0.0, 1.0, 2.0, 4.0, 6.0, 10.0};
+    std::vector<double> out(times.size());
+
+    ASSERT_EQ(fmi2OK, scenario_eval_batch(comp, 1, times.data(), times.size(), out.data()));
+    EXPECT_EQ((std::vector<double>{0.0, 0.0, 0.25, 2.25, 5.0, 2.0}), out);
+
+    ASSERT_EQ(fmi2OK, scenario_eval_batch(comp, 4, times.data(), times.size(), out.data()));
+    EXPECT_EQ((std::vector<double>{1.0, 1.0, 1.0, 2.0, 2.0, -3.0}), out);
+
+    // The instance time is untouched
+    fmi2Real value[1];
+    const fmi2ValueReference vr_out[1] = {1};
+    fmi2GetReal(comp, vr_out, 1, value);
+    EXPECT_EQ(0.0, value[0]);
+
+    EXPECT_EQ(fmi2Error, scenario_eval_batch(comp, 42, times.data(), times.size(), out.data()));
+    fmi2FreeInstance(comp);
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "parser.hpp"
+#include "binary.hpp"
+
+namespace
+{
+    const char *scenario = "var1; L; 1,0; 3,0.5; 5,4; 9,2\n"
+                           "gear; ZOH; Integer; 0,1; 4,2; 6,2; 8,-3\n"
+                           "door; ZOH; Boolean; 0,false; 2,true; 7,false\n"
+                           "var3; NN; 0,0; 1,0.5; 2,4; 3,2";
+}
+
+TEST(Binary, RoundTripEvaluatesIdentically)
+{
+    auto parsed = parse_scenario(scenario);
+    const auto bytes = serialize_scenario(parsed);
+    auto loaded = deserialize_scenario(bytes.data(), bytes.size());
+    ASSERT_EQ(parsed.size(), loaded.size());
+
+    for (size_t i = 0; i < parsed.size(); ++i)
+    {
+        EXPECT_EQ(parsed[i].name, loaded[i].name);
+        EXPECT_EQ(parsed[i].interpolation, loaded[i].interpolation);
+        EXPECT_EQ(parsed[i].type, loaded[i].type);
+        EXPECT_EQ(parsed[i].size, loaded[i].size);
+        for (double t = -1.0; t < 11.0; t += 0.25)
+        {
+            if (parsed[i].type == ValueType::Real)
+                EXPECT_EQ(eval_value_at(parsed[i], t), eval_value_at(loaded[i], t));
+            else
+                EXPECT_EQ(eval_discrete_at(parsed[i], t), eval_discrete_at(loaded[i], t));
+        }
+    }
+}
+
+TEST(Binary, LoadsFromUnalignedBuffer)
+{
+    const auto bytes = serialize_scenario(parse_scenario(scenario));
+    std::vector<char> shifted(bytes.size() + 1);
+    std::memcpy(shifted.data() + 1, bytes.data(), bytes.size());
+
+    auto loaded = deserialize_scenario(shifted.data() + 1, bytes.size());
+    ASSERT_EQ(4u, loaded.size());
+    EXPECT_DOUBLE_EQ(0.25, eval_value_at(loaded[0], 2.0));
+}
+
+TEST(Binary, RejectsInvalidData)
+{
+    const auto bytes = serialize_scenario(parse_scenario(scenario));
+    EXPECT_THROW(deserialize_scenario(bytes.data(), 4), std::runtime_error);
+    EXPECT_THROW(deserialize_scenario(bytes.data(), bytes.size() - 8), std::runtime_error);
+
+    auto corrupt = bytes;
+    corrupt[0] = 'X';
+    EXPECT_THROW(deserialize_scenario(corrupt.data(), corrupt.size()), std::runtime_error);
+
+    // Points of the first series pointing past the end
+    corrupt = bytes;
+    const uint64_t far = bytes.size();
+    std::memcpy(corrupt.data() + sizeof(BinaryHeader) + offsetof(SeriesRecord, times_offset), &far, sizeof(far));
+    EXPECT_THROW(deserialize_scenario(corrupt.data(), corrupt.size()), std::runtime_error);
+}
+
+TEST(Binary, RequiresPlainPoints)
+{
+    auto series = index_scenario(scenario);
+    EXPECT_THROW(serialize_scenario(series), std::runtime_error);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Series on different time grids, one with a repeated time
+    const char *scenario = "fast; L; 0,0; 0.1,1; 0.2,0; 0.3,1; 0.4,0; 0.5,1; 0.6,0; 0.7,1\n"
+                           "slow; ZOH; 0,5; 2,6; 4,7\n"
+                           "step; L; 1,0; 3,0.5; 3,4; 9,2\n"
+                           "gear; ZOH; Integer; 0,1; 0.25,2; 0.5,3; 5,4\n"
+                           "single; L; 2,7";
+
+    ScenarioState state(bool calendar)
+    {
+        ScenarioState s;
+        s.set_input(scenario);
+        s.event_calendar = calendar;
+        s.initialize(Log{});
+        return s;
+    }
+
+    std::vector<double> sample(ScenarioState &s)
+    {
+        std::vector<double> out;
+        for (auto &sd : s.series)
+        {
+            out.push_back(sd.type == ValueType::Real ? eval_value_at(sd, s.current_time) : eval_discrete_at(sd, s.current_time));
+        }
+        return out;
+    }
+}
+
+TEST(Calendar, TracksSegmentsWithoutSearching)
+{
+    auto s = state(true);
+    EXPECT_FALSE(s.calendar.empty());
+
+    // The calendar alone moves each series into the segment find_segment would pick
+    for (double t : {-1.0, 0.0, 0.05, 0.1, 0.25, 0.26, 1.0, 2.0, 3.0, 3.5, 4.5, 10.0})
+    {
+        s.set_time(t);
+        for (auto &sd : s.series)
+        {
+            if (sd.size < 3)
+            {
+                continue;
+            }
+            const SeriesView view{sd.times_data(), nullptr, sd.size, 0};
+            EXPECT_EQ(find_segment(view, 0, t), sd.access_index) << sd.name << " at " << t;
+        }
+    }
+}
+
+TEST(Calendar, MatchesPlainStepping)
+{
+    auto with = state(true);
+    auto without = state(false);
+    EXPECT_TRUE(without.calendar.empty());
+
+    for (double t = -0.5; t < 11.0; t += 0.05)
+    {
+        with.set_time(t);
+        without.set_time(t);
+        EXPECT_EQ(sample(without), sample(with)) << t;
+    }
+
+    // Backwards starts over
+    for (double t : {0.3, 5.0, 0.0, 2.0})
+    {
+        with.set_time(t);
+        without.set_time(t);
+        EXPECT_EQ(sample(without), sample(with)) << t;
+    }
+
+    // A reused parse still gets its calendar, a rewind brings it back to the start
+    with.set_time(4.0);
+    with.initialize(Log{});
+    EXPECT_FALSE(with.calendar.empty());
+    for (auto &sd : with.series)
+    {
+        EXPECT_EQ(0u, sd.access_index) << sd.name;
+    }
+    with.set_time(0.35);
+    without.set_time(0.35);
+    EXPECT_EQ(sample(without), sample(with));
+}
+
+TEST(Calendar, SkipsCompressedSeries)
+{
+    // Integer and Boolean series are never compressed
+    ScenarioState s;
+    s.set_input("fast; L; 0,0; 0.1,1; 0.2,0; 0.3,1\nslow; ZOH; 0,5; 2,6; 4,7");
+    s.event_calendar = true;
+    s.compress_series = true;
+    s.initialize(Log{});
+    EXPECT_TRUE(s.calendar.empty());
+    s.set_time(0.25);
+    EXPECT_NEAR(0.5, eval_value_at(s.series[0], s.current_time), 1e-12);
+}
+
+TEST(Calendar, AdvancesToTheQuantizedTime)
+{
+    auto quantized = [](bool calendar)
+    {
+        ScenarioState s;
+        s.set_input(scenario);
+        s.event_calendar = calendar;
+        s.time_resolution = 1e-6;
+        s.initialize(Log{});
+        return s;
+    };
+    auto with = quantized(true);
+    auto without = quantized(false);
+    EXPECT_FALSE(with.calendar.empty());
+
+    // Just around the points at 0.5, 2 and 3, quantized onto them
+    for (double t : {0.5 - 1e-12, 0.5 + 1e-12, 2.0 + 1e-12, 3.0 - 1e-12, 3.0 + 1e-12})
+    {
+        with.set_time(t);
+        without.set_time(t);
+        for (auto &sd : with.series)
+        {
+            if (sd.size < 3)
+            {
+                continue;
+            }
+            const SeriesView view{sd.times_data(), nullptr, sd.size, 0};
+            EXPECT_EQ(find_segment(view, 0, with.current_time), sd.access_index) << sd.name << " at " << t;
+        }
+        EXPECT_EQ(sample(without), sample(with)) << t;
+    }
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const char *scenario = "speed; L; Window(2); 0,0; 10,10\n"
+                           "gear; ZOH; Integer; 0,1; 5,2\n"
+                           "pulse; ZOH; Boolean; 0,0; 2,1";
+
+    // Words of the source compiled.py writes
+    struct Compiled
+    {
+        std::vector<uint64_t> words;
+        CompiledScenario scenario;
+
+        explicit Compiled(const std::string &text)
+        {
+            const auto binary = serialize_scenario(parse_scenario(text));
+            words.resize((binary.size() + 7) / 8);
+            std::memcpy(words.data(), binary.data(), binary.size());
+            const auto key = shared_key(text, "");
+            scenario = {words.data(), binary.size(), {key.name_hash, key.check}};
+        }
+    };
+}
+
+TEST(Compiled, EvaluatedInPlace)
+{
+    const Compiled compiled(scenario);
+    ScenarioState state;
+    state.compiled = &compiled.scenario;
+    state.set_input(scenario);
+    state.simplify_series = true;
+    state.compress_series = true;
+    state.initialize(Log{});
+
+    // Points of the compiled words, parse options do not apply
+    const auto *begin = reinterpret_cast<const char *>(compiled.words.data());
+    const auto *times = reinterpret_cast<const char *>(state.series[0].times_data());
+    EXPECT_TRUE(times >= begin && times < begin + compiled.scenario.size);
+    EXPECT_FALSE(state.series[0].compressed);
+
+    state.set_time(6.0);
+    EXPECT_DOUBLE_EQ(6.0, state.real_value(state.series[0]));
+    EXPECT_DOUBLE_EQ(5.0, state.window_value(state.series[0], WindowStat::Mean));
+    EXPECT_EQ(2, state.discrete_value(state.series[1]));
+    EXPECT_EQ(1, state.discrete_value(state.series[2]));
+}
+
+TEST(Compiled, OtherInputsParsed)
+{
+    const Compiled compiled(scenario);
+    ScenarioState state;
+    state.compiled = &compiled.scenario;
+    state.set_input("speed; L; 0,0; 10,20");
+    state.initialize(Log{});
+    const auto *begin = reinterpret_cast<const char *>(compiled.words.data());
+    const auto *times = reinterpret_cast<const char *>(state.series[0].times_data());
+    EXPECT_FALSE(times >= begin && times < begin + compiled.scenario.size);
+    state.set_time(5.0);
+    EXPECT_DOUBLE_EQ(10.0, state.real_value(state.series[0]));
+
+    // Switching back after a reset
+    state.set_input(scenario);
+    state.initialize(Log{});
+    times = reinterpret_cast<const char *>(state.series[0].times_data());
+    EXPECT_TRUE(times >= begin && times < begin + compiled.scenario.size);
+
+    // Nothing compiled into the test binary
+    EXPECT_EQ(nullptr, ScenarioState().compiled);
+}
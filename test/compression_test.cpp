@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+#include "series.hpp"
+
+namespace
+{
+    const fmi2ValueReference vrCompressSeries = 0x40000000;
+
+    std::string long_scenario(size_t points)
+    {
+        std::string line = "var1; L";
+        std::string zoh = "var2; ZOH";
+        for (size_t i = 0; i < points; ++i)
+        {
+            const double t = 0.01 * static_cast<double>(i);
+            const double v = std::round(std::sin(t) * 1000.0) / 1000.0;
+            line += "; " + std::to_string(t) + "," + std::to_string(v);
+            zoh += "; " + std::to_string(t) + "," + std::to_string(i / 100);
+        }
+        return line + "\n" + zoh;
+    }
+
+    fmi2Component instantiate(const std::string &scenario, bool compress)
+    {
+        fmi2CallbackFunctions cbs{};
+        auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+
+        const fmi2ValueReference vr_in[1] = {0};
+        const fmi2String values[1] = {scenario.c_str()};
+        fmi2SetString(comp, vr_in, 1, values);
+
+        const fmi2ValueReference vr_opt[1] = {vrCompressSeries};
+        const fmi2Boolean opt[1] = {compress ? fmiTrue : fmiFalse};
+        fmi2SetBoolean(comp, vr_opt, 1, opt);
+
+        fmi2EnterInitializationMode(comp);
+        fmi2ExitInitializationMode(comp);
+        return comp;
+    }
+}
+
+TEST(Compression, RoundTripIsLossless)
+{
+    std::vector<double> times;
+    std::vector<double> values;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        // Irregular, negative and repeated times, noisy values
+        times.push_back(-5.0 + 0.013 * static_cast<double>(i) + (i % 7 == 0 ? 0.001 : 0.0));
+        values.push_back(i % 11 == 0 ? values.empty() ? 0.0 : values.back() : std::sin(0.1 * i) * 1e3 + 1e-9 * i);
+    }
+    times[500] = times[499];
+
+    const CompressedSeries compressed(times, values);
+    ASSERT_EQ(times.size(), compressed.size());
+
+    DecodedBlock block;
+    for (size_t b = 0; b < compressed.block_count(); ++b)
+    {
+        compressed.decode(b, block);
+        for (size_t i = 0; i < block.times.size(); ++i)
+        {
+            EXPECT_EQ(times[block.first_index + i], block.times[i]);
+            EXPECT_EQ(values[block.first_index + i], block.values[i]);
+        }
+    }
+}
+
+TEST(Compression, SmallerThanPlainStorage)
+{
+    SeriesData sd;
+    for (size_t i = 0; i < 10000; ++i)
+    {
+        sd.times.push_back(0.01 * static_cast<double>(i));
+        sd.values.push_back(static_cast<double>(i / 500));
+    }
+    sd.size = sd.times.size();
+
+    const size_t plain = sd.footprint();
+    compress_series(sd);
+    EXPECT_LT(sd.footprint() * 5, plain);
+}
+
+TEST(Compression, SameOutputsAsPlainStorage)
+{
+    const auto scenario = long_scenario(2000);
+    auto plain = instantiate(scenario, false);
+    auto compressed = instantiate(scenario, true);
+
+    const fmi2ValueReference vr_out[2] = {1, 2};
+    fmi2Real expected[2];
+    fmi2Real actual[2];
+
+    // Forward in small steps, then jump back into an earlier block
+    std::vector<double> times;
+    for (double t = 0.0; t < 21.0; t += 0.0037)
+    {
+        times.push_back(t);
+    }
+    times.push_back(2.55);
+    times.push_back(19.99);
+    times.push_back(0.0);
+
+    for (double t : times)
+    {
+        ASSERT_EQ(fmi2OK, fmi2DoStep(plain, t, 0.0, fmiTrue));
+        ASSERT_EQ(fmi2OK, fmi2DoStep(compressed, t, 0.0, fmiTrue));
+        ASSERT_EQ(fmi2OK, fmi2GetReal(plain, vr_out, 2, expected));
+        ASSERT_EQ(fmi2OK, fmi2GetReal(compressed, vr_out, 2, actual));
+        EXPECT_EQ(expected[0], actual[0]) << "t=" << t;
+        EXPECT_EQ(expected[1], actual[1]) << "t=" << t;
+    }
+
+    fmi2FreeInstance(plain);
+    fmi2FreeInstance(compressed);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+#include "parser.hpp"
+
+namespace
+{
+    fmi2Component instantiate(const char *scenario)
+    {
+        fmi2CallbackFunctions cbs{};
+        auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+
+        const fmi2ValueReference vr_in[1] = {0};
+        const fmi2String values[1] = {scenario};
+        fmi2SetString(comp, vr_in, 1, values);
+        fmi2EnterInitializationMode(comp);
+        fmi2ExitInitializationMode(comp);
+        return comp;
+    }
+
+    const char *scenario = "speed; L; 0,0; 10,100\n"
+                           "gear; ZOH; Integer; 0,1; 2,1; 3,2; 4,2; 6,-3\n"
+                           "switch; ZOH; Boolean; 1,0; 2,1; 5,true; 7,false";
+}
+
+TEST(Discrete, ChangePointsOnly)
+{
+    auto d = parse_scenario(scenario);
+    ASSERT_EQ(3u, d.size());
+    EXPECT_EQ(ValueType::Integer, d[1].type);
+    EXPECT_EQ(3u, d[1].size);
+    EXPECT_EQ((std::vector<int32_t>{1, 2, -3}), d[1].integers);
+    EXPECT_TRUE(d[1].values.empty());
+
+    EXPECT_EQ(ValueType::Boolean, d[2].type);
+    EXPECT_EQ(3u, d[2].size);
+    EXPECT_EQ((std::vector<double>{1, 2, 7}), d[2].times);
+    EXPECT_EQ(1u, d[2].booleans.size());
+    EXPECT_EQ("switch; ZOH; Boolean; 1,0; 2,1; 7,0", d[2].to_string());
+}
+
+TEST(Discrete, RejectsValuesThatDoNotFit)
+{
+    EXPECT_THROW(parse_scenario("g; ZOH; Integer; 0,2.7"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("g; ZOH; Integer; 0,1x"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("g; ZOH; Integer; 0,1; 1,3000000000"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("g; ZOH; Integer; 0,-2147483649"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("s; ZOH; Boolean; 0,5"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("s; ZOH; Boolean; 0,-1"), std::runtime_error);
+
+    auto d = parse_scenario("g; ZOH; Integer; 0,-2147483648; 1, +2147483647 \ns; ZOH; Boolean; 0,1; 1,false");
+    EXPECT_EQ((std::vector<int32_t>{-2147483648, 2147483647}), d[0].integers);
+    EXPECT_EQ("s; ZOH; Boolean; 0,1; 1,0", d[1].to_string());
+}
+
+TEST(Discrete, GetIntegerAndBoolean)
+{
+    auto comp = instantiate(scenario);
+
+    const fmi2ValueReference vr_int[1] = {2};
+    const fmi2ValueReference vr_bool[1] = {3};
+    fmi2Integer gear[1] = {0};
+    fmi2Boolean on[1] = {fmiFalse};
+
+    const double times[] = {0.5, 2.0, 3.0, 5.0, 6.5, 7.0, 1.0};
+    const fmi2Integer expected_gear[] = {1, 1, 2, 2, -3, -3, 1};
+    const fmi2Boolean expected_on[] = {fmiFalse, fmiTrue, fmiTrue, fmiTrue, fmiTrue, fmiFalse, fmiFalse};
+
+    for (size_t i = 0; i < std::size(times); ++i)
+    {
+        ASSERT_EQ(fmi2OK, fmi2DoStep(comp, times[i], 0.0, fmiTrue));
+        ASSERT_EQ(fmi2OK, fmi2GetInteger(comp, vr_int, 1, gear));
+        ASSERT_EQ(fmi2OK, fmi2GetBoolean(comp, vr_bool, 1, on));
+        EXPECT_EQ(expected_gear[i], gear[0]) << "t=" << times[i];
+        EXPECT_EQ(expected_on[i], on[0]) << "t=" << times[i];
+    }
+
+    fmi2FreeInstance(comp);
+}
+
+TEST(Discrete, WrongTypeIsWarning)
+{
+    auto comp = instantiate(scenario);
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 4.0, 0.0, fmiTrue));
+
+    const fmi2ValueReference vr[3] = {1, 2, 3};
+    fmi2Real reals[3];
+    fmi2Integer integers[3];
+    EXPECT_EQ(fmi2Warning, fmi2GetReal(comp, vr, 3, reals));
+    EXPECT_NEAR(40.0, reals[0], 1e-9);
+    EXPECT_EQ(0.0, reals[1]);
+    EXPECT_EQ(fmi2Warning, fmi2GetInteger(comp, vr, 3, integers));
+    EXPECT_EQ(2, integers[1]);
+
+    fmi2FreeInstance(comp);
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+#include "parser.hpp"
+
+namespace
+{
+    const char *scenario = "cycle; L; Repeat; 0,0; 1,10; 2,0\n"
+                           "pulse; L; Zero; 1,5; 3,7\n"
+                           "held; L; Hold; 1,5; 3,7\n"
+                           "gear; ZOH; Integer; Repeat; 0,1; 2,2; 4,2";
+}
+
+TEST(Extrapolation, Modifiers)
+{
+    auto d = parse_scenario(scenario);
+    ASSERT_EQ(4u, d.size());
+    EXPECT_EQ(Extrapolation::Repeat, d[0].extrapolation);
+    EXPECT_EQ(Extrapolation::Zero, d[1].extrapolation);
+    EXPECT_EQ(Extrapolation::Hold, d[2].extrapolation);
+    EXPECT_EQ(Extrapolation::Repeat, d[3].extrapolation);
+
+    // The repeated last point of a discrete series ends its period
+    EXPECT_EQ((std::vector<double>{0, 2, 4}), d[3].times);
+    EXPECT_EQ("gear; ZOH; Integer; Repeat; 0,1; 2,2; 4,2", d[3].to_string());
+    EXPECT_EQ("cycle; L; Repeat; 0,0; 1,10; 2,0", d[0].to_string());
+}
+
+TEST(Extrapolation, RepeatFoldsIntoThePeriod)
+{
+    auto d = parse_scenario(scenario);
+    auto &cycle = d[0];
+    EXPECT_DOUBLE_EQ(0.0, eval_value_at(cycle, 2.0));
+    EXPECT_DOUBLE_EQ(5.0, eval_value_at(cycle, 2.5));
+    EXPECT_DOUBLE_EQ(10.0, eval_value_at(cycle, 3.0));
+    EXPECT_DOUBLE_EQ(0.0, eval_value_at(cycle, 4.0));
+    EXPECT_DOUBLE_EQ(5.0, eval_value_at(cycle, 200.5));
+    EXPECT_DOUBLE_EQ(0.0, eval_value_at(cycle, -1.0));
+
+    EXPECT_DOUBLE_EQ(10.0, eval_output_derivative_at(cycle, 2.5));
+    EXPECT_DOUBLE_EQ(-10.0, eval_output_derivative_at(cycle, 3.5));
+
+    auto &gear = d[3];
+    EXPECT_EQ(1, eval_discrete_at(gear, 5.0));
+    EXPECT_EQ(2, eval_discrete_at(gear, 6.5));
+    EXPECT_EQ(2, eval_discrete_at(gear, 8.0));
+    EXPECT_EQ(1, eval_discrete_at(gear, 8.5));
+}
+
+TEST(Extrapolation, ZeroAndHold)
+{
+    auto d = parse_scenario(scenario);
+    EXPECT_DOUBLE_EQ(7.0, eval_value_at(d[1], 3.0));
+    EXPECT_DOUBLE_EQ(0.0, eval_value_at(d[1], 3.5));
+    EXPECT_DOUBLE_EQ(7.0, eval_value_at(d[2], 3.5));
+    EXPECT_DOUBLE_EQ(7.0, eval_value_at(d[2], 1e9));
+}
+
+TEST(Extrapolation, CursorAcrossWrapAround)
+{
+    // Stepping through many periods must give the same values as a fresh series at every step
+    auto stepped = parse_scenario(scenario);
+    for (double t = 0.0; t < 100.0; t += 0.125)
+    {
+        auto fresh = parse_scenario(scenario);
+        ASSERT_EQ(eval_value_at(fresh[0], t), eval_value_at(stepped[0], t)) << "at " << t;
+        ASSERT_EQ(eval_discrete_at(fresh[3], t), eval_discrete_at(stepped[3], t)) << "at " << t;
+    }
+}
+
+TEST(Extrapolation, BatchMatchesSingleLookups)
+{
+    SeriesData sd;
+    sd.name = "long";
+    sd.interpolation = Interpolation::Linear;
+    sd.extrapolation = Extrapolation::Repeat;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        sd.times.push_back(0.5 * static_cast<double>(i));
+        sd.values.push_back(std::sin(0.01 * static_cast<double>(i)));
+    }
+    sd.size = sd.times.size();
+
+    std::vector<double> times;
+    for (double t = -1.0; t < 5000.0; t += 0.3)
+    {
+        times.push_back(t);
+    }
+
+    for (const bool compressed : {false, true})
+    {
+        if (compressed)
+        {
+            compress_series(sd);
+        }
+        std::vector<double> expected;
+        for (const double t : times)
+        {
+            expected.push_back(eval_value_at(sd, t));
+        }
+        sd.rewind();
+        std::vector<double> out(times.size());
+        eval_batch(sd, times.data(), times.size(), out.data());
+        EXPECT_EQ(expected, out);
+    }
+
+    sd.extrapolation = Extrapolation::Zero;
+    std::vector<double> out(times.size());
+    eval_batch(sd, times.data(), times.size(), out.data());
+    EXPECT_EQ(0.0, out.back());
+}
+
+TEST(Extrapolation, ThroughTheFmu)
+{
+    fmi2CallbackFunctions cbs{};
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+    const fmi2ValueReference vr_in[1] = {0};
+    const fmi2String values[1] = {scenario};
+    fmi2SetString(comp, vr_in, 1, values);
+    fmi2EnterInitializationMode(comp);
+    fmi2ExitInitializationMode(comp);
+
+    const fmi2ValueReference vr_out[3] = {1, 2, 3};
+    fmi2Real out[3];
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 0.0, 102.5, fmiTrue));
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 3, out));
+    EXPECT_DOUBLE_EQ(5.0, out[0]);
+    EXPECT_DOUBLE_EQ(0.0, out[1]);
+    EXPECT_DOUBLE_EQ(7.0, out[2]);
+    fmi2FreeInstance(comp);
+}
+
+TEST(Extrapolation, UnknownModifier)
+{
+    EXPECT_THROW(parse_scenario("x; L; Periodic; 0,0; 1,1"), std::runtime_error);
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const char *scenario = "speed; L; Float32; 0,0.1; 1,0.2; 2,0.7; 4,-1.3\n"
+                           "level; ZOH; 0,0.1; 1,0.2; 2,0.7; 4,-1.3\n"
+                           "gear; ZOH; Integer; 0,1; 4,2";
+
+    std::vector<double> grid()
+    {
+        std::vector<double> times;
+        for (double t = -0.5; t <= 5.0; t += 0.125)
+        {
+            times.push_back(t);
+        }
+        return times;
+    }
+}
+
+TEST(Float32, ModifierNarrowsValues)
+{
+    auto series = parse_scenario(scenario);
+    auto &speed = series[0];
+    EXPECT_TRUE(speed.float32);
+    EXPECT_TRUE(speed.values.empty());
+    ASSERT_EQ(4u, speed.values32.size());
+    EXPECT_EQ(0.7f, speed.values32[2]);
+
+    // Evaluated like the double series, within float rounding
+    auto &level = series[1];
+    level.interpolation = Interpolation::Linear;
+    for (const double t : grid())
+    {
+        EXPECT_NEAR(eval_value_at(level, t), eval_value_at(speed, t), 1e-7) << t;
+    }
+    EXPECT_DOUBLE_EQ(static_cast<double>(0.7f), eval_value_at(speed, 2.0));
+
+    // Values and times as double plus values as float
+    EXPECT_EQ(4 * sizeof(double) + 4 * sizeof(float), speed.footprint());
+}
+
+TEST(Float32, BoundIsChecked)
+{
+    EXPECT_NO_THROW(parse_scenario("a; L; Float32(1e-6); 0,0.1; 1,1000.5"));
+    EXPECT_THROW(parse_scenario("a; L; Float32(1e-9); 0,0.1; 1,1000.5"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("a; L; Float32; 0,1e300; 1,0"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("a; L; Float32(x); 0,0"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("a; ZOH; Integer; Float32; 0,1"), std::runtime_error);
+}
+
+TEST(Float32, BatchMatchesSinglePoints)
+{
+    auto series = parse_scenario(scenario);
+    const auto times = grid();
+    std::vector<double> batch(times.size());
+    eval_batch(series[0], times.data(), times.size(), batch.data());
+    series[0].rewind();
+    for (size_t i = 0; i < times.size(); ++i)
+    {
+        EXPECT_EQ(eval_value_at(series[0], times[i]), batch[i]) << times[i];
+    }
+}
+
+TEST(Float32, RoundTripsThroughText)
+{
+    auto series = parse_scenario("a; L; Float32(0.001); 0,0.1; 1,0.2");
+    const auto text = series[0].to_string();
+    EXPECT_NE(std::string::npos, text.find("Float32(0.001)"));
+
+    auto again = parse_scenario(text);
+    ASSERT_EQ(2u, again[0].values32.size());
+    EXPECT_EQ(series[0].values32, again[0].values32);
+}
+
+TEST(Float32, CompressWidensValues)
+{
+    auto series = parse_scenario(scenario);
+    const double before = eval_value_at(series[0], 1.5);
+    compress_series(series[0]);
+    EXPECT_TRUE(series[0].values32.empty());
+    EXPECT_EQ(before, eval_value_at(series[0], 1.5));
+}
+
+TEST(Float32, OptionNarrowsWithinBound)
+{
+    ScenarioState state;
+    state.set_input("a; L; 0,0.5; 1,0.25\nb; L; 0,0.1; 1,1000.1\ngear; ZOH; Integer; 0,1; 4,2");
+    ASSERT_TRUE(state.set_boolean_option(vrFloat32Values, true));
+    ASSERT_TRUE(state.set_real_option(vrFloat32Bound, 1e-9));
+    EXPECT_FALSE(state.set_real_option(vrFloat32Bound, -1.0));
+    EXPECT_FALSE(state.set_real_option(vrFirstOption + 99, 1.0));
+
+    Log log;
+    state.initialize(log);
+
+    // Exactly representable values are narrowed, b would lose more than the bound
+    EXPECT_EQ(2u, state.series[0].values32.size());
+    EXPECT_TRUE(state.series[1].values32.empty());
+    EXPECT_EQ(2u, state.series[1].values.size());
+    ASSERT_EQ(1u, log.messages.size());
+    EXPECT_NE(std::string::npos, log.messages[0].find("Keeping b in double"));
+
+    // A changed bound is a new parse setting
+    state.set_real_option(vrFloat32Bound, 0.0);
+    state.initialize(log);
+    EXPECT_EQ(2u, state.series[1].values32.size());
+}
+
+TEST(Float32, SerializedAsDouble)
+{
+    auto series = parse_scenario(scenario);
+    const auto binary = serialize_scenario(series);
+    auto restored = deserialize_scenario(binary.data(), binary.size());
+    ASSERT_EQ(4u, restored[0].size);
+    EXPECT_DOUBLE_EQ(static_cast<double>(0.7f), eval_value_at(restored[0], 2.0));
+}
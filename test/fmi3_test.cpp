@@ -0,0 +1,321 @@
+#include <gtest/gtest.h>
+
+#include "series.hpp"
+#include "parser.hpp"
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "fmi3.h"
+}
+
+namespace
+{
+    constexpr fmi3ValueReference vrFloat64Array = 0x20000000;
+    constexpr fmi3ValueReference vrInt32Array = 0x20000001;
+    constexpr fmi3ValueReference vrBooleanArray = 0x20000002;
+    constexpr fmi3ValueReference vrChangeClock = 0x20000003;
+    constexpr fmi3ValueReference vrCompressSeries = 0x40000000;
+
+    const char *scenario =
+        "var1; L; 1,0; 3,0.5; 5,4; 9,2\n"
+        "gear; ZOH; Integer; 0,1; 4,2; 6,3\n"
+        "var2; ZOH; 2,0; 3,0.5; 5,4; 9,2\n"
+        "on; ZOH; Boolean; 0,0; 2.5,1\n";
+
+    fmi3Instance instantiate(bool event_mode, bool early_return)
+    {
+        return fmi3InstantiateCoSimulation("inst", "token", nullptr, fmi3False, fmi3False,
+                                           event_mode, early_return, nullptr, 0, nullptr, nullptr, nullptr);
+    }
+
+    fmi3Status initialize(fmi3Instance inst, const char *input)
+    {
+        const fmi3ValueReference vr_in[1] = {0};
+        const fmi3String values[1] = {input};
+        EXPECT_EQ(fmi3OK, fmi3SetString(inst, vr_in, 1, values, 1));
+        EXPECT_EQ(fmi3OK, fmi3EnterInitializationMode(inst, fmi3False, 0.0, 0.0, fmi3False, 0.0));
+        return fmi3ExitInitializationMode(inst);
+    }
+
+    bool clock(fmi3Instance inst)
+    {
+        const fmi3ValueReference vr[1] = {vrChangeClock};
+        fmi3Clock value[1] = {fmi3ClockInactive};
+        EXPECT_EQ(fmi3OK, fmi3GetClock(inst, vr, 1, value));
+        return value[0];
+    }
+}
+
+TEST(Fmi3, ArraysMatchScalarOutputs)
+{
+    auto inst = instantiate(false, false);
+    ASSERT_EQ(fmi3OK, initialize(inst, scenario));
+
+    bool eh = false, term = false, early = false;
+    double last = 0.0;
+    for (double t : {0.5, 2.0, 4.0, 7.0, 12.0})
+    {
+        ASSERT_EQ(fmi3OK, fmi3DoStep(inst, 0.0, t, fmi3True, &eh, &term, &early, &last));
+        EXPECT_DOUBLE_EQ(t, last);
+
+        // Whole Real row in one call
+        const fmi3ValueReference vr_array[1] = {vrFloat64Array};
+        double row[2];
+        ASSERT_EQ(fmi3OK, fmi3GetFloat64(inst, vr_array, 1, row, 2));
+
+        const fmi3ValueReference vr_scalar[2] = {1, 3};
+        double scalars[2];
+        ASSERT_EQ(fmi3OK, fmi3GetFloat64(inst, vr_scalar, 2, scalars, 2));
+        EXPECT_EQ(scalars[0], row[0]) << t;
+        EXPECT_EQ(scalars[1], row[1]) << t;
+
+        const fmi3ValueReference vr_int[2] = {vrInt32Array, 2};
+        int32_t ints[2];
+        ASSERT_EQ(fmi3OK, fmi3GetInt32(inst, vr_int, 2, ints, 2));
+        EXPECT_EQ(ints[1], ints[0]) << t;
+
+        const fmi3ValueReference vr_bool[2] = {4, vrBooleanArray};
+        bool bools[2];
+        ASSERT_EQ(fmi3OK, fmi3GetBoolean(inst, vr_bool, 2, bools, 2));
+        EXPECT_EQ(bools[0], bools[1]) << t;
+        EXPECT_EQ(t >= 2.5, bools[1]) << t;
+    }
+
+    // At t = 12
+    const fmi3ValueReference vr_out[2] = {vrFloat64Array, 1};
+    double values[3];
+    ASSERT_EQ(fmi3OK, fmi3GetFloat64(inst, vr_out, 2, values, 3));
+    EXPECT_DOUBLE_EQ(2.0, values[0]);
+    EXPECT_DOUBLE_EQ(2.0, values[1]);
+    EXPECT_DOUBLE_EQ(2.0, values[2]);
+
+    // The array does not fit
+    EXPECT_EQ(fmi3Error, fmi3GetFloat64(inst, vr_out, 2, values, 2));
+
+    // Wrong type for a scalar output
+    const fmi3ValueReference vr_int[1] = {1};
+    int32_t ints[1] = {7};
+    EXPECT_EQ(fmi3Warning, fmi3GetInt32(inst, vr_int, 1, ints, 1));
+    EXPECT_EQ(0, ints[0]);
+
+    fmi3FreeInstance(inst);
+}
+
+TEST(Fmi3, ReturnsEarlyAtChangePoints)
+{
+    auto inst = instantiate(true, true);
+    ASSERT_EQ(fmi3OK, initialize(inst, scenario));
+
+    bool update = true, term = true, nominals = true, states = true, defined = false;
+    double next = 0.0;
+    ASSERT_EQ(fmi3OK, fmi3UpdateDiscreteStates(inst, &update, &term, &nominals, &states, &defined, &next));
+    EXPECT_TRUE(defined);
+    EXPECT_DOUBLE_EQ(2.0, next);
+    ASSERT_EQ(fmi3OK, fmi3EnterStepMode(inst));
+
+    // Piecewise constant outputs change at 2, 2.5, 3, 4, 5, 6 and 9, var1 is linear
+    std::vector<double> events;
+    double time = 0.0;
+    while (time < 20.0)
+    {
+        bool eh = false, early = false;
+        double last = 0.0;
+        ASSERT_EQ(fmi3OK, fmi3DoStep(inst, time, 20.0 - time, fmi3True, &eh, &term, &early, &last));
+        time = last;
+        if (!eh)
+        {
+            EXPECT_FALSE(early);
+            EXPECT_FALSE(clock(inst));
+            continue;
+        }
+        events.push_back(time);
+        ASSERT_EQ(fmi3OK, fmi3EnterEventMode(inst));
+        EXPECT_TRUE(clock(inst));
+        EXPECT_FALSE(clock(inst)); // reported once
+        ASSERT_EQ(fmi3OK, fmi3UpdateDiscreteStates(inst, &update, &term, &nominals, &states, &defined, &next));
+        ASSERT_EQ(fmi3OK, fmi3EnterStepMode(inst));
+    }
+    EXPECT_EQ((std::vector<double>{2.0, 2.5, 3.0, 4.0, 5.0, 6.0, 9.0}), events);
+
+    // Values at an event are the ones after the change
+    ASSERT_EQ(fmi3OK, fmi3Reset(inst));
+    ASSERT_EQ(fmi3OK, initialize(inst, scenario));
+    bool eh = false, early = false;
+    double last = 0.0;
+    ASSERT_EQ(fmi3OK, fmi3DoStep(inst, 3.5, 1.0, fmi3True, &eh, &term, &early, &last));
+    EXPECT_TRUE(early);
+    EXPECT_DOUBLE_EQ(4.0, last);
+    const fmi3ValueReference vr_gear[1] = {2};
+    int32_t gear[1];
+    ASSERT_EQ(fmi3OK, fmi3GetInt32(inst, vr_gear, 1, gear, 1));
+    EXPECT_EQ(2, gear[0]);
+
+    fmi3FreeInstance(inst);
+}
+
+TEST(Fmi3, FlagsEventsAtStepEndWithoutEarlyReturn)
+{
+    auto inst = instantiate(true, false);
+    ASSERT_EQ(fmi3OK, initialize(inst, scenario));
+    ASSERT_EQ(fmi3OK, fmi3EnterStepMode(inst));
+
+    bool eh = false, term = false, early = false;
+    double last = 0.0;
+    ASSERT_EQ(fmi3OK, fmi3DoStep(inst, 0.0, 1.0, fmi3True, &eh, &term, &early, &last));
+    EXPECT_FALSE(eh);
+    ASSERT_EQ(fmi3OK, fmi3DoStep(inst, 1.0, 2.0, fmi3True, &eh, &term, &early, &last));
+    EXPECT_TRUE(eh);
+    EXPECT_FALSE(early);
+    EXPECT_DOUBLE_EQ(3.0, last);
+    EXPECT_TRUE(clock(inst));
+
+    fmi3FreeInstance(inst);
+}
+
+TEST(Fmi3, OptionsAndErrors)
+{
+    auto inst = instantiate(false, false);
+    const fmi3ValueReference vr_opt[1] = {vrCompressSeries};
+    const bool on[1] = {true};
+    ASSERT_EQ(fmi3OK, fmi3SetBoolean(inst, vr_opt, 1, on, 1));
+    ASSERT_EQ(fmi3OK, initialize(inst, scenario));
+
+    bool eh = false, term = false, early = false;
+    double last = 0.0;
+    ASSERT_EQ(fmi3OK, fmi3DoStep(inst, 0.0, 4.0, fmi3True, &eh, &term, &early, &last));
+    const fmi3ValueReference vr_array[1] = {vrFloat64Array};
+    double row[2];
+    ASSERT_EQ(fmi3OK, fmi3GetFloat64(inst, vr_array, 1, row, 2));
+    EXPECT_DOUBLE_EQ(2.25, row[0]);
+    EXPECT_DOUBLE_EQ(0.5, row[1]);
+
+    // The scenario input reads back as a string
+    const fmi3ValueReference vr_in[1] = {0};
+    fmi3String text[1] = {nullptr};
+    ASSERT_EQ(fmi3OK, fmi3GetString(inst, vr_in, 1, text, 1));
+    EXPECT_STREQ(scenario, text[0]);
+
+    // Parse errors are reported, not thrown across the C interface
+    ASSERT_EQ(fmi3OK, fmi3Reset(inst));
+    EXPECT_EQ(fmi3Error, initialize(inst, "var1; L; 0,0; x,1"));
+
+    fmi3FreeInstance(inst);
+}
+
+TEST(Fmi3, StartsOnTheQuantizedStartTime)
+{
+    auto inst = instantiate(false, false);
+    const fmi3ValueReference vr_options[2] = {0x40000007, 0x4000000d};
+    const bool calendar[1] = {true};
+    const double resolution[1] = {1e-6};
+    ASSERT_EQ(fmi3OK, fmi3SetBoolean(inst, vr_options, 1, calendar, 1));
+    ASSERT_EQ(fmi3OK, fmi3SetFloat64(inst, vr_options + 1, 1, resolution, 1));
+    const fmi3ValueReference vr_in[1] = {0};
+    const fmi3String values[1] = {scenario};
+    ASSERT_EQ(fmi3OK, fmi3SetString(inst, vr_in, 1, values, 1));
+
+    // Just before the gear change at 4, on it once quantized
+    ASSERT_EQ(fmi3OK, fmi3EnterInitializationMode(inst, fmi3False, 0.0, 4.0 - 1e-12, fmi3False, 0.0));
+    ASSERT_EQ(fmi3OK, fmi3ExitInitializationMode(inst));
+    const fmi3ValueReference vr_gear[1] = {2};
+    int32_t gear[1];
+    ASSERT_EQ(fmi3OK, fmi3GetInt32(inst, vr_gear, 1, gear, 1));
+    EXPECT_EQ(2, gear[0]);
+
+    fmi3FreeInstance(inst);
+}
+
+TEST(Fmi3, InputDependencies)
+{
+    auto inst = instantiate(false, false);
+    ASSERT_EQ(fmi3OK, initialize(inst, "torque; L; Map(speed,load); 0,1; 0,1; 1,2; 3,4\n"
+                                       "level; ZOH; 0,0; 1,1\n"
+                                       "efficiency; L; Input(speed); 0,0.5; 1,0.9"));
+    const fmi3ValueReference vrSpeed = 0x12000000;
+    const fmi3ValueReference vrLoad = 0x12000001;
+
+    size_t n = 0;
+    ASSERT_EQ(fmi3OK, fmi3GetNumberOfVariableDependencies(inst, 2, &n));
+    EXPECT_EQ(0u, n);
+
+    size_t element[2] = {9, 9};
+    fmi3ValueReference independent[2] = {};
+    size_t independent_element[2] = {9, 9};
+    fmi3DependencyKind kind[2] = {};
+    ASSERT_EQ(fmi3OK, fmi3GetNumberOfVariableDependencies(inst, 1, &n));
+    ASSERT_EQ(2u, n);
+    ASSERT_EQ(fmi3OK, fmi3GetVariableDependencies(inst, 1, element, independent, independent_element, kind, n));
+    EXPECT_EQ(0u, element[0]);
+    EXPECT_EQ(vrSpeed, independent[0]);
+    EXPECT_EQ(vrLoad, independent[1]);
+    EXPECT_EQ(0u, independent_element[1]);
+    EXPECT_EQ(fmi3Dependent, kind[0]);
+
+    // The Real array, by element of the series indexed by an input
+    ASSERT_EQ(fmi3OK, fmi3GetNumberOfVariableDependencies(inst, vrFloat64Array, &n));
+    ASSERT_EQ(3u, n);
+    size_t elements[3];
+    fmi3ValueReference independents[3];
+    size_t independent_elements[3];
+    fmi3DependencyKind kinds[3];
+    ASSERT_EQ(fmi3OK, fmi3GetVariableDependencies(inst, vrFloat64Array, elements, independents, independent_elements, kinds, n));
+    EXPECT_EQ(1u, elements[1]);
+    EXPECT_EQ(3u, elements[2]);
+    EXPECT_EQ(vrSpeed, independents[2]);
+    EXPECT_EQ(fmi3Error, fmi3GetVariableDependencies(inst, vrFloat64Array, elements, independents, independent_elements, kinds, 2));
+
+    fmi3FreeInstance(inst);
+}
+
+TEST(Fmi3, DirectionalDerivative)
+{
+    auto inst = instantiate(false, false);
+    ASSERT_EQ(fmi3OK, initialize(inst, "efficiency; L; Input(speed); 0,0.5; 1,0.9\nlevel; ZOH; 0,0; 1,1"));
+    const fmi3ValueReference knowns[1] = {0x12000000};
+    const fmi3Float64 seed[1] = {2.0};
+    const fmi3ValueReference unknowns[2] = {1, 2};
+    fmi3Float64 sensitivity[2] = {9.0, 9.0};
+    ASSERT_EQ(fmi3OK, fmi3GetDirectionalDerivative(inst, unknowns, 2, knowns, 1, seed, 1, sensitivity, 2));
+    EXPECT_DOUBLE_EQ(0.8, sensitivity[0]);
+    EXPECT_EQ(0.0, sensitivity[1]);
+
+    // One seed per known and one sensitivity per unknown
+    EXPECT_EQ(fmi3Error, fmi3GetDirectionalDerivative(inst, unknowns, 2, knowns, 1, seed, 1, sensitivity, 1));
+    EXPECT_EQ(fmi3Error, fmi3GetDirectionalDerivative(inst, unknowns, 2, knowns, 1, seed, 0, sensitivity, 2));
+    fmi3FreeInstance(inst);
+}
+
+TEST(Fmi3, NextPointAfter)
+{
+    auto series = parse_scenario("a; ZOH; 1,0; 2,1; 4,0\nb; ZOH; Repeat; 0,0; 1,1; 3,2");
+    auto &a = series[0];
+    EXPECT_DOUBLE_EQ(1.0, next_point_after(a, 0.0));
+    EXPECT_DOUBLE_EQ(2.0, next_point_after(a, 1.0));
+    EXPECT_DOUBLE_EQ(4.0, next_point_after(a, 3.9));
+    EXPECT_TRUE(std::isinf(next_point_after(a, 4.0)));
+
+    // Repeat continues with the next periods, the end of one period is the start of the next
+    auto &b = series[1];
+    EXPECT_DOUBLE_EQ(3.0, next_point_after(b, 2.0));
+    EXPECT_DOUBLE_EQ(4.0, next_point_after(b, 3.0));
+    EXPECT_DOUBLE_EQ(6.0, next_point_after(b, 4.5));
+    EXPECT_DOUBLE_EQ(7.0, next_point_after(b, 6.0));
+
+    // Across the blocks of a compressed series
+    std::string text = "c; ZOH";
+    for (int i = 0; i < 1000; ++i)
+    {
+        text += "; " + std::to_string(i) + "," + std::to_string(i % 7);
+    }
+    auto compressed = parse_scenario(text);
+    compress_series(compressed[0]);
+    for (double t : {0.0, 254.5, 255.0, 509.9, 510.0, 998.0})
+    {
+        EXPECT_DOUBLE_EQ(std::floor(t) + 1.0, next_point_after(compressed[0], t)) << t;
+    }
+}
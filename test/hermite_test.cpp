@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+#include "binary.hpp"
+
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+namespace
+{
+    // var1: cubic from 0 to 1 over [0, 2], then 1 with slope 0 up to 3
+    // var2: from 5 to 2 over [0, 1], held until 3, then down with slope -1 up to 4
+    const char *records = "[[0;0;1;2][2;1;0;1]]\n[[0;5;0;1] [3;2;-1;1]]";
+}
+
+TEST(Hermite, RecordsBecomeSegments)
+{
+    auto series = parse_scenario(records);
+    ASSERT_EQ(2u, series.size());
+    EXPECT_EQ("var1; L; 0,0; hermite(1,0); 2,1; hermite(0,0); 3,1", series[0].to_string());
+    EXPECT_EQ("var2; L; 0,5; hermite(0,-1); 1,2; 3,2; hermite(-1,-1); 4,1", series[1].to_string());
+
+    auto &s = series[0];
+    EXPECT_DOUBLE_EQ(0.75, eval_value_at(s, 1.0));
+    EXPECT_DOUBLE_EQ(0.5, eval_output_derivative_at(s, 1.0));
+    EXPECT_DOUBLE_EQ(1.0, eval_output_derivative_at(s, 0.0));
+    EXPECT_DOUBLE_EQ(1.0, eval_value_at(s, 2.5));
+    EXPECT_DOUBLE_EQ(1.0, eval_value_at(s, 10.0));
+
+    auto &t = series[1];
+    EXPECT_DOUBLE_EQ(2.0, eval_value_at(t, 2.0));
+    EXPECT_DOUBLE_EQ(0.0, eval_output_derivative_at(t, 2.0));
+    EXPECT_DOUBLE_EQ(1.5, eval_value_at(t, 3.5));
+    EXPECT_DOUBLE_EQ(-1.0, eval_output_derivative_at(t, 3.5));
+
+    // The text form parses back to the same segments
+    auto again = parse_scenario(series[1].to_string());
+    EXPECT_EQ(series[1].to_string(), again[0].to_string());
+    EXPECT_DOUBLE_EQ(eval_value_at(t, 0.3), eval_value_at(again[0], 0.3));
+}
+
+TEST(Hermite, ExactForCubics)
+{
+    // f(t) = t^3 - 2t, records at 0, 1 and 3 with the exact slopes
+    const auto f = [](double t)
+    { return t * t * t - 2.0 * t; };
+    const auto df = [](double t)
+    { return 3.0 * t * t - 2.0; };
+    std::string input = "[";
+    for (const auto &[t, length] : std::vector<std::pair<double, double>>{{0.0, 1.0}, {1.0, 2.0}, {3.0, 0.0}})
+    {
+        input += "[" + std::to_string(t) + ";" + std::to_string(f(t)) + ";" + std::to_string(df(t)) + ";" + std::to_string(length) + "]";
+    }
+    input += "]";
+
+    auto series = parse_scenario(input);
+    auto &s = series[0];
+    EXPECT_EQ(3u, s.size);
+    for (double t = 0.0; t < 3.0; t += 0.07)
+    {
+        EXPECT_NEAR(f(t), eval_value_at(s, t), 1e-12) << t;
+        EXPECT_NEAR(df(t), eval_output_derivative_at(s, t), 1e-12) << t;
+    }
+}
+
+TEST(Hermite, DerivativesAndIntegralThroughTheFmu)
+{
+    fmi2CallbackFunctions cbs{};
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+    const fmi2ValueReference vr_in[1] = {0};
+    const fmi2String values[1] = {"x; L; Integral; 0,0; hermite(1,0); 2,1"};
+    ASSERT_EQ(fmi2OK, fmi2SetString(comp, vr_in, 1, values));
+    ASSERT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+    ASSERT_EQ(fmi2OK, fmi2ExitInitializationMode(comp));
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 0.0, 1.0, fmiTrue));
+
+    const fmi2ValueReference vr_out[1] = {1};
+    const fmi2Integer order[1] = {1};
+    fmi2Real value[1];
+    ASSERT_EQ(fmi2OK, fmi2GetRealOutputDerivatives(comp, vr_out, 1, order, value));
+    EXPECT_DOUBLE_EQ(0.5, value[0]);
+
+    // h (v0 + v1) / 2 + h^2 (d0 - d1) / 12 over the whole segment
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 1.0, 1.0, fmiTrue));
+    const fmi2ValueReference vr_integral[1] = {vrFirstIntegral};
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_integral, 1, value));
+    EXPECT_DOUBLE_EQ(1.0 + 1.0 / 3.0, value[0]);
+    fmi2FreeInstance(comp);
+}
+
+TEST(Hermite, KeptInBinaryAndLazily)
+{
+    auto series = parse_scenario(records);
+    const auto binary = serialize_scenario(series);
+    auto restored = deserialize_scenario(binary.data(), binary.size());
+    for (size_t i = 0; i < series.size(); ++i)
+    {
+        EXPECT_EQ(series[i].to_string(), restored[i].to_string());
+        EXPECT_EQ(eval_value_at(series[i], 0.7), eval_value_at(restored[i], 0.7));
+    }
+
+    ScenarioState state;
+    state.set_input(records);
+    state.lazy_parse = true;
+    state.initialize(Log{});
+    ASSERT_EQ(2u, state.series.size());
+    EXPECT_TRUE(state.series[1].loaded);
+    EXPECT_EQ("var2", state.series[1].name);
+}
+
+TEST(Hermite, InvalidRecords)
+{
+    EXPECT_THROW(parse_scenario("[[0;0;1]]"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("[[0;0;1;2][1;0;0;1]]"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("[[0;0;1;-1]]"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("[[0;0;1;1]"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("[[0;0;1;1]]x"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("x; L; 0,0; hermite(1); 1,1"), std::runtime_error);
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+namespace
+{
+    const char *scenario = "efficiency; L; Input(speed); 0,0.5; 1000,0.8; 3000,0.9\n"
+                           "drag; L; Input(velocity); 0,0; 10,5; 20,20\n"
+                           "load; L; 0,0; 10,10\n"
+                           "loss; ZOH; Input(speed); 0,1; 2000,2";
+}
+
+TEST(Input, NearSearchMatchesCursorSearch)
+{
+    const std::vector<double> times = {0.0, 1.0, 1.0, 2.5, 3.0, 7.0, 7.5, 9.0};
+    uint64_t state = 7;
+    size_t cursor = 0;
+    for (int k = 0; k < 2000; ++k)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        const double x = -1.0 + 11.0 * static_cast<double>(state >> 11) / 9007199254740992.0;
+        const double at = k % 10 == 0 ? times[k % times.size()] : x;
+        const size_t expected = find_segment_in(times.data(), times.size(), 0, at);
+        cursor = find_segment_near(times.data(), times.size(), cursor, at);
+        EXPECT_EQ(expected, cursor) << at;
+    }
+}
+
+TEST(Input, CurvesFollowTheirInput)
+{
+    fmi2CallbackFunctions cbs{};
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+    const fmi2ValueReference vr_in[1] = {0};
+    const fmi2String values[1] = {scenario};
+    ASSERT_EQ(fmi2OK, fmi2SetString(comp, vr_in, 1, values));
+
+    // Set before the series exist, a time shift only moves the series indexed by time
+    const fmi2ValueReference vr_speed[1] = {vrFirstInput};
+    const fmi2Real speed[1] = {500.0};
+    ASSERT_EQ(fmi2OK, fmi2SetReal(comp, vr_speed, 1, speed));
+    const fmi2ValueReference vr_shift[1] = {vrFirstTransform + 2};
+    const fmi2Real shift[1] = {1.0};
+    ASSERT_EQ(fmi2OK, fmi2SetReal(comp, vr_shift, 1, shift));
+    ASSERT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+    ASSERT_EQ(fmi2OK, fmi2ExitInitializationMode(comp));
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 0.0, 5.0, fmiTrue));
+
+    const fmi2ValueReference vr_out[4] = {1, 2, 3, 4};
+    fmi2Real out[4];
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 4, out));
+    EXPECT_DOUBLE_EQ(0.65, out[0]);
+    EXPECT_DOUBLE_EQ(0.0, out[1]);
+    EXPECT_DOUBLE_EQ(4.0, out[2]);
+    EXPECT_DOUBLE_EQ(1.0, out[3]);
+
+    // Jumping back and forth, past the ends the values hold
+    const fmi2ValueReference vr_velocity[1] = {vrFirstInput + 1};
+    for (const auto &[velocity, drag] : std::vector<std::pair<double, double>>{{15, 12.5}, {5, 2.5}, {25, 20}, {-3, 0}, {10, 5}})
+    {
+        const fmi2Real value[1] = {velocity};
+        ASSERT_EQ(fmi2OK, fmi2SetReal(comp, vr_velocity, 1, value));
+        fmi2Real result[1];
+        ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out + 1, 1, result));
+        EXPECT_DOUBLE_EQ(drag, result[0]) << velocity;
+    }
+
+    // Inputs read back, no time derivative, only the inputs of the scenario exist
+    fmi2Real value[1];
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_velocity, 1, value));
+    EXPECT_EQ(10.0, value[0]);
+    const fmi2Integer order[1] = {1};
+    ASSERT_EQ(fmi2OK, fmi2GetRealOutputDerivatives(comp, vr_out + 1, 1, order, value));
+    EXPECT_EQ(0.0, value[0]);
+    const fmi2ValueReference vr_none[1] = {vrFirstInput + 2};
+    EXPECT_EQ(fmi2Warning, fmi2SetReal(comp, vr_none, 1, speed));
+    fmi2FreeInstance(comp);
+}
+
+TEST(Input, SetBeforeInitialization)
+{
+    // Kept by value reference until the inputs are known, without room for the ones in between
+    ScenarioState state;
+    state.set_input(scenario);
+    EXPECT_TRUE(state.set_real_input(vrFirstInput + 1, 15.0));
+    double value = 0.0;
+    EXPECT_TRUE(state.real_input(vrFirstInput + 1, value));
+    EXPECT_EQ(15.0, value);
+    EXPECT_TRUE(state.inputs.empty());
+    state.initialize(Log{});
+    EXPECT_TRUE(state.pending_inputs.empty());
+    EXPECT_EQ((std::vector<double>{0.0, 15.0}), state.inputs);
+    EXPECT_FALSE(state.set_real_input(vrFirstInput + 2, 1.0));
+
+    // A stray input fails the initialization instead of growing the inputs
+    ScenarioState stray;
+    stray.set_input(scenario);
+    EXPECT_TRUE(stray.set_real_input(vrFirstInput + 0xFFFFFF, 1.0));
+    EXPECT_THROW(stray.initialize(Log{}), std::runtime_error);
+    EXPECT_LE(stray.inputs.size(), 2u);
+    EXPECT_FALSE(stray.set_real_input(vrFirstInput + maxInputs, 1.0));
+}
+
+TEST(Input, BoundInOrderOfFirstUse)
+{
+    for (const bool lazy : {false, true})
+    {
+        ScenarioState state;
+        state.set_input(scenario);
+        state.lazy_parse = lazy;
+        state.initialize(Log{});
+        EXPECT_EQ((std::vector<std::string>{"speed", "velocity"}), state.input_names);
+        EXPECT_EQ(0, state.series[3].input_index);
+        EXPECT_EQ(-1, state.series[2].input_index);
+    }
+}
+
+TEST(Input, ParsedAndKeptInBinary)
+{
+    EXPECT_THROW(parse_scenario("x; ZOH; Integer; Input(speed); 0,1"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("x; L; Input(speed); Window(2); 0,1"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("x; L; Input(); 0,1"), std::runtime_error);
+
+    auto d = parse_scenario(scenario);
+    EXPECT_EQ("drag; L; Input(velocity); 0,0; 10,5; 20,20", d[1].to_string());
+    const auto binary = serialize_scenario(d);
+    const auto restored = deserialize_scenario(binary.data(), binary.size());
+    EXPECT_EQ("velocity", restored[1].input);
+    EXPECT_TRUE(restored[2].input.empty());
+}
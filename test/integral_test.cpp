@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+namespace
+{
+    const char *scenario = "power; L; Integral; 0,0; 2,2; 4,2\n"
+                           "level; ZOH; Integral; 0,1; 2,3\n"
+                           "near; NN; Integral; 0,0; 2,2\n"
+                           "wave; L; Integral; 0,1; sin(2,0.5); 10,1; 20,3\n"
+                           "sweep; ZOH; Integral; 0,0; chirp(1,0,2); 4,0\n"
+                           "cycle; L; Repeat; Integral; 1,0; 2,2; 3,0\n"
+                           "pulse; ZOH; Zero; Integral; 0,2; 1,2\n"
+                           "plain; L; 0,0; 1,1";
+
+    // Integral by the midpoint rule on the values, the reference for the closed forms
+    double midpoint_integral(SeriesData &sd, double from, double to)
+    {
+        const int steps = 200000;
+        const double h = (to - from) / steps;
+        double sum = 0.0;
+        for (int i = 0; i < steps; ++i)
+        {
+            sum += eval_value_at(sd, from + (i + 0.5) * h);
+        }
+        return sum * h;
+    }
+}
+
+TEST(Integral, ExactPerInterpolation)
+{
+    auto d = parse_scenario(scenario);
+    for (auto &s : d)
+    {
+        build_integral(s);
+    }
+    EXPECT_TRUE(d[7].cumulative.empty());
+    EXPECT_EQ("power; L; Integral; 0,0; 2,2; 4,2", d[0].to_string());
+
+    EXPECT_DOUBLE_EQ(0.0, eval_integral_at(d[0], -1.0));
+    EXPECT_DOUBLE_EQ(0.5, eval_integral_at(d[0], 1.0));
+    EXPECT_DOUBLE_EQ(4.0, eval_integral_at(d[0], 3.0));
+    EXPECT_DOUBLE_EQ(8.0, eval_integral_at(d[0], 5.0)); // held after the last point
+
+    EXPECT_DOUBLE_EQ(1.5, eval_integral_at(d[1], 1.5));
+    EXPECT_DOUBLE_EQ(5.0, eval_integral_at(d[1], 3.0));
+
+    EXPECT_DOUBLE_EQ(0.0, eval_integral_at(d[2], 1.0));
+    EXPECT_DOUBLE_EQ(3.0, eval_integral_at(d[2], 2.5));
+
+    // Repeat adds one period after another, Zero stops
+    EXPECT_DOUBLE_EQ(2.0, eval_integral_at(d[5], 3.0));
+    EXPECT_DOUBLE_EQ(4 * 2.0 + 0.25, eval_integral_at(d[5], 9.5));
+    EXPECT_DOUBLE_EQ(2.0, eval_integral_at(d[6], 10.0));
+
+    // Going backwards after going forwards
+    EXPECT_DOUBLE_EQ(0.5, eval_integral_at(d[0], 1.0));
+}
+
+TEST(Integral, ShapesMatchQuadrature)
+{
+    auto d = parse_scenario(scenario);
+    for (size_t i : {3, 4})
+    {
+        build_integral(d[i]);
+        for (double t : {0.3, 2.5, 3.9, 7.0, 15.0, 22.0})
+        {
+            EXPECT_NEAR(midpoint_integral(d[i], 0.0, t), eval_integral_at(d[i], t), 1e-6) << d[i].name << " " << t;
+        }
+    }
+}
+
+TEST(Integral, ChirpPanelsSummedOnce)
+{
+    auto d = parse_scenario("long; L; Integral; 0,0; chirp(1,1,100); 1000,0\n" + std::string(scenario));
+    build_integral(d[0]);
+    build_integral(d[5]);
+    ASSERT_EQ(1u, d[0].chirp_integrals.size());
+    EXPECT_EQ(65537u, d[0].chirp_integrals[0].sums.size());
+    EXPECT_TRUE(d[1].chirp_integrals.empty());
+
+    // A get adds the partial panel to the table, the same sum as building the table on the spot
+    const auto &shape = d[0].shapes[0];
+    for (double t : {0.01, 1.3, 499.99, 999.9, 1000.0})
+    {
+        EXPECT_DOUBLE_EQ(shape_integral(shape, 0.0, 0.0, 1000.0, 0.0, t), eval_integral_at(d[0], t)) << t;
+    }
+    EXPECT_NEAR(midpoint_integral(d[5], 0.0, 3.3), eval_integral_at(d[5], 3.3), 1e-6);
+}
+
+TEST(Integral, KeptThroughCompressionAndBinary)
+{
+    ScenarioState compressed;
+    compressed.set_input(scenario);
+    compressed.compress_series = true;
+    compressed.initialize(Log{});
+    ASSERT_TRUE(compressed.series[0].compressed);
+
+    auto plain = parse_scenario(scenario);
+    auto binary = serialize_scenario(plain);
+    auto restored = deserialize_scenario(binary.data(), binary.size());
+    for (size_t i = 0; i < plain.size(); ++i)
+    {
+        build_integral(plain[i]);
+        build_integral(restored[i]);
+        EXPECT_EQ(plain[i].integral, restored[i].integral);
+        for (double t : {0.5, 1.7, 3.0, 12.0})
+        {
+            const double expected = eval_integral_at(plain[i], t);
+            EXPECT_DOUBLE_EQ(expected, eval_integral_at(restored[i], t));
+            if (plain[i].integral)
+            {
+                compressed.current_time = t;
+                EXPECT_NEAR(expected, compressed.integral_value(compressed.series[i]), 1e-12) << i << " " << t;
+            }
+        }
+    }
+}
+
+TEST(Integral, OutputWithTransform)
+{
+    fmi2CallbackFunctions cbs{};
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+    const fmi2ValueReference vr_in[1] = {0};
+    const fmi2String values[1] = {scenario};
+    ASSERT_EQ(fmi2OK, fmi2SetString(comp, vr_in, 1, values));
+
+    // Twice as high, one second later and twice as slow
+    const fmi2ValueReference vr_set[4] = {vrFirstTransform + 0, vrFirstTransform + 1, vrFirstTransform + 2, vrFirstTransform + 3};
+    const fmi2Real set[4] = {2.0, 0.5, 1.0, 2.0};
+    ASSERT_EQ(fmi2OK, fmi2SetReal(comp, vr_set, 4, set));
+    ASSERT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+    ASSERT_EQ(fmi2OK, fmi2ExitInitializationMode(comp));
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 0.0, 7.0, fmiTrue));
+
+    // power at local time 3: integral 4 over 3 seconds of its own time, 6 of simulation time
+    const fmi2ValueReference vr_out[2] = {vrFirstIntegral + 0, 1};
+    fmi2Real out[2];
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 2, out));
+    EXPECT_DOUBLE_EQ(2.0 * 2.0 * 4.0 + 0.5 * 6.0, out[0]);
+    EXPECT_DOUBLE_EQ(2.0 * 2.0 + 0.5, out[1]);
+
+    // No integral for series without the modifier
+    const fmi2ValueReference vr_plain[1] = {vrFirstIntegral + 7};
+    EXPECT_EQ(fmi2Warning, fmi2GetReal(comp, vr_plain, 1, out));
+    fmi2FreeInstance(comp);
+}
+
+TEST(Integral, RejectsDiscreteSeries)
+{
+    EXPECT_THROW(parse_scenario("gear; ZOH; Integer; Integral; 0,1"), std::runtime_error);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+namespace
+{
+    const char *scenario = "var1; L; 1,0; 3,0.5; 5,4; 9,2\n"
+                           "gear; ZOH; Integer; 0,1; 4,2\n"
+                           "broken; L; 1,0; 2\n"
+                           "var3; NN; 0,0; 1,0.5; 2,4; 3,2";
+
+    fmi2Component instantiate(bool lazy)
+    {
+        fmi2CallbackFunctions cbs{};
+        auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+
+        const fmi2ValueReference vr_in[1] = {0};
+        const fmi2String values[1] = {scenario};
+        fmi2SetString(comp, vr_in, 1, values);
+
+        const fmi2ValueReference vr_opt[1] = {vrLazyParse};
+        const fmi2Boolean opt[1] = {lazy ? fmiTrue : fmiFalse};
+        fmi2SetBoolean(comp, vr_opt, 1, opt);
+
+        fmi2EnterInitializationMode(comp);
+        fmi2ExitInitializationMode(comp);
+        return comp;
+    }
+}
+
+TEST(Lazy, IndexKeepsPointsUnparsed)
+{
+    const std::string input = scenario;
+    auto series = index_scenario(input);
+    ASSERT_EQ(4u, series.size());
+
+    EXPECT_EQ("gear", series[1].name);
+    EXPECT_EQ(ValueType::Integer, series[1].type);
+    EXPECT_EQ(Interpolation::NearestNeighbor, series[3].interpolation);
+    for (const auto &s : series)
+    {
+        EXPECT_FALSE(s.loaded);
+        EXPECT_EQ(0u, s.size);
+        EXPECT_EQ(0u, s.footprint());
+    }
+
+    load_series(series[0]);
+    EXPECT_TRUE(series[0].loaded);
+    EXPECT_EQ((std::vector<double>{1, 3, 5, 9}), series[0].times);
+
+    EXPECT_THROW(load_series(series[2]), std::runtime_error);
+    EXPECT_FALSE(series[2].loaded);
+    EXPECT_EQ(0u, series[2].size);
+}
+
+TEST(Lazy, IndexSharesTheInputText)
+{
+    ScenarioState state;
+    state.set_input(scenario);
+    state.lazy_parse = true;
+    state.initialize(Log{});
+    EXPECT_EQ(state.scenario_input.get(), state.source.get());
+
+    // A new input before the next initialization leaves the text of the index alone
+    state.set_input("other; L; 0,0; 1,1");
+    EXPECT_NE(state.scenario_input.get(), state.source.get());
+    load_series(state.series[0]);
+    EXPECT_EQ((std::vector<double>{1, 3, 5, 9}), state.series[0].times);
+}
+
+TEST(Lazy, SameOutputsAsEager)
+{
+    auto lazy = instantiate(true);
+
+    const fmi2ValueReference vr_out[2] = {1, 4};
+    const fmi2ValueReference vr_int[1] = {2};
+    fmi2Real out_vals[2];
+    fmi2Integer gear[1];
+
+    ASSERT_EQ(fmi2OK, fmi2DoStep(lazy, 4.0, 0.0, fmiTrue));
+    ASSERT_EQ(fmi2OK, fmi2GetReal(lazy, vr_out, 2, out_vals));
+    ASSERT_EQ(fmi2OK, fmi2GetInteger(lazy, vr_int, 1, gear));
+    EXPECT_NEAR(2.25, out_vals[0], 1e-9);
+    EXPECT_NEAR(2.0, out_vals[1], 1e-9);
+    EXPECT_EQ(2, gear[0]);
+
+    const fmi2Integer orders[1] = {1};
+    fmi2Real derivatives[1];
+    ASSERT_EQ(fmi2OK, fmi2GetRealOutputDerivatives(lazy, vr_out, 1, orders, derivatives));
+    EXPECT_NEAR(1.75, derivatives[0], 1e-9);
+
+    fmi2FreeInstance(lazy);
+}
+
+TEST(Lazy, ErrorsOnlyForUsedSeries)
+{
+    auto lazy = instantiate(true);
+
+    const fmi2ValueReference vr_ok[1] = {1};
+    const fmi2ValueReference vr_broken[1] = {3};
+    fmi2Real out_vals[1];
+
+    ASSERT_EQ(fmi2OK, fmi2DoStep(lazy, 2.0, 0.0, fmiTrue));
+    EXPECT_EQ(fmi2OK, fmi2GetReal(lazy, vr_ok, 1, out_vals));
+    EXPECT_EQ(fmi2Error, fmi2GetReal(lazy, vr_broken, 1, out_vals));
+
+    fmi2FreeInstance(lazy);
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+namespace
+{
+    // Same series in every scenario, as the packager aligns them
+    const std::vector<std::string> scenarios = {
+        "speed; L; 0,0; 10,10\ngear; ZOH; Integer; 0,1; 5,2\ndoor; ZOH; Boolean",
+        "speed; L; 0,5; 10,5\ngear; ZOH; Integer; 0,3\ndoor; ZOH; Boolean; 0,0; 2,1",
+    };
+
+    // Library file as written by library.py
+    std::vector<char> build_library(const std::vector<std::string> &texts)
+    {
+        std::vector<std::vector<char>> binaries;
+        for (const auto &text : texts)
+        {
+            binaries.push_back(serialize_scenario(parse_scenario(text)));
+        }
+
+        size_t offset = align8(sizeof(LibraryHeader) + binaries.size() * sizeof(LibraryEntry));
+        std::vector<LibraryEntry> entries;
+        for (const auto &binary : binaries)
+        {
+            entries.push_back({offset, binary.size()});
+            offset = align8(offset + binary.size());
+        }
+
+        std::vector<char> out(offset);
+        LibraryHeader header{};
+        std::memcpy(header.magic, library_magic, sizeof(library_magic));
+        header.count = static_cast<uint32_t>(binaries.size());
+        header.total_size = offset;
+        std::memcpy(out.data(), &header, sizeof(header));
+        std::memcpy(out.data() + sizeof(header), entries.data(), entries.size() * sizeof(LibraryEntry));
+        for (size_t i = 0; i < binaries.size(); ++i)
+        {
+            std::memcpy(out.data() + entries[i].offset, binaries[i].data(), binaries[i].size());
+        }
+        return out;
+    }
+
+    // Resources directory with a library, removed at the end of the test
+    struct Resources
+    {
+        std::filesystem::path directory;
+
+        explicit Resources(const std::vector<char> &library)
+            : directory(std::filesystem::temp_directory_path() / ("scenario lib " + std::to_string(getpid())))
+        {
+            std::filesystem::create_directories(directory);
+            std::ofstream(directory / library_file, std::ios::binary).write(library.data(), static_cast<std::streamsize>(library.size()));
+        }
+
+        ~Resources()
+        {
+            std::filesystem::remove_all(directory);
+        }
+
+        // file URI with the space percent encoded
+        std::string uri() const
+        {
+            std::string out = "file://";
+            for (const char c : directory.string())
+            {
+                out += c == ' ' ? std::string("%20") : std::string(1, c);
+            }
+            return out + "/";
+        }
+    };
+}
+
+TEST(Library, ResourceDirectoryFromUri)
+{
+    EXPECT_EQ("/tmp/a b/resources", resource_directory("file:///tmp/a%20b/resources/"));
+    EXPECT_EQ("/tmp/resources", resource_directory("file:/tmp/resources"));
+    EXPECT_EQ("C:/fmu/resources", resource_directory("file:///C:/fmu/resources"));
+    EXPECT_EQ("/tmp/resources", resource_directory("/tmp/resources/"));
+}
+
+TEST(Library, SelectsByIndex)
+{
+    Resources resources(build_library(scenarios));
+
+    fmi2CallbackFunctions cbs{};
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", resources.uri().c_str(), &cbs, fmiFalse, fmiFalse);
+    const fmi2ValueReference vr_index[1] = {vrScenarioIndex};
+    const fmi2ValueReference vr_real[1] = {1};
+    const fmi2ValueReference vr_int[1] = {2};
+    const fmi2ValueReference vr_bool[1] = {3};
+
+    for (int index : {0, 1, 0, 1})
+    {
+        ASSERT_EQ(fmi2OK, fmi2Reset(comp));
+        const fmi2Integer value[1] = {index};
+        ASSERT_EQ(fmi2OK, fmi2SetInteger(comp, vr_index, 1, value));
+        ASSERT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+        ASSERT_EQ(fmi2OK, fmi2ExitInitializationMode(comp));
+        ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 0.0, 6.0, fmiTrue));
+
+        fmi2Real speed[1];
+        fmi2Integer gear[1];
+        fmi2Boolean door[1];
+        ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_real, 1, speed));
+        ASSERT_EQ(fmi2OK, fmi2GetInteger(comp, vr_int, 1, gear));
+        ASSERT_EQ(fmi2OK, fmi2GetBoolean(comp, vr_bool, 1, door));
+        EXPECT_DOUBLE_EQ(index == 0 ? 6.0 : 5.0, speed[0]) << index;
+        EXPECT_EQ(index == 0 ? 2 : 3, gear[0]) << index;
+        EXPECT_EQ(index == 0 ? fmiFalse : fmiTrue, door[0]) << index;
+    }
+
+    const fmi2Integer invalid[1] = {-2};
+    EXPECT_EQ(fmi2Warning, fmi2SetInteger(comp, vr_index, 1, invalid));
+    fmi2FreeInstance(comp);
+}
+
+TEST(Library, LoadedOncePerProcess)
+{
+    Resources resources(build_library(scenarios));
+
+    ScenarioState a;
+    ScenarioState b;
+    for (auto *state : {&a, &b})
+    {
+        state->resources = resource_directory(resources.uri());
+        state->set_integer_option(vrScenarioIndex, 1);
+        state->initialize(Log{});
+    }
+    ASSERT_TRUE(a.library);
+    EXPECT_EQ(a.library, b.library);
+    EXPECT_EQ(a.series[0].mapped_times, b.series[0].mapped_times);
+    EXPECT_EQ(0u, a.series[0].footprint());
+
+    // Out of range, and a state without resources
+    a.set_integer_option(vrScenarioIndex, 2);
+    EXPECT_THROW(a.initialize(Log{}), std::runtime_error);
+    ScenarioState none;
+    none.set_integer_option(vrScenarioIndex, 0);
+    EXPECT_THROW(none.initialize(Log{}), std::runtime_error);
+}
+
+TEST(Library, RejectsCorruptFiles)
+{
+    auto library = build_library(scenarios);
+    library[30] = 0x7f; // offset of the first entry
+    Resources resources(library);
+    EXPECT_THROW(load_library((resources.directory / library_file).string()), std::runtime_error);
+}
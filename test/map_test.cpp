@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "binary.hpp"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+namespace
+{
+    const char *scenario = "torque; L; Map(speed,load); 1000,2000,4000; 0,0.5,1; 10,20,30; 15,25,45; 18,28,38\n"
+                           "efficiency; L; Input(speed); 0,0.5; 1000,0.8; 3000,0.9\n"
+                           "load; L; 0,0; 10,10\n"
+                           "smooth; C; Map(load,speed); 0,1,2; 0,1000; 0,1; 1,2; 4,5";
+
+    // Values of f on the grid of `x` and `y`, row per point of x
+    template <class F>
+    std::vector<double> tabulate(const std::vector<double> &x, const std::vector<double> &y, F &&f)
+    {
+        std::vector<double> z;
+        for (const double xi : x)
+        {
+            for (const double yj : y)
+            {
+                z.push_back(f(xi, yj));
+            }
+        }
+        return z;
+    }
+}
+
+TEST(Map, ReproducesBilinearFunctions)
+{
+    const std::vector<double> x = {-1.0, 0.0, 0.5, 2.0, 7.0};
+    const std::vector<double> y = {10.0, 10.25, 11.0, 20.0};
+    const auto f = [](double a, double b)
+    { return 2.0 + 3.0 * a - b + 0.5 * a * b; };
+    for (const auto method : {MapMethod::Bilinear, MapMethod::Bicubic})
+    {
+        const LookupMap map(x, y, tabulate(x, y, f), method);
+        size_t cx = 0;
+        size_t cy = 0;
+        for (double a = -0.9; a < 7.0; a += 0.37)
+        {
+            for (double b = 10.1; b < 20.0; b += 0.61)
+            {
+                const auto m = map.eval(a, b, cx, cy);
+                EXPECT_NEAR(f(a, b), m.value, 1e-9) << a << " " << b;
+                EXPECT_NEAR(3.0 + 0.5 * b, m.dx, 1e-9) << a << " " << b;
+                EXPECT_NEAR(-1.0 + 0.5 * a, m.dy, 1e-9) << a << " " << b;
+            }
+        }
+    }
+}
+
+TEST(Map, BicubicIsSmooth)
+{
+    std::vector<double> x;
+    std::vector<double> y;
+    for (int i = 0; i <= 8; ++i)
+    {
+        x.push_back(0.25 * i);
+        y.push_back(0.5 * i);
+    }
+    const auto f = [](double a, double b)
+    { return a * a + std::sin(b); };
+    const LookupMap map(x, y, tabulate(x, y, f), MapMethod::Bicubic);
+    size_t cx = 0;
+    size_t cy = 0;
+
+    // Through the grid values, quadratic along the uniform first axis exactly
+    EXPECT_DOUBLE_EQ(f(0.5, 1.5), map.eval(0.5, 1.5, cx, cy).value);
+    EXPECT_NEAR(0.3 * 0.3 + std::sin(1.5), map.eval(0.3, 1.5, cx, cy).value, 1e-12);
+
+    // Value and both slopes continuous across a cell boundary on each axis
+    const double e = 1e-9;
+    for (const auto &[below, above] : {std::pair{map.eval(0.75 - e, 1.3, cx, cy), map.eval(0.75 + e, 1.3, cx, cy)},
+                                       std::pair{map.eval(0.6, 2.0 - e, cx, cy), map.eval(0.6, 2.0 + e, cx, cy)}})
+    {
+        EXPECT_NEAR(below.value, above.value, 1e-8);
+        EXPECT_NEAR(below.dx, above.dx, 1e-6);
+        EXPECT_NEAR(below.dy, above.dy, 1e-6);
+    }
+    EXPECT_NEAR(std::cos(1.3), map.eval(1.0, 1.3, cx, cy).dy, 0.02);
+}
+
+TEST(Map, CornersAndClamping)
+{
+    const std::vector<double> x = {0.0, 1.0};
+    const std::vector<double> y = {0.0, 10.0, 20.0};
+    const std::vector<double> z = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+    const LookupMap corner(x, y, z, MapMethod::Corner);
+    const LookupMap nearest(x, y, z, MapMethod::Nearest);
+    const LookupMap linear(x, y, z, MapMethod::Bilinear);
+    size_t cx = 0;
+    size_t cy = 0;
+
+    EXPECT_EQ(1.0, corner.eval(0.9, 9.0, cx, cy).value);
+    EXPECT_EQ(2.0, corner.eval(0.9, 10.0, cx, cy).value);
+    EXPECT_EQ(6.0, corner.eval(1.0, 20.0, cx, cy).value);
+    EXPECT_EQ(0.0, corner.eval(0.5, 15.0, cx, cy).dx);
+    EXPECT_EQ(5.0, nearest.eval(0.6, 14.0, cx, cy).value);
+    EXPECT_EQ(6.0, nearest.eval(0.6, 16.0, cx, cy).value);
+
+    // Outside the axes the edge holds, without a slope across it
+    const auto m = linear.eval(-3.0, 25.0, cx, cy);
+    EXPECT_EQ(3.0, m.value);
+    EXPECT_EQ(0.0, m.dx);
+    EXPECT_EQ(0.0, m.dy);
+    EXPECT_DOUBLE_EQ(3.0, linear.eval(0.5, 25.0, cx, cy).dx);
+    EXPECT_DOUBLE_EQ(3.0, linear.eval(0.5, 12.0, cx, cy).dx);
+    EXPECT_DOUBLE_EQ(0.1, linear.eval(0.5, 12.0, cx, cy).dy);
+
+    EXPECT_THROW(LookupMap({0.0, 0.0}, y, z, MapMethod::Bilinear), std::runtime_error);
+    EXPECT_THROW(LookupMap(x, y, {1.0, 2.0}, MapMethod::Bilinear), std::runtime_error);
+}
+
+TEST(Map, ValuesAndDirectionalDerivatives)
+{
+    fmi2CallbackFunctions cbs{};
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+    const fmi2ValueReference vr_in[1] = {0};
+    const fmi2String values[1] = {scenario};
+    ASSERT_EQ(fmi2OK, fmi2SetString(comp, vr_in, 1, values));
+    ASSERT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+    ASSERT_EQ(fmi2OK, fmi2ExitInitializationMode(comp));
+
+    // speed and load, in order of first use
+    const fmi2ValueReference vr_inputs[2] = {vrFirstInput, vrFirstInput + 1};
+    const fmi2Real inputs[2] = {3000.0, 0.25};
+    ASSERT_EQ(fmi2OK, fmi2SetReal(comp, vr_inputs, 2, inputs));
+
+    const fmi2ValueReference vr_out[2] = {1, 2};
+    fmi2Real out[2];
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 2, out));
+    // Halfway between the rows of 2000 and 4000 and between the loads 0 and 0.5
+    EXPECT_DOUBLE_EQ((15.0 + 25.0 + 18.0 + 28.0) / 4.0, out[0]);
+    EXPECT_DOUBLE_EQ(0.9, out[1]);
+
+    // d torque = dT/dspeed * dspeed + dT/dload * dload, the efficiency curve only on speed
+    const fmi2Real seed[2] = {100.0, 0.1};
+    fmi2Real sensitivity[3];
+    const fmi2ValueReference vr_unknown[3] = {1, 2, 3};
+    ASSERT_EQ(fmi2OK, fmi2GetDirectionalDerivative(comp, vr_unknown, 3, vr_inputs, 2, seed, sensitivity));
+    const double dspeed = ((18.0 + 28.0) / 2.0 - (15.0 + 25.0) / 2.0) / 2000.0;
+    const double dload = ((25.0 + 28.0) / 2.0 - (15.0 + 18.0) / 2.0) / 0.5;
+    EXPECT_NEAR(dspeed * 100.0 + dload * 0.1, sensitivity[0], 1e-12);
+    EXPECT_NEAR(0.1 / 2000.0 * 100.0, sensitivity[1], 1e-12);
+    EXPECT_EQ(0.0, sensitivity[2]);
+
+    // No time derivative, the inputs have none
+    const fmi2Integer order[1] = {1};
+    fmi2Real derivative[1];
+    ASSERT_EQ(fmi2OK, fmi2GetRealOutputDerivatives(comp, vr_out, 1, order, derivative));
+    EXPECT_EQ(0.0, derivative[0]);
+    fmi2FreeInstance(comp);
+}
+
+TEST(Map, BatchOverBothInputs)
+{
+    auto d = parse_scenario(scenario);
+    auto &torque = d[0];
+    const double speed[3] = {1500.0, 3000.0, 4000.0};
+    const double load[3] = {0.5, 0.25, 1.0};
+    double out[3];
+    eval_map_batch(torque, speed, load, 3, out);
+    EXPECT_DOUBLE_EQ(22.5, out[0]);
+    EXPECT_DOUBLE_EQ((15.0 + 25.0 + 18.0 + 28.0) / 4.0, out[1]);
+    EXPECT_DOUBLE_EQ(38.0, out[2]);
+
+    eval_map_batch(torque, speed, load, 3, out, true);
+    EXPECT_DOUBLE_EQ((25.0 - 20.0) / 1000.0, out[0]);
+    EXPECT_DOUBLE_EQ(((18.0 + 28.0) / 2.0 - (15.0 + 25.0) / 2.0) / 2000.0, out[1]);
+    EXPECT_DOUBLE_EQ(0.0, out[2]);
+}
+
+TEST(Map, ParsedAndKeptInBinary)
+{
+    EXPECT_THROW(parse_scenario("m; L; Map(a); 0,1; 0,1; 1,2; 3,4"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("m; L; Map(a,b); Input(c); 0,1; 0,1; 1,2; 3,4"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("m; L; Map(a,b); Integral; 0,1; 0,1; 1,2; 3,4"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("m; L; Map(a,b); 0,1; 0,1; 1,2"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("m; L; Map(a,b); 0,1; 0,1; 1,2; 3"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("m; L; Map(a,b); 1,0; 0,1; 1,2; 3,4"), std::runtime_error);
+
+    auto d = parse_scenario(scenario);
+    EXPECT_EQ("torque; L; Map(speed,load); 1000,2000,4000; 0,0.5,1; 10,20,30; 15,25,45; 18,28,38", d[0].to_string());
+    const auto binary = serialize_scenario(d);
+    auto restored = deserialize_scenario(binary.data(), binary.size());
+    EXPECT_EQ(d[3].to_string(), restored[3].to_string());
+    EXPECT_EQ("load", restored[3].input);
+    EXPECT_EQ("speed", restored[3].input2);
+    EXPECT_TRUE(restored[1].input2.empty());
+    EXPECT_DOUBLE_EQ(eval_map_at(d[3], 1.5, 400.0).value, eval_map_at(restored[3], 1.5, 400.0).value);
+
+    // Lazily parsed, the inputs are bound from the header
+    ScenarioState state;
+    state.set_input(scenario);
+    state.lazy_parse = true;
+    state.initialize([](bool, const std::string &) {});
+    EXPECT_EQ((std::vector<std::string>{"speed", "load"}), state.input_names);
+    EXPECT_EQ(1, state.series[3].input_index);
+    EXPECT_EQ(0, state.series[3].input2_index);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const char *scenario = "speed; L; Noise(0.5,0.1,42); 0,10; 100,10\n"
+                           "force; L; BandNoise(2,1,7); 1,0; 101,0\n"
+                           "plain; L; 0,1; 100,1";
+}
+
+TEST(Noise, PhiloxKnownAnswers)
+{
+    // Known answer vectors of the Random123 reference implementation
+    EXPECT_EQ((PhiloxWords{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}), philox4x32({0, 0, 0, 0}, 0));
+    EXPECT_EQ((PhiloxWords{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}),
+              philox4x32({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, 0xffffffffffffffff));
+}
+
+TEST(Noise, NormalSamples)
+{
+    const int n = 200000;
+    double sum = 0.0;
+    double squares = 0.0;
+    for (int k = 0; k < n; ++k)
+    {
+        const double x = noise_sample(3, k);
+        sum += x;
+        squares += x * x;
+    }
+    EXPECT_NEAR(0.0, sum / n, 0.01);
+    EXPECT_NEAR(1.0, squares / n, 0.01);
+    EXPECT_NE(noise_sample(3, 5), noise_sample(4, 5));
+}
+
+TEST(Noise, ReproducibleOnEveryPath)
+{
+    ScenarioState a;
+    ScenarioState b;
+    for (auto *s : {&a, &b})
+    {
+        s->set_input(scenario);
+        s->initialize(Log{});
+    }
+
+    // White noise holds for its step, band limited noise moves linearly between samples
+    a.set_time(5.01);
+    const double white = a.real_value(a.series[0]);
+    a.set_time(5.09);
+    EXPECT_EQ(white, a.real_value(a.series[0]));
+    EXPECT_NE(10.0, white);
+    EXPECT_EQ(0.0, a.real_derivative(a.series[0]));
+    a.set_time(5.5);
+    const double slope = a.real_derivative(a.series[1]);
+    a.set_time(5.25);
+    const double middle = a.real_value(a.series[1]);
+    a.set_time(5.75);
+    EXPECT_NEAR(slope * 0.5, a.real_value(a.series[1]) - middle, 1e-12);
+
+    // No noise before the first point or on other series
+    a.set_time(0.5);
+    EXPECT_EQ(0.0, a.real_value(a.series[1]));
+    EXPECT_EQ(1.0, a.real_value(a.series[2]));
+
+    // Another instance, going backwards and batch evaluation give the same values
+    std::vector<double> times;
+    std::vector<double> values;
+    for (double t = 0.0; t < 20.0; t += 0.37)
+    {
+        times.push_back(t);
+        a.set_time(t);
+        values.push_back(a.real_value(a.series[1]));
+    }
+    for (size_t i = times.size(); i-- > 0;)
+    {
+        b.set_time(times[i]);
+        EXPECT_EQ(values[i], b.real_value(b.series[1])) << times[i];
+    }
+    std::vector<double> batch(times.size());
+    a.batch_values(a.series[1], times.data(), times.size(), batch.data());
+    EXPECT_EQ(values, batch);
+}
+
+TEST(Noise, ParsedAndKeptInBinary)
+{
+    auto d = parse_scenario(scenario);
+    EXPECT_EQ("force; L; BandNoise(2,1,7); 1,0; 101,0", d[1].to_string());
+    const auto binary = serialize_scenario(d);
+    const auto restored = deserialize_scenario(binary.data(), binary.size());
+    EXPECT_EQ(0.5, restored[0].noise.sigma);
+    EXPECT_EQ(42u, restored[0].noise.seed);
+    EXPECT_FALSE(restored[0].noise.band_limited);
+    EXPECT_TRUE(restored[1].noise.band_limited);
+    EXPECT_FALSE(restored[2].noise.enabled());
+
+    EXPECT_THROW(parse_scenario("x; L; Noise(1,0); 0,1"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("x; L; Noise(1,0.1,-3); 0,1"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("x; ZOH; Boolean; Noise(1,0.1); 0,1"), std::runtime_error);
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "parser.hpp"
+
+namespace
+{
+    std::string large_scenario(size_t series, size_t points)
+    {
+        std::string input;
+        for (size_t s = 0; s < series; ++s)
+        {
+            input += "var" + std::to_string(s) + (s % 2 ? "; ZOH" : "; L");
+            for (size_t i = 0; i < points; ++i)
+            {
+                input += "; " + std::to_string(0.1 * i) + "," + std::to_string(s * 1000 + i);
+            }
+            input += "\n";
+        }
+        return input;
+    }
+}
+
+TEST(Parser, Fields)
+{
+    auto d = parse_scenario(" var1 ;L; 1,0; 3, 0.5 ;+5,-4e1\r\n\nvar2; ZOH; 2,0;\n");
+    ASSERT_EQ(2u, d.size());
+    EXPECT_EQ("var1", d[0].name);
+    EXPECT_EQ(Interpolation::Linear, d[0].interpolation);
+    EXPECT_EQ((std::vector<double>{1, 3, 5}), d[0].times);
+    EXPECT_EQ((std::vector<double>{0, 0.5, -40}), d[0].values);
+    EXPECT_EQ(3u, d[0].size);
+    EXPECT_EQ("var2", d[1].name);
+    EXPECT_EQ(1u, d[1].size);
+}
+
+TEST(Parser, Errors)
+{
+    EXPECT_THROW(parse_scenario(""), std::runtime_error);
+    EXPECT_THROW(parse_scenario("var1"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("var1; L; 1;2"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("var1; L; 1,x"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("var1; L; Unknown; 1,2"), std::runtime_error);
+}
+
+TEST(Parser, ParallelMatchesSequential)
+{
+    const auto input = large_scenario(16, 10000);
+    ASSERT_GT(input.size(), parallel_parse_min_bytes);
+
+    const auto sequential = parse_scenario(input, 1);
+    const auto parallel = parse_scenario(input, 4);
+    ASSERT_EQ(sequential.size(), parallel.size());
+    for (size_t i = 0; i < sequential.size(); ++i)
+    {
+        EXPECT_EQ(sequential[i].name, parallel[i].name);
+        EXPECT_EQ(sequential[i].interpolation, parallel[i].interpolation);
+        EXPECT_EQ(sequential[i].times, parallel[i].times);
+        EXPECT_EQ(sequential[i].values, parallel[i].values);
+    }
+}
+
+TEST(Parser, ParallelReportsErrors)
+{
+    auto input = large_scenario(8, 10000);
+    input += "broken; L; 1,2; 3";
+    EXPECT_THROW(parse_scenario(input, 4), std::runtime_error);
+}
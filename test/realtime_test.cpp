@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+namespace
+{
+    const char *scenario = "speed; L; 0,0; 0.5,2; 0.5,3; 0.51,1; 0.52,4; 3,2; 9,0\n"
+                           "gear; ZOH; Integer; 0,1; 2,2; 2.001,3; 8,4\n"
+                           "wave; L; Repeat; 1,0; 1.5,2; 2,1; 4,0\n"
+                           "flat; L; 0,5; 1,5";
+}
+
+TEST(Realtime, GridFindsSegment)
+{
+    const std::vector<double> times = {0.0, 0.5, 0.5, 0.51, 0.52, 0.520001, 3.0, 3.0, 9.0, 100.0};
+    SegmentGrid grid;
+    grid.build(times.data(), times.size());
+    ASSERT_FALSE(grid.empty());
+    for (double t = -1.0; t < 102.0; t += 0.0037)
+    {
+        EXPECT_EQ(find_segment_in(times.data(), times.size(), 0, t), grid.find(times.data(), times.size(), t)) << t;
+    }
+    for (const double t : times)
+    {
+        EXPECT_EQ(find_segment_in(times.data(), times.size(), 0, t), grid.find(times.data(), times.size(), t)) << t;
+    }
+
+    // Most points fall into the last bucket but one
+    EXPECT_GE(grid.worst_scan(), 6u);
+    const double two[2] = {0.0, 1.0};
+    grid.build(two, 2);
+    EXPECT_TRUE(grid.empty());
+}
+
+TEST(Realtime, ClusteredPointsStayBounded)
+{
+    // 1000 points in [0, 1] and one far away: a grid sized by the span alone puts them all in one bucket
+    std::vector<double> times;
+    for (int i = 0; i < 1000; ++i)
+    {
+        times.push_back(i / 1000.0);
+    }
+    times.push_back(1e6);
+    SegmentGrid grid;
+    grid.build(times.data(), times.size());
+    EXPECT_LE(grid.worst_scan(), 14u);
+    EXPECT_EQ(1u, grid.bisected_buckets());
+    for (double t = -0.5; t < 2.0; t += 0.000731)
+    {
+        EXPECT_EQ(find_segment_in(times.data(), times.size(), 0, t), grid.find(times.data(), times.size(), t)) << t;
+    }
+    for (const double t : {0.0, 0.5, 0.999, 1.0, 5e5, 1e6, 2e6})
+    {
+        EXPECT_EQ(find_segment_in(times.data(), times.size(), 0, t), grid.find(times.data(), times.size(), t)) << t;
+    }
+
+    // Buckets as wide as the shortest segment, every bucket is scanned
+    times = {0.0, 0.25, 0.5, 0.75, 1.0, 2.0, 3.0, 4.0};
+    grid.build(times.data(), times.size());
+    EXPECT_EQ(0u, grid.bisected_buckets());
+    EXPECT_LE(grid.worst_scan(), 2u);
+}
+
+TEST(Realtime, SameValuesAsCursorSearch)
+{
+    ScenarioState realtime;
+    ScenarioState plain;
+    realtime.set_input(scenario);
+    plain.set_input(scenario);
+    realtime.set_boolean_option(vrRealtime, true);
+    realtime.compress_series = true;
+    realtime.lazy_parse = true;
+    realtime.event_calendar = true;
+    realtime.initialize(Log{});
+    plain.initialize(Log{});
+
+    // Loaded, plain points with a grid
+    EXPECT_TRUE(realtime.series[0].loaded);
+    EXPECT_FALSE(realtime.series[0].compressed);
+    EXPECT_FALSE(realtime.series[0].grid.empty());
+    EXPECT_TRUE(plain.series[0].grid.empty());
+
+    // Forwards with jumps, then backwards
+    std::vector<double> times;
+    for (double t = -0.5; t < 20.0; t += 0.013)
+    {
+        times.push_back(t);
+    }
+    times.push_back(0.5);
+    times.push_back(2.0);
+    times.push_back(1.0);
+    for (size_t i = times.size(); i-- > 0;)
+    {
+        times.push_back(times[i]);
+    }
+    for (const double t : times)
+    {
+        realtime.set_time(t);
+        plain.set_time(t);
+        for (size_t i : {0, 2, 3})
+        {
+            EXPECT_EQ(plain.real_value(plain.series[i]), realtime.real_value(realtime.series[i])) << i << " " << t;
+            EXPECT_EQ(plain.real_derivative(plain.series[i]), realtime.real_derivative(realtime.series[i])) << i << " " << t;
+        }
+        EXPECT_EQ(plain.discrete_value(plain.series[1]), realtime.discrete_value(realtime.series[1])) << t;
+    }
+}
+
+TEST(Realtime, WorstCaseNamesUnboundedOutputs)
+{
+    ScenarioState state;
+    state.set_input("sweep; L; Integral; 0,0; chirp(1,1,100); 1000,0\nmean; L; Window(2); 0,0; 1,1; 2,0");
+    state.set_boolean_option(vrRealtime, true);
+    Log log;
+    state.initialize(log);
+    EXPECT_TRUE(log.contains("a lookup compares at most"));
+    EXPECT_TRUE(log.contains("the integral of a chirp segment adds one panel of 5 sine evaluations"));
+    EXPECT_TRUE(log.contains("a Window output searches a range tree of up to 3 points"));
+
+    Log plain_log;
+    ScenarioState plain;
+    plain.set_input(scenario);
+    plain.set_boolean_option(vrRealtime, true);
+    plain.initialize(plain_log);
+    EXPECT_FALSE(plain_log.contains("chirp"));
+    EXPECT_FALSE(plain_log.contains("Window"));
+}
+
+TEST(Realtime, ParseErrorIsAStatus)
+{
+    fmi2CallbackFunctions cbs{};
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+    const fmi2ValueReference vr_in[1] = {0};
+    const fmi2String values[1] = {"speed; L; 0,abc"};
+    ASSERT_EQ(fmi2OK, fmi2SetString(comp, vr_in, 1, values));
+    ASSERT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+    EXPECT_EQ(fmi2Error, fmi2ExitInitializationMode(comp));
+    fmi2FreeInstance(comp);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <cstdarg>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+namespace
+{
+    std::vector<std::string> messages;
+
+    void logger(fmi2ComponentEnvironment, fmi2String, fmi2Status, fmi2String, fmi2String message, ...)
+    {
+        va_list args;
+        va_start(args, message);
+        messages.push_back(va_arg(args, const char *));
+        va_end(args);
+    }
+
+    const char *scenario = "var1; L; 1,0; 3,0.5; 5,4; 9,2\nvar2; ZOH; 2,0; 3,0.5; 5,4; 9,2";
+
+    void initialize(fmi2Component comp, const char *input)
+    {
+        const fmi2ValueReference vr_in[1] = {0};
+        const fmi2String values[1] = {input};
+        ASSERT_EQ(fmi2OK, fmi2SetString(comp, vr_in, 1, values));
+        ASSERT_EQ(fmi2OK, fmi2SetupExperiment(comp, fmiFalse, 0.0, 0.0, fmiFalse, 0.0));
+        ASSERT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+        ASSERT_EQ(fmi2OK, fmi2ExitInitializationMode(comp));
+    }
+
+    bool reused()
+    {
+        return !messages.empty() && messages.back().find("reusing") != std::string::npos;
+    }
+}
+
+TEST(Reset, ReusesParsedScenario)
+{
+    fmi2CallbackFunctions cbs{};
+    cbs.logger = logger;
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiTrue);
+
+    const fmi2ValueReference vr_out[2] = {1, 2};
+    fmi2Real out_vals[2];
+
+    for (int run = 0; run < 3; ++run)
+    {
+        messages.clear();
+        initialize(comp, scenario);
+        EXPECT_EQ(run > 0, reused()) << "run " << run;
+
+        // Walk to the end, the next run must start over from the first point
+        for (double t : {2.0, 4.0, 8.0})
+        {
+            ASSERT_EQ(fmi2OK, fmi2DoStep(comp, t, 0.0, fmiTrue));
+            ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 2, out_vals));
+        }
+        EXPECT_NEAR(2.5, out_vals[0], 1e-9);
+        EXPECT_NEAR(4.0, out_vals[1], 1e-9);
+
+        ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 1.5, 0.0, fmiTrue));
+        ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 2, out_vals));
+        EXPECT_NEAR(0.125, out_vals[0], 1e-9);
+        EXPECT_NEAR(0.0, out_vals[1], 1e-9);
+
+        ASSERT_EQ(fmi2OK, fmi2Reset(comp));
+    }
+
+    fmi2FreeInstance(comp);
+}
+
+TEST(Reset, ParsesChangedScenario)
+{
+    fmi2CallbackFunctions cbs{};
+    cbs.logger = logger;
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiTrue);
+
+    initialize(comp, scenario);
+    ASSERT_EQ(fmi2OK, fmi2Reset(comp));
+
+    messages.clear();
+    initialize(comp, "var1; L; 0,10; 10,20");
+    EXPECT_FALSE(reused());
+
+    const fmi2ValueReference vr_out[1] = {1};
+    fmi2Real out_vals[1];
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 5.0, 0.0, fmiTrue));
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 1, out_vals));
+    EXPECT_NEAR(15.0, out_vals[0], 1e-9);
+
+    // Changing an option that affects the parsed series parses again as well
+    ASSERT_EQ(fmi2OK, fmi2Reset(comp));
+    const fmi2ValueReference vr_opt[1] = {0x40000000};
+    const fmi2Boolean opt[1] = {fmiTrue};
+    ASSERT_EQ(fmi2OK, fmi2SetBoolean(comp, vr_opt, 1, opt));
+    messages.clear();
+    initialize(comp, "var1; L; 0,10; 10,20");
+    EXPECT_FALSE(reused());
+
+    fmi2FreeInstance(comp);
+}
+
+TEST(Reset, ParametersBackToDefaults)
+{
+    fmi2CallbackFunctions cbs{};
+    cbs.logger = logger;
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiTrue);
+
+    const fmi2ValueReference vr_out[1] = {1};
+    fmi2Real out_vals[1];
+    const fmi2ValueReference vr_gain[1] = {0x40000000 + 8};
+    const fmi2Real gain[1] = {2.0};
+
+    // Run 1 doubles the output
+    ASSERT_EQ(fmi2OK, fmi2SetReal(comp, vr_gain, 1, gain));
+    initialize(comp, scenario);
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 5.0, 0.0, fmiTrue));
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 1, out_vals));
+    EXPECT_NEAR(8.0, out_vals[0], 1e-9);
+    ASSERT_EQ(fmi2OK, fmi2Reset(comp));
+
+    // Run 2 does not set the gain, it is 1 again
+    messages.clear();
+    initialize(comp, scenario);
+    EXPECT_TRUE(reused());
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 5.0, 0.0, fmiTrue));
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 1, out_vals));
+    EXPECT_NEAR(4.0, out_vals[0], 1e-9);
+    ASSERT_EQ(fmi2OK, fmi2Reset(comp));
+
+    // Setting an option back to the value the series were parsed with reuses them
+    const fmi2ValueReference vr_opt[1] = {0x40000000};
+    const fmi2Boolean opt[1] = {fmiTrue};
+    ASSERT_EQ(fmi2OK, fmi2SetBoolean(comp, vr_opt, 1, opt));
+    messages.clear();
+    initialize(comp, scenario);
+    EXPECT_FALSE(reused());
+    ASSERT_EQ(fmi2OK, fmi2Reset(comp));
+    ASSERT_EQ(fmi2OK, fmi2SetBoolean(comp, vr_opt, 1, opt));
+    messages.clear();
+    initialize(comp, scenario);
+    EXPECT_TRUE(reused());
+
+    fmi2FreeInstance(comp);
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <iostream>
+#include <tuple>
 
 extern "C"
 {
@@ -211,6 +212,31 @@ TEST(ScenarioFMU, OutputDerivativeNnZohInterpolation)
     fmi2FreeInstance(comp);
 }
 
+TEST(ScenarioFMU, CubicEvaluatedAsLinear)
+{
+    fmi2CallbackFunctions cbs{};
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+    const fmi2ValueReference vr_in[1] = {0};
+    const fmi2String values[1] = {"var1; C; 1,0; 3,1; 5,5"};
+    ASSERT_EQ(fmi2OK, fmi2SetString(comp, vr_in, 1, values));
+    ASSERT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+    ASSERT_EQ(fmi2OK, fmi2ExitInitializationMode(comp));
+
+    const fmi2ValueReference vr_out[1] = {1};
+    const fmi2Integer orders[1] = {1};
+    fmi2Real value[1] = {0.0};
+    fmi2Real derivative[1] = {0.0};
+    for (const auto &[time, expected, slope] : {std::tuple{2.0, 0.5, 0.5}, std::tuple{4.0, 3.0, 2.0}})
+    {
+        ASSERT_EQ(fmi2OK, fmi2DoStep(comp, time, 0.0, fmiTrue));
+        ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 1, value));
+        ASSERT_EQ(fmi2OK, fmi2GetRealOutputDerivatives(comp, vr_out, 1, orders, derivative));
+        EXPECT_NEAR(expected, value[0], 1e-9);
+        EXPECT_NEAR(slope, derivative[0], 1e-9);
+    }
+    fmi2FreeInstance(comp);
+}
+
 TEST(ScenarioFMU, OutputDerivativeAfterLastPoint)
 {
     fmi2Component comp = nullptr;
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+#include "parser.hpp"
+#include "binary.hpp"
+#include "simplify.hpp"
+
+namespace
+{
+    const char *scenario = "wave; L; 0,1; sin(2,0.5); 10,1; 20,3\n"
+                           "sweep; ZOH; 0,0; chirp(1,0,2); 4,0\n"
+                           "mixed; ZOH; 0,0; ramp; 2,4; step; 4,6; 5,6\n"
+                           "plain; L; 0,0; 1,1";
+}
+
+TEST(Shapes, Parse)
+{
+    auto d = parse_scenario(scenario);
+    ASSERT_EQ(4u, d.size());
+    ASSERT_EQ(1u, d[0].shapes.size());
+    EXPECT_EQ(ShapeKind::Sine, d[0].shapes[0].kind);
+    EXPECT_EQ(0u, d[0].shapes[0].segment);
+    EXPECT_EQ(3u, d[0].size);
+
+    ASSERT_EQ(2u, d[2].shapes.size());
+    EXPECT_EQ(ShapeKind::Ramp, d[2].shapes[0].kind);
+    EXPECT_EQ(ShapeKind::Step, d[2].shapes[1].kind);
+    EXPECT_EQ(1u, d[2].shapes[1].segment);
+    EXPECT_EQ(nullptr, d[2].shape_at(2));
+    EXPECT_TRUE(d[3].shapes.empty());
+
+    EXPECT_EQ("wave; L; 0,1; sin(2,0.5,0); 10,1; 20,3", d[0].to_string());
+    EXPECT_EQ("mixed; ZOH; 0,0; ramp; 2,4; step; 4,6; 5,6", d[2].to_string());
+}
+
+TEST(Shapes, ClosedFormValues)
+{
+    auto d = parse_scenario(scenario);
+    const double pi = std::numbers::pi;
+
+    auto &wave = d[0];
+    EXPECT_DOUBLE_EQ(1.0, eval_value_at(wave, 0.0));
+    EXPECT_DOUBLE_EQ(1.0 + 2.0 * std::sin(pi * 0.5), eval_value_at(wave, 0.5));
+    EXPECT_DOUBLE_EQ(1.0 + 2.0 * std::sin(pi * 7.25), eval_value_at(wave, 7.25));
+    EXPECT_DOUBLE_EQ(1.0, eval_value_at(wave, 10.0));
+    EXPECT_DOUBLE_EQ(2.0, eval_value_at(wave, 15.0));
+    EXPECT_NEAR(2.0 * pi * std::cos(pi * 0.5) * 0.5 + 0.0, eval_output_derivative_at(wave, 0.5), 1e-12);
+    EXPECT_DOUBLE_EQ(0.2, eval_output_derivative_at(wave, 15.0));
+
+    // Frequency sweeps from 0 to 2 over 4 seconds, phase 2 pi (0 t + t^2 / 4)
+    auto &sweep = d[1];
+    EXPECT_DOUBLE_EQ(std::sin(2.0 * pi * 1.0 / 4.0), eval_value_at(sweep, 1.0));
+    EXPECT_DOUBLE_EQ(std::sin(2.0 * pi * 9.0 / 4.0), eval_value_at(sweep, 3.0));
+
+    auto &mixed = d[2];
+    EXPECT_DOUBLE_EQ(2.0, eval_value_at(mixed, 1.0));
+    EXPECT_DOUBLE_EQ(2.0, eval_output_derivative_at(mixed, 1.0));
+    EXPECT_DOUBLE_EQ(4.0, eval_value_at(mixed, 3.0));
+    EXPECT_DOUBLE_EQ(6.0, eval_value_at(mixed, 4.0));
+}
+
+TEST(Shapes, BatchMatchesSingleLookups)
+{
+    auto d = parse_scenario(scenario);
+    std::vector<double> times;
+    for (double t = -1.0; t < 25.0; t += 0.01)
+    {
+        times.push_back(t);
+    }
+    for (auto &sd : d)
+    {
+        std::vector<double> expected;
+        for (const double t : times)
+        {
+            expected.push_back(eval_value_at(sd, t));
+        }
+        sd.rewind();
+        std::vector<double> out(times.size());
+        eval_batch(sd, times.data(), times.size(), out.data());
+        EXPECT_EQ(expected, out) << sd.name;
+    }
+}
+
+TEST(Shapes, KeptByStorageOptions)
+{
+    auto d = parse_scenario(scenario);
+    compress_series(d[0]);
+    EXPECT_FALSE(d[0].compressed);
+    EXPECT_EQ(0u, simplify_series(d[2], 1.0));
+
+    const auto bytes = serialize_scenario(d);
+    auto loaded = deserialize_scenario(bytes.data(), bytes.size());
+    ASSERT_EQ(1u, loaded[0].shapes.size());
+    EXPECT_EQ(eval_value_at(d[0], 3.3), eval_value_at(loaded[0], 3.3));
+    EXPECT_EQ(eval_value_at(d[1], 2.2), eval_value_at(loaded[1], 2.2));
+}
+
+TEST(Shapes, Errors)
+{
+    EXPECT_THROW(parse_scenario("x; L; 0,0; wobble; 1,1"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("x; L; 0,0; sin(1); 1,1"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("x; L; 0,0; sin(1,2,3,4); 1,1"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("x; L; 0,0; ramp(1); 1,1"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("x; L; 0,0; 1,1; ramp"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("x; L; 0,0; ramp; step; 1,1"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("x; ZOH; Integer; 0,0; step; 1,1"), std::runtime_error);
+}
@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+namespace
+{
+    // Unique per test process, so segments left behind by an aborted run are not picked up
+    std::string scenario()
+    {
+        const auto pid = std::to_string(getpid());
+        return "speed_" + pid + "; L; 1,0; 3,0.5; 5,4; 9,2\n"
+               "gear; ZOH; Integer; 0,1; 4,2; 6,2; 8,-3\n"
+               "door; ZOH; Boolean; 0,false; 2,true; 7,false\n"
+               "wave; L; Repeat; 0,0; sin(0.5,1); 2,1";
+    }
+
+    ScenarioState shared_state(const std::string &input)
+    {
+        ScenarioState state;
+        state.set_input(input.c_str());
+        state.shared_memory = true;
+        return state;
+    }
+
+    // Values of every series at a few times, Integer and Boolean as doubles
+    std::vector<double> sample(ScenarioState &state)
+    {
+        std::vector<double> out;
+        for (auto &s : state.series)
+        {
+            for (double t = -0.5; t < 12.0; t += 0.25)
+            {
+                out.push_back(s.type == ValueType::Real ? eval_value_at(s, t) : eval_discrete_at(s, t));
+            }
+        }
+        return out;
+    }
+}
+
+TEST(Shared, InstancesMapOnePublishedCopy)
+{
+    const auto input = scenario();
+    ScenarioState plain;
+    plain.set_input(input.c_str());
+    Log plain_log;
+    plain.initialize(plain_log);
+
+    auto first = shared_state(input);
+    Log first_log;
+    first.initialize(first_log);
+    EXPECT_TRUE(first_log.contains("Published shared scenario"));
+
+    auto second = shared_state(input);
+    Log second_log;
+    second.initialize(second_log);
+    EXPECT_TRUE(second_log.contains("Mapped shared scenario"));
+
+    ASSERT_EQ(plain.series.size(), second.series.size());
+    for (const auto &s : second.series)
+    {
+        EXPECT_TRUE(s.mapping);
+        // The points are not owned, only the few segment shapes are copied
+        EXPECT_EQ(s.shapes.size() * sizeof(SegmentShape), s.footprint());
+    }
+    EXPECT_EQ(sample(plain), sample(first));
+    EXPECT_EQ(sample(plain), sample(second));
+    EXPECT_EQ(plain.series[3].to_string(), second.series[3].to_string());
+
+    // The publisher removes the name, instances that mapped it keep evaluating
+    first = ScenarioState();
+    EXPECT_FALSE(attach_shared(shared_key(input, std::string_view("\0\0\0\0\0\0\0\0", 8))));
+    EXPECT_EQ(sample(plain), sample(second));
+}
+
+TEST(Shared, OtherProcessMapsPublishedScenario)
+{
+    const auto input = scenario() + "\nextra; ZOH; 0,1; 5,2";
+    auto publisher = shared_state(input);
+    Log log;
+    publisher.initialize(log);
+    ASSERT_TRUE(log.contains("Published shared scenario"));
+    const auto expected = sample(publisher);
+
+    const pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        auto child = shared_state(input);
+        Log child_log;
+        child.initialize(child_log);
+        const bool ok = child_log.contains("Mapped shared scenario") && child.series[0].mapping && sample(child) == expected;
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(0, WEXITSTATUS(status));
+}
+
+TEST(Shared, SettingsSelectTheSegment)
+{
+    const auto input = scenario() + "\nnoise; L; 0,0; 1,0.001; 2,0; 3,5; 4,5.001; 5,10";
+    auto exact = shared_state(input);
+    Log exact_log;
+    exact.initialize(exact_log);
+
+    // Simplified series are published separately from the exact ones
+    auto simplified = shared_state(input);
+    simplified.simplify_series = true;
+    simplified.tolerance = 0.01;
+    Log simplified_log;
+    simplified.initialize(simplified_log);
+    EXPECT_TRUE(simplified_log.contains("Published shared scenario"));
+    EXPECT_EQ(6u, exact.series[4].size);
+    EXPECT_LT(simplified.series[4].size, exact.series[4].size);
+}
+
+TEST(Shared, FmuOption)
+{
+    const auto input = scenario();
+    const fmi2ValueReference vr_in[1] = {0};
+    const fmi2String values[1] = {input.c_str()};
+    const fmi2ValueReference vr_opt[1] = {0x40000004};
+    const fmi2Boolean on[1] = {fmiTrue};
+    const fmi2ValueReference vr_out[1] = {1};
+
+    std::vector<fmi2Component> comps;
+    for (int i = 0; i < 3; ++i)
+    {
+        auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, nullptr, fmiFalse, fmiFalse);
+        ASSERT_EQ(fmi2OK, fmi2SetBoolean(comp, vr_opt, 1, on));
+        ASSERT_EQ(fmi2OK, fmi2SetString(comp, vr_in, 1, values));
+        ASSERT_EQ(fmi2OK, fmi2SetupExperiment(comp, fmiFalse, 0.0, 0.0, fmiFalse, 0.0));
+        ASSERT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+        ASSERT_EQ(fmi2OK, fmi2ExitInitializationMode(comp));
+        comps.push_back(comp);
+    }
+    for (auto comp : comps)
+    {
+        fmi2Real out[1];
+        ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 0.0, 4.0, fmiTrue));
+        ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 1, out));
+        EXPECT_DOUBLE_EQ(2.25, out[0]);
+        fmi2FreeInstance(comp);
+    }
+}
+
+TEST(Shared, UnfinishedSegmentOfAGoneWriterIsReplaced)
+{
+    const auto input = scenario() + "\nabandoned; L; 0,0; 1,1";
+    const double variant[2] = {0.0, 0.0};
+    const auto key = shared_key(input, std::string_view(reinterpret_cast<const char *>(variant), sizeof(variant)));
+
+    // A publisher exiting between creating the segment and marking it ready
+    const pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        const int fd = shm_open(shared_name(key).c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        SharedHeader header{};
+        header.writer = static_cast<uint64_t>(getpid());
+        header.pid_namespace = pid_namespace();
+        const bool ok = fd >= 0 && pwrite(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                        ftruncate(fd, 4096) == 0;
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(0, WEXITSTATUS(status));
+
+    auto state = shared_state(input);
+    Log log;
+    state.initialize(log);
+    EXPECT_TRUE(log.contains("Published shared scenario"));
+    EXPECT_TRUE(state.series[0].mapping);
+}
+
+TEST(Shared, SegmentWithoutHeaderIsReplacedOnceStale)
+{
+    const auto input = scenario() + "\nheaderless; L; 0,0; 1,1";
+    const double variant[2] = {0.0, 0.0};
+    const auto key = shared_key(input, std::string_view(reinterpret_cast<const char *>(variant), sizeof(variant)));
+
+    // A publisher exiting right after creating the segment leaves it empty
+    const int fd = shm_open(shared_name(key).c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    ASSERT_GE(fd, 0);
+    {
+        auto state = shared_state(input);
+        Log log;
+        state.initialize(log);
+        EXPECT_TRUE(log.contains("Shared scenario not available"));
+    }
+
+    const timespec old[2] = {{std::time(nullptr) - 2 * shared_abandoned_after, 0}, {std::time(nullptr) - 2 * shared_abandoned_after, 0}};
+    ASSERT_EQ(0, futimens(fd, old));
+    close(fd);
+    auto state = shared_state(input);
+    Log log;
+    state.initialize(log);
+    EXPECT_TRUE(log.contains("Published shared scenario"));
+}
+
+TEST(Shared, WriterInAnotherPidNamespaceIsNotChecked)
+{
+    const auto input = scenario() + "\nnamespaced; L; 0,0; 1,1";
+    const double variant[2] = {0.0, 0.0};
+    const auto key = shared_key(input, std::string_view(reinterpret_cast<const char *>(variant), sizeof(variant)));
+
+    // A process id that does not exist here may be a live publisher in its own namespace
+    const int fd = shm_open(shared_name(key).c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    ASSERT_GE(fd, 0);
+    SharedHeader header{};
+    header.writer = 0x3ffffff0;
+    header.pid_namespace = pid_namespace() + 1;
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(header)), pwrite(fd, &header, sizeof(header), 0));
+    ASSERT_EQ(0, ftruncate(fd, 4096));
+    {
+        auto state = shared_state(input);
+        Log log;
+        state.initialize(log);
+        EXPECT_TRUE(log.contains("Shared scenario not available"));
+    }
+
+    const timespec old[2] = {{std::time(nullptr) - 2 * shared_abandoned_after, 0}, {std::time(nullptr) - 2 * shared_abandoned_after, 0}};
+    ASSERT_EQ(0, futimens(fd, old));
+    close(fd);
+    auto state = shared_state(input);
+    Log log;
+    state.initialize(log);
+    EXPECT_TRUE(log.contains("Published shared scenario"));
+}
+
+TEST(Shared, SegmentsOfOtherUsersAreNotMapped)
+{
+    if (geteuid() != 0)
+    {
+        GTEST_SKIP() << "Changing the owner of a segment needs root";
+    }
+    const auto input = scenario() + "\nforeign; L; 0,0; 1,1";
+    auto publisher = shared_state(input);
+    Log publisher_log;
+    publisher.initialize(publisher_log);
+    ASSERT_TRUE(publisher_log.contains("Published shared scenario"));
+
+    const double variant[2] = {0.0, 0.0};
+    const auto key = shared_key(input, std::string_view(reinterpret_cast<const char *>(variant), sizeof(variant)));
+    const int fd = shm_open(shared_name(key).c_str(), O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(0, fchown(fd, 4242, 4242));
+    close(fd);
+
+    auto state = shared_state(input);
+    Log log;
+    state.initialize(log);
+    EXPECT_TRUE(log.contains("Shared scenario not available"));
+    EXPECT_FALSE(state.series[0].mapping);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdarg>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+#include "simplify.hpp"
+
+namespace
+{
+    const fmi2ValueReference vrSimplifySeries = 0x40000001;
+
+    std::vector<std::string> messages;
+
+    void logger(fmi2ComponentEnvironment, fmi2String, fmi2Status, fmi2String, fmi2String message, ...)
+    {
+        va_list args;
+        va_start(args, message);
+        messages.push_back(va_arg(args, const char *));
+        va_end(args);
+    }
+
+    SeriesData make_series(Interpolation interpolation, const std::vector<double> &times, const std::vector<double> &values)
+    {
+        SeriesData sd;
+        sd.interpolation = interpolation;
+        sd.times = times;
+        sd.values = values;
+        sd.size = times.size();
+        return sd;
+    }
+}
+
+TEST(Simplify, LinearKeepsCorners)
+{
+    auto sd = make_series(Interpolation::Linear, {0, 1, 2, 3, 4, 5, 6}, {0, 1, 2, 3, 2, 1, 0});
+    EXPECT_EQ(4u, simplify_series(sd, 1e-6));
+    EXPECT_EQ((std::vector<double>{0, 3, 6}), sd.times);
+    EXPECT_EQ((std::vector<double>{0, 3, 0}), sd.values);
+}
+
+TEST(Simplify, LinearStaysWithinTolerance)
+{
+    std::vector<double> times;
+    std::vector<double> values;
+    for (int i = 0; i <= 1000; ++i)
+    {
+        times.push_back(0.01 * i);
+        values.push_back(std::sin(0.01 * i));
+    }
+    auto original = make_series(Interpolation::Linear, times, values);
+    auto simplified = original;
+
+    const double tolerance = 1e-4;
+    EXPECT_GT(simplify_series(simplified, tolerance), 600u);
+    for (double t = 0.0; t <= 10.0; t += 0.0013)
+    {
+        EXPECT_NEAR(eval_value_at(original, t), eval_value_at(simplified, t), tolerance);
+    }
+}
+
+TEST(Simplify, LinearKeepsDiscontinuities)
+{
+    auto sd = make_series(Interpolation::Linear, {0, 1, 2, 2, 3, 4}, {0, 1, 2, 5, 6, 7});
+    EXPECT_EQ(2u, simplify_series(sd, 1e-6));
+    EXPECT_EQ((std::vector<double>{0, 2, 2, 4}), sd.times);
+    EXPECT_EQ((std::vector<double>{0, 2, 5, 7}), sd.values);
+}
+
+TEST(Simplify, ZohOnlyDropsRepeatedValues)
+{
+    auto sd = make_series(Interpolation::Zoh, {0, 1, 2, 3, 4, 5}, {1, 1, 1.00001, 1.00001, 1, 1});
+    EXPECT_EQ(2u, simplify_series(sd, 0.1));
+    EXPECT_EQ((std::vector<double>{0, 2, 4, 5}), sd.times);
+}
+
+TEST(Simplify, NearestNeighborUntouched)
+{
+    auto sd = make_series(Interpolation::NearestNeighbor, {0, 1, 2, 3}, {0, 1, 2, 3});
+    EXPECT_EQ(0u, simplify_series(sd, 0.1));
+    EXPECT_EQ(4u, sd.size);
+}
+
+TEST(Simplify, ReportedOnExitInitialization)
+{
+    messages.clear();
+    fmi2CallbackFunctions cbs{};
+    cbs.logger = logger;
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiTrue);
+
+    const fmi2ValueReference vr_in[1] = {0};
+    const fmi2String values[1] = {"var1; L; 0,0; 1,1; 2,2; 3,3; 4,4\nvar2; ZOH; 0,0; 1,0; 2,1; 3,1"};
+    ASSERT_EQ(fmi2OK, fmi2SetString(comp, vr_in, 1, values));
+
+    const fmi2ValueReference vr_opt[1] = {vrSimplifySeries};
+    const fmi2Boolean opt[1] = {fmiTrue};
+    ASSERT_EQ(fmi2OK, fmi2SetBoolean(comp, vr_opt, 1, opt));
+
+    ASSERT_EQ(fmi2OK, fmi2SetupExperiment(comp, fmiTrue, 1e-4, 0.0, fmiFalse, 0.0));
+    ASSERT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+    ASSERT_EQ(fmi2OK, fmi2ExitInitializationMode(comp));
+
+    ASSERT_EQ(1u, messages.size());
+    EXPECT_NE(std::string::npos, messages[0].find("removed 4 of 9 points"));
+
+    const fmi2ValueReference vr_out[2] = {1, 2};
+    fmi2Real out_vals[2] = {0.0, 0.0};
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 2.5, 0.0, fmiTrue));
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 2, out_vals));
+    EXPECT_NEAR(2.5, out_vals[0], 1e-9);
+    EXPECT_NEAR(1.0, out_vals[1], 1e-9);
+
+    fmi2FreeInstance(comp);
+}
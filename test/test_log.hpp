@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Logger passed to ScenarioState::initialize, keeps the messages for tests that check them
+    struct Log
+    {
+        std::vector<std::string> messages;
+        void operator()(bool, const std::string &message) { messages.push_back(message); }
+        bool contains(const std::string &text) const
+        {
+            for (const auto &m : messages)
+                if (m.find(text) != std::string::npos)
+                    return true;
+            return false;
+        }
+    };
+}
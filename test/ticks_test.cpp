@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+namespace
+{
+    const char *scenario = "gear; ZOH; Integer; 0,1; 0.3,2; 1,3\n"
+                           "level; ZOH; 0,0; 0.7,5; 1,7\n"
+                           "ramp; L; 0,0; 0.1,1; 0.45,0.5; 1,3";
+
+    // Values after ten steps of 0.1, the last communication point sums to 0.9999999999999999
+    std::vector<double> after_ten_steps(double resolution)
+    {
+        fmi2CallbackFunctions cbs{};
+        auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+        const fmi2ValueReference vr_in[1] = {0};
+        const fmi2String values[1] = {scenario};
+        EXPECT_EQ(fmi2OK, fmi2SetString(comp, vr_in, 1, values));
+        const fmi2ValueReference vr_resolution[1] = {vrTimeResolution};
+        const fmi2Real value[1] = {resolution};
+        EXPECT_EQ(fmi2OK, fmi2SetReal(comp, vr_resolution, 1, value));
+        EXPECT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+        EXPECT_EQ(fmi2OK, fmi2ExitInitializationMode(comp));
+
+        double time = 0.0;
+        for (int i = 0; i < 10; ++i)
+        {
+            EXPECT_EQ(fmi2OK, fmi2DoStep(comp, time, 0.1, fmiTrue));
+            time += 0.1;
+        }
+        const fmi2ValueReference vr_real[1] = {2};
+        const fmi2ValueReference vr_int[1] = {1};
+        fmi2Real level[1];
+        fmi2Integer gear[1];
+        EXPECT_EQ(fmi2OK, fmi2GetReal(comp, vr_real, 1, level));
+        EXPECT_EQ(fmi2OK, fmi2GetInteger(comp, vr_int, 1, gear));
+        fmi2FreeInstance(comp);
+        return {level[0], static_cast<double>(gear[0])};
+    }
+}
+
+TEST(Ticks, StepsHitPointsExactly)
+{
+    ASSERT_LT(0.1 + 0.1 + 0.1 + 0.1 + 0.1 + 0.1 + 0.1 + 0.1 + 0.1 + 0.1, 1.0);
+    EXPECT_EQ((std::vector<double>{5.0, 2.0}), after_ten_steps(0.0));
+    EXPECT_EQ((std::vector<double>{7.0, 3.0}), after_ten_steps(1e-6));
+}
+
+TEST(Ticks, SameValuesAsDoubleSearch)
+{
+    ScenarioState ticks;
+    ScenarioState plain;
+    ticks.set_input(scenario);
+    plain.set_input(scenario);
+    ticks.set_real_option(vrTimeResolution, 1e-3);
+    ticks.initialize(Log{});
+    plain.initialize(Log{});
+    ASSERT_EQ(4u, ticks.series[2].ticks.size());
+    EXPECT_EQ(450, ticks.series[2].ticks[2]);
+    EXPECT_TRUE(plain.series[2].ticks.empty());
+
+    // Forwards and backwards on the grid
+    std::vector<double> times;
+    for (int k = -20; k < 1300; k += 7)
+    {
+        times.push_back(k * 1e-3);
+    }
+    times.push_back(0.0);
+    times.push_back(0.3);
+    for (const double t : times)
+    {
+        ticks.set_time(t);
+        plain.set_time(t);
+        for (size_t i : {1, 2})
+        {
+            EXPECT_DOUBLE_EQ(plain.real_value(plain.series[i]), ticks.real_value(ticks.series[i])) << t;
+            EXPECT_DOUBLE_EQ(plain.real_derivative(plain.series[i]), ticks.real_derivative(ticks.series[i])) << t;
+        }
+        EXPECT_EQ(plain.discrete_value(plain.series[0]), ticks.discrete_value(ticks.series[0])) << t;
+    }
+
+    // Times between the grid search as doubles
+    EXPECT_DOUBLE_EQ(eval_value_at(plain.series[2], 0.4504), eval_value_at(ticks.series[2], 0.4504));
+
+    // Compressed series drop the ticks, the points stay snapped
+    ScenarioState compressed;
+    compressed.set_input(scenario);
+    compressed.compress_series = true;
+    compressed.set_real_option(vrTimeResolution, 1e-3);
+    compressed.initialize(Log{});
+    EXPECT_TRUE(compressed.series[2].ticks.empty());
+    EXPECT_FALSE(compressed.set_real_option(vrTimeResolution, -1.0));
+}
@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+#include <cstdarg>
+#include <limits>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "fmi2.h"
+#include "scenario.h"
+}
+
+namespace
+{
+    const char *scenario = "var1; L; 1,0; 3,0.5; 5,4; 9,2\n"
+                           "var2; ZOH; 2,0; 3,0.5; 5,4; 9,2\n"
+                           "gear; ZOH; Integer; 0,1; 4,2; 6,3";
+
+    // Field value references of the global transform and of the transform of output `index`
+    constexpr fmi2ValueReference vrGain = 0x40000008;
+    constexpr fmi2ValueReference vrOffset = 0x40000009;
+    constexpr fmi2ValueReference vrTimeShift = 0x4000000a;
+    constexpr fmi2ValueReference vrTimeScale = 0x4000000b;
+
+    fmi2ValueReference series_vr(unsigned int index, unsigned int field)
+    {
+        return 0x30000000 + 4 * index + field;
+    }
+
+    std::vector<std::string> messages;
+
+    void logger(fmi2ComponentEnvironment, fmi2String, fmi2Status, fmi2String, fmi2String message, ...)
+    {
+        va_list args;
+        va_start(args, message);
+        messages.push_back(va_arg(args, const char *));
+        va_end(args);
+    }
+
+    void initialize(fmi2Component comp)
+    {
+        const fmi2ValueReference vr_in[1] = {0};
+        const fmi2String values[1] = {scenario};
+        ASSERT_EQ(fmi2OK, fmi2SetString(comp, vr_in, 1, values));
+        ASSERT_EQ(fmi2OK, fmi2SetupExperiment(comp, fmiFalse, 0.0, 0.0, fmiFalse, 0.0));
+        ASSERT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+        ASSERT_EQ(fmi2OK, fmi2ExitInitializationMode(comp));
+    }
+}
+
+TEST(Transform, Composes)
+{
+    Transform inner{2.0, 1.0, 3.0, 0.5};
+    Transform outer{-1.0, 4.0, 1.0, 2.0};
+    const auto both = inner.within(outer);
+    for (double t : {-2.0, 0.0, 1.5, 7.0})
+    {
+        const double v = 3.25;
+        EXPECT_DOUBLE_EQ(outer.value(inner.value(v)), both.value(v));
+        EXPECT_DOUBLE_EQ(inner.local_time(outer.local_time(t)), both.local_time(t));
+    }
+    EXPECT_DOUBLE_EQ(-2.0 / 1.0, both.derivative(1.0));
+
+    // Back to simulation time is never before the local time
+    const Transform odd{1.0, 0.0, 0.1, 3.0};
+    for (double local : {0.1, 0.3, 1.0 / 3.0, 7.7})
+    {
+        EXPECT_GE(odd.local_time(odd.simulation_time(local)), local);
+    }
+}
+
+TEST(Transform, SetRealScalesAndShifts)
+{
+    fmi2CallbackFunctions cbs{};
+    cbs.logger = logger;
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiTrue);
+
+    // Everything twice as high and one second later, var2 also twice as slow
+    const fmi2ValueReference vr_set[4] = {vrGain, vrTimeShift, series_vr(1, 3), series_vr(1, 1)};
+    const fmi2Real set[4] = {2.0, 1.0, 2.0, 0.5};
+    ASSERT_EQ(fmi2OK, fmi2SetReal(comp, vr_set, 4, set));
+    initialize(comp);
+
+    const fmi2ValueReference vr_out[2] = {1, 2};
+    fmi2Real out[2];
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 0.0, 5.0, fmiTrue));
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 2, out));
+    EXPECT_DOUBLE_EQ(2.0 * 2.25, out[0]);        // var1 at 4
+    EXPECT_DOUBLE_EQ(2.0 * (0.0 + 0.5), out[1]); // var2 at 2, its offset inside the gain
+
+    const fmi2Integer order[1] = {1};
+    ASSERT_EQ(fmi2OK, fmi2GetRealOutputDerivatives(comp, vr_out, 1, order, out));
+    EXPECT_DOUBLE_EQ(2.0 * 1.75, out[0]);
+
+    // Integer series only move in time
+    const fmi2ValueReference vr_gear[1] = {3};
+    fmi2Integer gear[1];
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 5.0, 0.5, fmiTrue));
+    ASSERT_EQ(fmi2OK, fmi2GetInteger(comp, vr_gear, 1, gear));
+    EXPECT_EQ(2, gear[0]);
+
+    // Batch evaluation uses the same transform
+    const double times[3] = {2.0, 4.0, 6.0};
+    double batch[3];
+    ASSERT_EQ(fmi2OK, scenario_eval_batch(comp, 1, times, 3, batch));
+    EXPECT_DOUBLE_EQ(0.0, batch[0]);
+    EXPECT_DOUBLE_EQ(1.0, batch[1]);
+    EXPECT_DOUBLE_EQ(8.0, batch[2]);
+
+    // A variant reuses the parsed scenario
+    ASSERT_EQ(fmi2OK, fmi2Reset(comp));
+    const fmi2Real identity[4] = {1.0, 0.0, 1.0, 0.0};
+    ASSERT_EQ(fmi2OK, fmi2SetReal(comp, vr_set, 4, identity));
+    messages.clear();
+    initialize(comp);
+    ASSERT_FALSE(messages.empty());
+    EXPECT_NE(std::string::npos, messages.back().find("reusing"));
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 0.0, 4.0, fmiTrue));
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 2, out));
+    EXPECT_DOUBLE_EQ(2.25, out[0]);
+    EXPECT_DOUBLE_EQ(0.5, out[1]);
+
+    fmi2FreeInstance(comp);
+}
+
+TEST(Transform, ResetToIdentity)
+{
+    fmi2CallbackFunctions cbs{};
+    cbs.logger = logger;
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiTrue);
+
+    const fmi2ValueReference vr_set[3] = {vrGain, vrTimeScale, series_vr(1, 1)};
+    const fmi2Real set[3] = {2.0, 2.0, 0.5};
+    ASSERT_EQ(fmi2OK, fmi2SetReal(comp, vr_set, 3, set));
+    initialize(comp);
+    ASSERT_EQ(fmi2OK, fmi2Reset(comp));
+
+    // The next run sets no transform and gets the series as they are
+    messages.clear();
+    initialize(comp);
+    ASSERT_FALSE(messages.empty());
+    EXPECT_NE(std::string::npos, messages.back().find("reusing"));
+    const fmi2ValueReference vr_out[2] = {1, 2};
+    fmi2Real out[2];
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 0.0, 4.0, fmiTrue));
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 2, out));
+    EXPECT_DOUBLE_EQ(2.25, out[0]);
+    EXPECT_DOUBLE_EQ(0.5, out[1]);
+
+    fmi2FreeInstance(comp);
+
+    ScenarioState state;
+    ASSERT_TRUE(state.set_real_option(vrOffset, 3.0));
+    ASSERT_TRUE(state.set_real_option(series_vr(0, 3), 4.0));
+    state.reset_parameters();
+    EXPECT_TRUE(state.transform.identity());
+    EXPECT_TRUE(state.series_transforms.empty());
+}
+
+TEST(Transform, RejectsInvalidValues)
+{
+    ScenarioState state;
+    EXPECT_FALSE(state.set_real_option(vrTimeScale, 0.0));
+    EXPECT_FALSE(state.set_real_option(vrTimeScale, -1.0));
+    EXPECT_FALSE(state.set_real_option(vrOffset, std::numeric_limits<double>::quiet_NaN()));
+    EXPECT_TRUE(state.set_real_option(series_vr(7, 0), 3.0));
+
+    // Unknown outputs once the scenario is parsed
+    state.set_input(scenario);
+    state.initialize(Log{});
+    EXPECT_FALSE(state.set_real_option(series_vr(3, 0), 3.0));
+    EXPECT_TRUE(state.set_real_option(series_vr(2, 2), 1.0));
+}
+
+TEST(Transform, CalendarFollowsGlobalTime)
+{
+    ScenarioState with;
+    ScenarioState without;
+    for (auto *s : {&with, &without})
+    {
+        s->set_input(scenario);
+        s->set_real_option(vrTimeShift, 0.75);
+        s->set_real_option(vrTimeScale, 1.5);
+        s->set_real_option(series_vr(0, 2), 1.0); // var1 is left out of the calendar
+    }
+    with.event_calendar = true;
+    with.initialize(Log{});
+    without.initialize(Log{});
+    EXPECT_FALSE(with.calendar.empty());
+
+    for (double t = 0.0; t < 20.0; t += 0.3)
+    {
+        with.set_time(t);
+        without.set_time(t);
+        for (size_t i = 0; i < 2; ++i)
+        {
+            EXPECT_EQ(without.real_value(without.series[i]), with.real_value(with.series[i])) << t;
+        }
+        EXPECT_EQ(without.discrete_value(without.series[2]), with.discrete_value(with.series[2])) << t;
+    }
+}
@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+
+#include "scenario_state.hpp"
+#include "test_log.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "fmi2.h"
+}
+
+namespace
+{
+    const char *scenario = "demand; L; Window(3); 0,1; 1,5; 2,0; 4,2; 5,-1; 8,3\n"
+                           "level; ZOH; Window(2.5); 0,2; 1,4; 3,1; 6,3\n"
+                           "cycle; L; Repeat; Window(1.5); 1,0; 2,4; 3,-2; 4,0\n"
+                           "pulse; ZOH; Zero; Window(2); 0,2; 1,3";
+
+    // Extremes of the values at both ends and at every point inside the window, point by point
+    std::pair<double, double> brute_extremes(SeriesData &sd, const std::vector<double> &times, double time)
+    {
+        const double start = std::max(time - sd.window, times.front());
+        const double period = times.back() - times.front();
+        double low = std::min(eval_value_at(sd, start), eval_value_at(sd, time));
+        double high = std::max(eval_value_at(sd, start), eval_value_at(sd, time));
+        for (int repeat = 0; repeat < (sd.extrapolation == Extrapolation::Repeat ? 20 : 1); ++repeat)
+        {
+            for (const double t : times)
+            {
+                const double at = t + repeat * period;
+                if (at > start && at <= time)
+                {
+                    low = std::min(low, eval_value_at(sd, at));
+                    high = std::max(high, eval_value_at(sd, at));
+                }
+            }
+        }
+        return {low, high};
+    }
+
+    double midpoint_mean(SeriesData &sd, double from, double to)
+    {
+        const int steps = 100000;
+        const double h = (to - from) / steps;
+        double sum = 0.0;
+        for (int i = 0; i < steps; ++i)
+        {
+            sum += eval_value_at(sd, from + (i + 0.5) * h);
+        }
+        return sum / steps;
+    }
+}
+
+TEST(Window, RangeTreeQueries)
+{
+    const std::vector<double> values = {3, -1, 4, 1, -5, 9, 2, 6};
+    RangeTree tree;
+    tree.build(values.size(), [&](size_t i)
+               { return values[i]; });
+    for (size_t first = 0; first < values.size(); ++first)
+    {
+        for (size_t last = first + 1; last <= values.size(); ++last)
+        {
+            const auto [low, high] = tree.query(first, last);
+            EXPECT_EQ(*std::min_element(values.begin() + first, values.begin() + last), low);
+            EXPECT_EQ(*std::max_element(values.begin() + first, values.begin() + last), high);
+        }
+    }
+    EXPECT_TRUE(std::isinf(tree.query(3, 3).first));
+}
+
+TEST(Window, MatchesPointByPoint)
+{
+    for (const bool compress : {false, true})
+    {
+        ScenarioState state;
+        state.set_input(scenario);
+        state.compress_series = compress;
+        state.initialize(Log{});
+        auto reference = parse_scenario(scenario);
+        for (size_t i = 0; i < reference.size(); ++i)
+        {
+            std::vector<double> times(reference[i].times.begin(), reference[i].times.end());
+            for (double t = -0.5; t < 14.0; t += 0.25)
+            {
+                state.current_time = t;
+                auto &s = state.series[i];
+                if (t < times.front())
+                {
+                    EXPECT_EQ(0.0, state.window_value(s, WindowStat::Max));
+                    continue;
+                }
+                const auto [low, high] = brute_extremes(reference[i], times, t);
+                EXPECT_DOUBLE_EQ(low, state.window_value(s, WindowStat::Min)) << s.name << " " << t << " " << compress;
+                EXPECT_DOUBLE_EQ(high, state.window_value(s, WindowStat::Max)) << s.name << " " << t << " " << compress;
+                const double start = std::max(t - reference[i].window, times.front());
+                if (t > start)
+                {
+                    EXPECT_NEAR(midpoint_mean(reference[i], start, t), state.window_value(s, WindowStat::Mean), 1e-4) << s.name << " " << t;
+                }
+            }
+        }
+    }
+}
+
+TEST(Window, HermiteOvershootBetweenPoints)
+{
+    // 3t - 4.5t^2 + 1.5t^3 on [0, 2], extremes +-1/sqrt(3) at 1 -+ 1/sqrt(3), then flat and repeated
+    const char *input = "h; L; Window(1); 0,0; hermite(3,3); 2,0; 3,0\n"
+                        "r; L; Repeat; Window(0.5); 0,0; hermite(3,3); 2,0; 3,0";
+    ScenarioState state;
+    state.set_input(input);
+    state.initialize(Log{});
+    auto reference = parse_scenario(input);
+    for (size_t i = 0; i < reference.size(); ++i)
+    {
+        auto &s = state.series[i];
+        ASSERT_EQ(s.size, s.shape_range.size());
+        for (double t = 0.05; t < 8.0; t += 0.05)
+        {
+            // Sampled densely the extremes are approached from inside
+            const double start = std::max(t - s.window, 0.0);
+            double low = eval_value_at(reference[i], start);
+            double high = low;
+            for (int k = 1; k <= 2000; ++k)
+            {
+                const double v = eval_value_at(reference[i], start + (t - start) * k / 2000.0);
+                low = std::min(low, v);
+                high = std::max(high, v);
+            }
+            state.current_time = t;
+            const double min = state.window_value(s, WindowStat::Min);
+            const double max = state.window_value(s, WindowStat::Max);
+            EXPECT_LE(min, low) << s.name << " " << t;
+            EXPECT_GE(max, high) << s.name << " " << t;
+            EXPECT_NEAR(low, min, 1e-6) << s.name << " " << t;
+            EXPECT_NEAR(high, max, 1e-6) << s.name << " " << t;
+        }
+    }
+
+    // The whole segment inside the window
+    state.current_time = 2.0;
+    state.series[0].window = 3.0;
+    EXPECT_DOUBLE_EQ(1.0 / std::sqrt(3.0), state.window_value(state.series[0], WindowStat::Max));
+    EXPECT_DOUBLE_EQ(-1.0 / std::sqrt(3.0), state.window_value(state.series[0], WindowStat::Min));
+}
+
+TEST(Window, SineBetweenPoints)
+{
+    // A full period on zero, a sine over a rising line with phase, the same repeated, and a negative frequency
+    const char *input = "w; L; Window(10); 0,0; sin(5,0.1); 10,0\n"
+                        "s; L; Window(1.5); 0,0; sin(1,0.4,0.3); 10,3; 12,3\n"
+                        "r; L; Repeat; Window(0.7); 0,0; sin(2,1); 2,1\n"
+                        "n; L; Window(2); 0,1; sin(1,-0.3,1); 5,0";
+    ScenarioState state;
+    state.set_input(input);
+    state.initialize(Log{});
+
+    state.current_time = 10.0;
+    EXPECT_DOUBLE_EQ(5.0, state.window_value(state.series[0], WindowStat::Max));
+    EXPECT_DOUBLE_EQ(-5.0, state.window_value(state.series[0], WindowStat::Min));
+
+    auto reference = parse_scenario(input);
+    for (size_t i = 0; i < reference.size(); ++i)
+    {
+        auto &s = state.series[i];
+        ASSERT_EQ(s.size, s.shape_range.size());
+        for (double t = 0.05; t < 14.0; t += 0.07)
+        {
+            const double start = std::max(t - s.window, 0.0);
+            double low = eval_value_at(reference[i], start);
+            double high = low;
+            std::vector<double> samples;
+            for (int k = 1; k <= 4000; ++k)
+            {
+                samples.push_back(std::min(t, start + (t - start) * k / 4000.0));
+            }
+            // The phase moves the sine off the points, its limits next to them count as well
+            for (const double point : {0.0, 2.0, 4.0, 5.0, 6.0, 8.0, 10.0, 12.0})
+            {
+                samples.push_back(std::nextafter(point, -1.0));
+                samples.push_back(std::nextafter(point, 100.0));
+            }
+            for (const double u : samples)
+            {
+                if (u >= start && u <= t)
+                {
+                    const double v = eval_value_at(reference[i], u);
+                    low = std::min(low, v);
+                    high = std::max(high, v);
+                }
+            }
+            state.current_time = t;
+            const double min = state.window_value(s, WindowStat::Min);
+            const double max = state.window_value(s, WindowStat::Max);
+            EXPECT_LE(min, low + 1e-12) << s.name << " " << t;
+            EXPECT_GE(max, high - 1e-12) << s.name << " " << t;
+            EXPECT_NEAR(low, min, 1e-5) << s.name << " " << t;
+            EXPECT_NEAR(high, max, 1e-5) << s.name << " " << t;
+        }
+    }
+
+    EXPECT_THROW(parse_scenario("c; L; Window(1); 0,0; chirp(1,0.1,2); 10,0"), std::runtime_error);
+}
+
+TEST(Window, OutputsWithNegativeGain)
+{
+    fmi2CallbackFunctions cbs{};
+    auto comp = fmi2Instantiate("inst", fmi2CoSimulation, "guid", nullptr, &cbs, fmiFalse, fmiFalse);
+    const fmi2ValueReference vr_in[1] = {0};
+    const fmi2String values[1] = {scenario};
+    ASSERT_EQ(fmi2OK, fmi2SetString(comp, vr_in, 1, values));
+    const fmi2ValueReference vr_gain[1] = {vrFirstTransform};
+    const fmi2Real gain[1] = {-2.0};
+    ASSERT_EQ(fmi2OK, fmi2SetReal(comp, vr_gain, 1, gain));
+    ASSERT_EQ(fmi2OK, fmi2EnterInitializationMode(comp));
+    ASSERT_EQ(fmi2OK, fmi2ExitInitializationMode(comp));
+    ASSERT_EQ(fmi2OK, fmi2DoStep(comp, 0.0, 3.0, fmiTrue));
+
+    // demand over [0, 3]: between 0 and 5, mean (3 + 2.5 + 0.5) / 3
+    const fmi2ValueReference vr_out[3] = {vrFirstWindow + 0, vrFirstWindow + 1, vrFirstWindow + 2};
+    fmi2Real out[3];
+    ASSERT_EQ(fmi2OK, fmi2GetReal(comp, vr_out, 3, out));
+    EXPECT_DOUBLE_EQ(-10.0, out[0]);
+    EXPECT_DOUBLE_EQ(0.0, out[1]);
+    EXPECT_DOUBLE_EQ(-2.0 * 6.0 / 3.0, out[2]);
+
+    // Only for series with the modifier
+    const fmi2ValueReference vr_none[1] = {vrFirstWindow + 3 * 4};
+    EXPECT_EQ(fmi2Warning, fmi2GetReal(comp, vr_none, 1, out));
+    fmi2FreeInstance(comp);
+}
+
+TEST(Window, ParsedAndKeptInBinary)
+{
+    EXPECT_THROW(parse_scenario("x; L; Window(0); 0,1"), std::runtime_error);
+    EXPECT_THROW(parse_scenario("x; ZOH; Integer; Window(1); 0,1"), std::runtime_error);
+
+    auto d = parse_scenario(scenario);
+    EXPECT_EQ("level; ZOH; Window(2.5); 0,2; 1,4; 3,1; 6,3", d[1].to_string());
+    const auto binary = serialize_scenario(d);
+    const auto restored = deserialize_scenario(binary.data(), binary.size());
+    EXPECT_EQ(2.5, restored[1].window);
+}